@@ -0,0 +1,165 @@
+// Measures traversal, insert and erase on the lists from lists.hpp (plus std::list for reference)
+//
+// Build: g++ -std=c++20 -O2 list_benchmark.cpp -o list_benchmark
+// Usage: ./list_benchmark [max size = 1000000]
+//        sizes go from 1K up to max size in steps of 10x, e.g. `./list_benchmark 100000000` for 100M
+//        (100M elements need a few GB of memory for the linked lists)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../../cpp/testing/report.hpp"
+#include "lists.hpp"
+
+using Value = std::int32_t;
+
+// Keeps the compiler from optimizing the measured work away
+volatile std::int64_t sink;
+
+template <typename F>
+double seconds(F&& work) {
+    auto begin = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+template <typename List>
+std::int64_t sum(List& list) {
+    std::int64_t total = 0;
+    for (Value value : list) {
+        total += value;
+    }
+    return total;
+}
+
+// Erases every element in random order and pushes them back. The free list (or malloc) then hands the
+// nodes out in random order, so neighbours in the list are no longer neighbours in memory - what a
+// long-running program's lists look like after lots of inserts and erases.
+// Only possible for lists whose iterators survive erasing other elements.
+template <typename List>
+void age(List& list, std::mt19937& rng) {
+    std::vector<typename List::iterator> nodes;
+    nodes.reserve(list.size());
+    for (auto it = list.begin(); it != list.end(); ++it) {
+        nodes.push_back(it);
+    }
+    std::shuffle(nodes.begin(), nodes.end(), rng);
+    std::size_t size = list.size();
+    for (auto it : nodes) {
+        list.erase(it);
+    }
+    for (std::size_t i = 0; i < size; i++) {
+        list.push_back(static_cast<Value>(i));
+    }
+}
+
+struct Row {
+    double build;    // ns per push_back
+    double traverse; // ns per element
+    double aged;     // ns per element, < 0 if not measured
+    double insert;   // ns per insert at a random position
+    double erase;    // ns per erase at a random position
+};
+
+// Random insert/erase run after age(), so for the linked lists they walk scattered nodes.
+// The position is found by walking from begin() with std::next - O(1) for the vector,
+// O(n) for the linked lists - and then the element is inserted/erased there. This is what the operation
+// actually costs when the position is not already known.
+template <typename List, bool StableIterators>
+Row measure(std::size_t size) {
+    Row row{};
+    std::mt19937 rng(42);
+    std::size_t ops = std::clamp<std::size_t>(20'000'000 / size, 1, 1000);
+
+    List list;
+    row.build = seconds([&] {
+        for (std::size_t i = 0; i < size; i++) {
+            list.push_back(static_cast<Value>(i));
+        }
+    }) * 1e9 / size;
+
+    // Repeat small traversals so the timer has something to measure
+    std::size_t passes = std::max<std::size_t>(1, 50'000'000 / size);
+    row.traverse = seconds([&] {
+        for (std::size_t pass = 0; pass < passes; pass++) {
+            sink = sum(list);
+        }
+    }) * 1e9 / (size * passes);
+
+    row.aged = -1;
+    if constexpr (StableIterators) {
+        age(list, rng);
+        row.aged = seconds([&] {
+            for (std::size_t pass = 0; pass < passes; pass++) {
+                sink = sum(list);
+            }
+        }) * 1e9 / (size * passes);
+    }
+
+    row.insert = seconds([&] {
+        for (std::size_t op = 0; op < ops; op++) {
+            std::size_t position = std::uniform_int_distribution<std::size_t>(0, list.size())(rng);
+            list.insert(std::next(list.begin(), position), static_cast<Value>(op));
+        }
+    }) * 1e9 / ops;
+
+    row.erase = seconds([&] {
+        for (std::size_t op = 0; op < ops; op++) {
+            std::size_t position = std::uniform_int_distribution<std::size_t>(0, list.size() - 1)(rng);
+            list.erase(std::next(list.begin(), position));
+        }
+    }) * 1e9 / ops;
+
+    sink = sum(list);
+    return row;
+}
+
+void print(const std::string& name, std::size_t size, const Row& row) {
+    std::cout << "| " << std::setw(22) << std::left << name
+              << " | " << std::setw(11) << std::right << size
+              << std::fixed << std::setprecision(2)
+              << " | " << std::setw(10) << row.build
+              << " | " << std::setw(13) << row.traverse
+              << " | ";
+    if (row.aged >= 0) {
+        std::cout << std::setw(13) << row.aged;
+    } else {
+        std::cout << std::setw(13) << "-";
+    }
+    std::cout << " | " << std::setw(14) << row.insert
+              << " | " << std::setw(14) << row.erase << " |\n";
+    std::string prefix = name + ", " + std::to_string(size) + ": ";
+    bench::report(prefix + "push_back", row.build, "ns");
+    bench::report(prefix + "traverse", row.traverse, "ns");
+    if (row.aged >= 0) {
+        bench::report(prefix + "aged traverse", row.aged, "ns");
+    }
+    bench::report(prefix + "random insert", row.insert, "ns");
+    bench::report(prefix + "random erase", row.erase, "ns");
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t max_size = argc > 1 ? std::stoull(argv[1]) : 1'000'000;
+
+    std::cout << "## " << sizeof(Value) << "-byte elements, times in ns\n\n";
+    std::cout << "UnrolledList chunks: " << lists::UnrolledList<Value>::capacity << " elements in 4 cache lines, "
+              << lists::UnrolledList<Value, lists::cache_line>::capacity << " elements in 1 cache line\n\n";
+    std::cout << "| List                   | Size        | push_back  | traverse/elem | aged traverse | random insert  | random erase   |\n";
+    std::cout << "|------------------------|-------------|------------|---------------|---------------|----------------|----------------|\n";
+    for (std::size_t size = 1000; size <= max_size; size *= 10) {
+        print("VectorList", size, measure<lists::VectorList<Value>, false>(size));
+        print("UnrolledList (1 line)", size, measure<lists::UnrolledList<Value, lists::cache_line>, false>(size));
+        print("UnrolledList (4 lines)", size, measure<lists::UnrolledList<Value>, false>(size));
+        print("PooledList", size, measure<lists::PooledList<Value>, true>(size));
+        print("std::list", size, measure<std::list<Value>, true>(size));
+    }
+    std::cout << "\n\"aged traverse\" is a traversal after the nodes were shuffled around in memory, see age()" << std::endl;
+}
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Header-only list implementations used by list_benchmark.cpp
+//
+// All three share the same small interface (push_back, insert, erase, iteration), so the same
+// benchmark code can run on each of them:
+//   * lists::PooledList   - doubly linked list, nodes come from a pool instead of `new`
+//   * lists::UnrolledList - linked list of cache-line-sized chunks, each holding several elements
+//   * lists::VectorList   - std::vector with the same interface, the contiguous baseline
+
+namespace lists {
+
+inline constexpr std::size_t cache_line = 64;
+
+// ## Node pool
+// Hands out fixed-size node slots from chunks that double in size, freed slots go to a free list.
+// Nodes allocated one after another end up next to each other in memory, unlike with `new`.
+template <typename Node>
+class NodePool {
+public:
+    NodePool() = default;
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    Node* allocate() {
+        if (free_ == nullptr) {
+            refill();
+        }
+        Slot* slot = free_;
+        free_ = slot->next;
+        return reinterpret_cast<Node*>(slot);
+    }
+
+    void deallocate(Node* node) {
+        Slot* slot = reinterpret_cast<Slot*>(node);
+        slot->next = free_;
+        free_ = slot;
+    }
+
+private:
+    union Slot {
+        Slot* next;
+        alignas(Node) std::byte storage[sizeof(Node)];
+    };
+
+    void refill() {
+        std::size_t count = chunks_.empty() ? 64 : std::min<std::size_t>(chunk_size_ * 2, 1 << 16);
+        chunk_size_ = count;
+        chunks_.push_back(std::make_unique<Slot[]>(count));
+        Slot* chunk = chunks_.back().get();
+        // Back to front, so the slots are handed out in address order
+        for (std::size_t i = count; i-- > 0;) {
+            chunk[i].next = free_;
+            free_ = &chunk[i];
+        }
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> chunks_;
+    std::size_t chunk_size_ = 0;
+    Slot* free_ = nullptr;
+};
+
+// ## Doubly linked list
+// Every element lives in its own node with a pointer to the previous and next node. Inserting and erasing
+// at a known position is O(1) and never moves other elements (iterators stay valid), but every step of a
+// traversal is a dependent load - the CPU can't know the address of the next node until the current one arrives.
+template <typename T>
+class PooledList {
+    struct NodeBase {
+        NodeBase* prev;
+        NodeBase* next;
+    };
+    struct Node : NodeBase {
+        T value;
+    };
+
+public:
+    class iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iterator() = default;
+        reference operator*() const { return static_cast<Node*>(node_)->value; }
+        pointer operator->() const { return &static_cast<Node*>(node_)->value; }
+        iterator& operator++() { node_ = node_->next; return *this; }
+        iterator operator++(int) { iterator copy = *this; ++*this; return copy; }
+        iterator& operator--() { node_ = node_->prev; return *this; }
+        iterator operator--(int) { iterator copy = *this; --*this; return copy; }
+        bool operator==(const iterator& other) const { return node_ == other.node_; }
+        bool operator!=(const iterator& other) const { return node_ != other.node_; }
+
+    private:
+        friend class PooledList;
+        explicit iterator(NodeBase* node) : node_(node) {}
+        NodeBase* node_ = nullptr;
+    };
+
+    // The list is circular around a sentinel node, so there are no null checks at the ends
+    PooledList() { sentinel_.prev = sentinel_.next = &sentinel_; }
+    ~PooledList() { clear(); }
+    PooledList(const PooledList&) = delete;
+    PooledList& operator=(const PooledList&) = delete;
+
+    iterator begin() { return iterator(sentinel_.next); }
+    iterator end() { return iterator(&sentinel_); }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    void push_back(const T& value) { insert(end(), value); }
+    void push_front(const T& value) { insert(begin(), value); }
+
+    // Inserts before pos
+    iterator insert(iterator pos, const T& value) {
+        Node* node = pool_.allocate();
+        new (&node->value) T(value);
+        NodeBase* next = pos.node_;
+        node->prev = next->prev;
+        node->next = next;
+        next->prev->next = node;
+        next->prev = node;
+        ++size_;
+        return iterator(node);
+    }
+
+    // Returns the element after the erased one
+    iterator erase(iterator pos) {
+        Node* node = static_cast<Node*>(pos.node_);
+        NodeBase* next = node->next;
+        node->prev->next = next;
+        next->prev = node->prev;
+        node->value.~T();
+        pool_.deallocate(node);
+        --size_;
+        return iterator(next);
+    }
+
+    void clear() {
+        while (!empty()) {
+            erase(begin());
+        }
+    }
+
+private:
+    NodeBase sentinel_;
+    NodePool<Node> pool_;
+    std::size_t size_ = 0;
+};
+
+// ## Unrolled linked list
+// A linked list of chunks, each holding up to `capacity` elements in an array. Traversal walks through
+// whole cache lines before following a pointer, insert/erase only shift the elements of one chunk.
+// Full chunks are split in half on insert, nearly empty chunks are merged with their neighbour on erase.
+//
+// Elements are shifted with memmove, so T has to be trivially copyable. Iterators are invalidated by insert/erase.
+template <typename T, std::size_t ChunkBytes = 4 * cache_line>
+class UnrolledList {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>,
+                  "UnrolledList moves elements with memmove");
+
+    struct ChunkHeader {
+        ChunkHeader* prev;
+        ChunkHeader* next;
+        std::size_t count;
+    };
+
+public:
+    static constexpr std::size_t capacity = (ChunkBytes - sizeof(ChunkHeader)) / sizeof(T);
+    static_assert(capacity >= 2, "ChunkBytes is too small to hold two elements");
+
+private:
+    struct alignas(cache_line) Chunk : ChunkHeader {
+        T items[capacity];
+    };
+
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iterator() = default;
+        reference operator*() const { return chunk_->items[index_]; }
+        pointer operator->() const { return &chunk_->items[index_]; }
+        iterator& operator++() {
+            if (++index_ == chunk_->count) {
+                chunk_ = static_cast<Chunk*>(chunk_->next);
+                index_ = 0;
+            }
+            return *this;
+        }
+        iterator operator++(int) { iterator copy = *this; ++*this; return copy; }
+        bool operator==(const iterator& other) const { return chunk_ == other.chunk_ && index_ == other.index_; }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class UnrolledList;
+        iterator(Chunk* chunk, std::size_t index) : chunk_(chunk), index_(index) {}
+        Chunk* chunk_ = nullptr;
+        std::size_t index_ = 0;
+    };
+
+    UnrolledList() = default;
+    ~UnrolledList() { clear(); }
+    UnrolledList(const UnrolledList&) = delete;
+    UnrolledList& operator=(const UnrolledList&) = delete;
+
+    iterator begin() { return iterator(head_, 0); }
+    iterator end() { return iterator(nullptr, 0); }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // Fills chunks completely, so a list built with push_back is as dense as possible
+    void push_back(const T& value) {
+        if (tail_ == nullptr || tail_->count == capacity) {
+            link_after(tail_, new Chunk());
+        }
+        tail_->items[tail_->count++] = value;
+        ++size_;
+    }
+
+    // Inserts before pos
+    iterator insert(iterator pos, const T& value) {
+        if (pos == end()) {
+            push_back(value);
+            return iterator(tail_, tail_->count - 1);
+        }
+
+        Chunk* chunk = pos.chunk_;
+        std::size_t index = pos.index_;
+        if (chunk->count == capacity) {
+            // Split: the upper half moves to a new chunk
+            Chunk* upper = new Chunk();
+            link_after(chunk, upper);
+            std::size_t keep = capacity / 2;
+            upper->count = capacity - keep;
+            std::memcpy(upper->items, chunk->items + keep, upper->count * sizeof(T));
+            chunk->count = keep;
+            if (index > keep) {
+                chunk = upper;
+                index -= keep;
+            }
+        }
+
+        std::memmove(chunk->items + index + 1, chunk->items + index, (chunk->count - index) * sizeof(T));
+        chunk->items[index] = value;
+        ++chunk->count;
+        ++size_;
+        return iterator(chunk, index);
+    }
+
+    // Returns the element after the erased one
+    iterator erase(iterator pos) {
+        Chunk* chunk = pos.chunk_;
+        std::size_t index = pos.index_;
+        std::memmove(chunk->items + index, chunk->items + index + 1, (chunk->count - index - 1) * sizeof(T));
+        --chunk->count;
+        --size_;
+
+        if (chunk->count == 0) {
+            Chunk* next = static_cast<Chunk*>(chunk->next);
+            unlink(chunk);
+            return iterator(next, 0);
+        }
+
+        // Merge with the next chunk when both are less than half full, so the list doesn't decay into
+        // a regular linked list with one element per chunk
+        Chunk* next = static_cast<Chunk*>(chunk->next);
+        if (next != nullptr && chunk->count + next->count <= capacity / 2) {
+            std::memcpy(chunk->items + chunk->count, next->items, next->count * sizeof(T));
+            chunk->count += next->count;
+            unlink(next);
+        }
+
+        if (index < chunk->count) {
+            return iterator(chunk, index);
+        }
+        return iterator(static_cast<Chunk*>(chunk->next), 0);
+    }
+
+    void clear() {
+        while (head_ != nullptr) {
+            unlink(head_);
+        }
+        size_ = 0;
+    }
+
+private:
+    void link_after(Chunk* prev, Chunk* chunk) {
+        chunk->prev = prev;
+        chunk->next = prev != nullptr ? prev->next : head_;
+        if (chunk->next != nullptr) {
+            chunk->next->prev = chunk;
+        } else {
+            tail_ = chunk;
+        }
+        if (prev != nullptr) {
+            prev->next = chunk;
+        } else {
+            head_ = chunk;
+        }
+    }
+
+    void unlink(Chunk* chunk) {
+        if (chunk->prev != nullptr) {
+            chunk->prev->next = chunk->next;
+        } else {
+            head_ = static_cast<Chunk*>(chunk->next);
+        }
+        if (chunk->next != nullptr) {
+            chunk->next->prev = chunk->prev;
+        } else {
+            tail_ = static_cast<Chunk*>(chunk->prev);
+        }
+        delete chunk;
+    }
+
+    Chunk* head_ = nullptr;
+    Chunk* tail_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// ## Contiguous baseline
+// std::vector behind the same interface. Insert/erase move every element after the position,
+// but moving contiguous memory is the fastest thing a CPU does, and traversal is a linear scan
+// the hardware prefetcher can predict perfectly.
+template <typename T>
+class VectorList {
+public:
+    using iterator = typename std::vector<T>::iterator;
+
+    iterator begin() { return items_.begin(); }
+    iterator end() { return items_.end(); }
+    std::size_t size() const { return items_.size(); }
+    bool empty() const { return items_.empty(); }
+
+    void push_back(const T& value) { items_.push_back(value); }
+    iterator insert(iterator pos, const T& value) { return items_.insert(pos, value); }
+    iterator erase(iterator pos) { return items_.erase(pos); }
+    void clear() { items_.clear(); }
+
+private:
+    std::vector<T> items_;
+};
+
+} // namespace lists
@@ -0,0 +1,190 @@
+// Throughput and latency of the queues from queues.hpp with 1 to N producer/consumer pairs
+//
+// Build: g++ -std=c++20 -O2 -pthread queue_benchmark.cpp -o queue_benchmark
+// Usage: ./queue_benchmark [items per producer = 2000000] [max threads = hardware threads] [capacity = 1024]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "../../../cpp/testing/report.hpp"
+#include "queues.hpp"
+
+struct Item {
+    std::int64_t pushed_at; // steady_clock nanoseconds, used to measure the latency through the queue
+    std::uint64_t payload;
+};
+
+constexpr std::uint64_t stop = std::numeric_limits<std::uint64_t>::max(); // Payload that tells a consumer to quit
+
+std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Spin a little, then give the core away. Pure spinning is fastest when every thread has its own core,
+// but when threads outnumber cores a spinning thread burns the time slice the other side needs to make progress.
+class Backoff {
+public:
+    void wait() {
+        if (spins_ < 64) {
+            ++spins_;
+#if defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#endif
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    int spins_ = 0;
+};
+
+// Blocking push/pop on top of try_push/try_pop. LockedQueue sleeps on its condition variables instead.
+template <typename Queue>
+void push(Queue& queue, const Item& item) {
+    if constexpr (requires { queue.push(item); }) {
+        queue.push(item);
+    } else {
+        Backoff backoff;
+        while (!queue.try_push(item)) {
+            backoff.wait();
+        }
+    }
+}
+
+template <typename Queue>
+Item pop(Queue& queue) {
+    if constexpr (requires { queue.pop(); }) {
+        return queue.pop();
+    } else {
+        Item item;
+        Backoff backoff;
+        while (!queue.try_pop(item)) {
+            backoff.wait();
+        }
+        return item;
+    }
+}
+
+struct Result {
+    double items_per_second;
+    double p50_ns;
+    double p99_ns;
+};
+
+double percentile(std::vector<std::int64_t>& samples, double p) {
+    std::size_t index = static_cast<std::size_t>(p * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return static_cast<double>(samples[index]);
+}
+
+template <typename Queue>
+Result run(unsigned pairs, std::size_t items, std::size_t capacity) {
+    Queue queue(capacity);
+    std::atomic<bool> start{false};
+    std::vector<std::vector<std::int64_t>> latencies(pairs); // One vector per consumer - no sharing while measuring
+    std::vector<std::uint64_t> checksums(pairs);
+
+    std::vector<std::thread> consumers;
+    for (unsigned c = 0; c < pairs; c++) {
+        consumers.emplace_back([&, c] {
+            std::vector<std::int64_t>& samples = latencies[c];
+            samples.reserve(items);
+            std::uint64_t checksum = 0;
+            for (;;) {
+                Item item = pop(queue);
+                if (item.payload == stop) {
+                    break;
+                }
+                samples.push_back(now_ns() - item.pushed_at);
+                checksum += item.payload;
+            }
+            checksums[c] = checksum;
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for (unsigned p = 0; p < pairs; p++) {
+        producers.emplace_back([&] {
+            while (!start.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (std::size_t i = 0; i < items; i++) {
+                push(queue, Item{now_ns(), i});
+            }
+        });
+    }
+
+    std::int64_t begin = now_ns();
+    start.store(true, std::memory_order_release);
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    for (unsigned c = 0; c < pairs; c++) {
+        push(queue, Item{0, stop}); // Every item before this one has been pushed, so consumers drain everything first
+    }
+    for (std::thread& consumer : consumers) {
+        consumer.join();
+    }
+    double seconds = (now_ns() - begin) * 1e-9;
+
+    std::vector<std::int64_t> samples;
+    std::uint64_t checksum = 0;
+    for (unsigned c = 0; c < pairs; c++) {
+        samples.insert(samples.end(), latencies[c].begin(), latencies[c].end());
+        checksum += checksums[c];
+    }
+    std::uint64_t expected = pairs * (items * (items - 1) / 2);
+    if (checksum != expected || samples.size() != pairs * items) {
+        std::cerr << "Lost or duplicated items!" << std::endl;
+        std::exit(1);
+    }
+
+    return {pairs * items / seconds, percentile(samples, 0.50), percentile(samples, 0.99)};
+}
+
+void print(const std::string& name, unsigned pairs, const Result& result) {
+    std::cout << "| " << std::setw(22) << std::left << name
+              << " | " << std::setw(9) << std::right << pairs
+              << " | " << std::setw(9) << std::fixed << std::setprecision(2) << result.items_per_second / 1e6
+              << " | " << std::setw(9) << std::setprecision(0) << result.p50_ns
+              << " | " << std::setw(10) << result.p99_ns << " |\n";
+    std::string prefix = name + ", " + std::to_string(pairs) + (pairs == 1 ? " pair: " : " pairs: ");
+    bench::report(prefix + "throughput", result.items_per_second / 1e6, "Mitems/s");
+    bench::report(prefix + "p50 latency", result.p50_ns, "ns");
+    bench::report(prefix + "p99 latency", result.p99_ns, "ns");
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t items = argc > 1 ? std::stoull(argv[1]) : 2'000'000;
+    unsigned max_threads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    std::size_t capacity = argc > 3 ? std::stoull(argv[3]) : 1024;
+
+    std::cout << "## " << items << " items per producer, capacity " << capacity << ", "
+              << std::thread::hardware_concurrency() << " hardware threads\n\n";
+    std::cout << "| Queue                  | Prod/Cons | Mitems/s  | p50 (ns)  | p99 (ns)   |\n";
+    std::cout << "|------------------------|-----------|-----------|-----------|------------|\n";
+
+    // The SPSC queue only supports one pair
+    print("SpscQueue", 1, run<queues::SpscQueue<Item>>(1, items, capacity));
+    print("SpscQueue (unpadded)", 1, run<queues::SpscQueue<Item, false>>(1, items, capacity));
+
+    // One producer and one consumer per step, so 2 * pairs threads
+    for (unsigned pairs = 1; pairs == 1 || 2 * pairs <= max_threads; pairs *= 2) {
+        print("MpmcQueue", pairs, run<queues::MpmcQueue<Item>>(pairs, items, capacity));
+        print("LockedQueue", pairs, run<queues::LockedQueue<Item>>(pairs, items, capacity));
+    }
+    std::cout << "\nLatency is the time between push() and pop() of the same item" << std::endl;
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+// Header-only bounded FIFO queues used by queue_benchmark.cpp
+//   * queues::MpmcQueue   - lock-free, any number of producers and consumers
+//   * queues::SpscQueue   - lock-free, exactly one producer and one consumer
+//   * queues::LockedQueue - std::mutex + std::condition_variable, the baseline
+//
+// All of them are fixed-size ring buffers: the capacity is rounded up to a power of 2, so wrapping
+// an index around is a single AND instead of a division. try_push() fails when the queue is full,
+// try_pop() fails when it's empty.
+
+namespace queues {
+
+// Two variables written by different threads must not share a cache line. If they do, every write
+// invalidates the line in the other core's cache even though the threads never touch each other's data
+// ("false sharing"). std::hardware_destructive_interference_size is the standard name for this, but
+// isn't available everywhere and GCC warns that its value may change, so we hardcode the x86/ARM value.
+inline constexpr std::size_t cache_line = 64;
+
+inline std::size_t round_up_to_power_of_2(std::size_t value) {
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// ## Multi-producer multi-consumer queue
+// Dmitry Vyukov's bounded MPMC queue. Every cell carries a sequence number that says whose turn it is:
+//   * sequence == position         - the cell is free for the producer that claims `position`
+//   * sequence == position + 1     - the cell holds a value for the consumer that claims `position`
+// Producers claim a position with a CAS on enqueue_pos_, write the value and then publish it by bumping the
+// sequence. No thread ever waits for a lock, and producers only contend with other producers (consumers with consumers).
+template <typename T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(std::size_t capacity)
+        : mask_(round_up_to_power_of_2(capacity) - 1),
+          cells_(std::make_unique<Cell[]>(mask_ + 1)) {
+        if (capacity < 2) {
+            throw std::invalid_argument("MpmcQueue capacity must be at least 2");
+        }
+        for (std::size_t i = 0; i <= mask_; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    bool try_push(const T& value) {
+        std::size_t position = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[position & mask_];
+            std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // The consumer of the previous lap hasn't emptied the cell yet - full
+            } else {
+                position = enqueue_pos_.load(std::memory_order_relaxed); // Another producer got there first
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& value) {
+        std::size_t position = dequeue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[position & mask_];
+            std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Nothing published at this position yet - empty
+            } else {
+                position = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        value = cell->value;
+        cell->sequence.store(position + mask_ + 1, std::memory_order_release); // Free for the producer of the next lap
+        return true;
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    const std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(cache_line) std::atomic<std::size_t> enqueue_pos_{0};
+    alignas(cache_line) std::atomic<std::size_t> dequeue_pos_{0};
+};
+
+// ## Single-producer single-consumer queue
+// With only one writer per index no CAS is needed: the producer owns tail_, the consumer owns head_, and
+// each only reads the other's index. Each side also keeps a cached copy of the other side's index and only
+// re-reads the shared one when the cached value says the queue is full/empty, which keeps the cache line
+// holding the other index from bouncing between the cores on every operation.
+//
+// Padded = false packs the indices next to each other, to show what false sharing costs.
+template <typename T, bool Padded = true>
+class SpscQueue {
+    static constexpr std::size_t align = Padded ? cache_line : alignof(std::atomic<std::size_t>);
+
+public:
+    explicit SpscQueue(std::size_t capacity)
+        : mask_(round_up_to_power_of_2(capacity) - 1),
+          items_(std::make_unique<T[]>(mask_ + 1)) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer only
+    bool try_push(const T& value) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) {
+                return false;
+            }
+        }
+        items_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    bool try_pop(T& value) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        value = items_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+private:
+    // The indices only ever grow; index & mask_ is the slot. tail_ - head_ is the number of queued items.
+    const std::size_t mask_;
+    std::unique_ptr<T[]> items_;
+    alignas(align) std::atomic<std::size_t> head_{0}; // Written by the consumer
+    alignas(align) std::size_t cached_tail_ = 0;      // Consumer's copy of tail_
+    alignas(align) std::atomic<std::size_t> tail_{0}; // Written by the producer
+    alignas(align) std::size_t cached_head_ = 0;      // Producer's copy of head_
+};
+
+// ## Locked queue
+// A ring buffer guarded by one mutex. Simple and correct for any number of threads, but every operation
+// serializes on the lock, and a thread that's descheduled while holding it stalls everyone else (a "lock convoy").
+// push()/pop() sleep on a condition variable instead of spinning.
+template <typename T>
+class LockedQueue {
+public:
+    explicit LockedQueue(std::size_t capacity) : items_(round_up_to_power_of_2(capacity)) {}
+
+    bool try_push(const T& value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (tail_ - head_ == items_.size()) {
+                return false;
+            }
+            items_[tail_++ & (items_.size() - 1)] = value;
+        }
+        not_empty_.notify_one();
+        return true;
+    }
+
+    bool try_pop(T& value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (tail_ == head_) {
+                return false;
+            }
+            value = items_[head_++ & (items_.size() - 1)];
+        }
+        not_full_.notify_one();
+        return true;
+    }
+
+    // Blocks while the queue is full
+    void push(const T& value) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_full_.wait(lock, [this] { return tail_ - head_ < items_.size(); });
+            items_[tail_++ & (items_.size() - 1)] = value;
+        }
+        not_empty_.notify_one();
+    }
+
+    // Blocks while the queue is empty
+    T pop() {
+        T value;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this] { return tail_ != head_; });
+            value = items_[head_++ & (items_.size() - 1)];
+        }
+        not_full_.notify_one();
+        return value;
+    }
+
+    std::size_t capacity() const { return items_.size(); }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::vector<T> items_;
+    std::size_t head_ = 0;
+    std::size_t tail_ = 0;
+};
+
+} // namespace queues
@@ -0,0 +1,179 @@
+// Fork/join scaling of the work-stealing pool vs the shared queue pool from thread_pool.hpp
+//
+// Build: g++ -std=c++20 -O2 -pthread scheduler_benchmark.cpp -o scheduler_benchmark
+// Usage: ./scheduler_benchmark [fibonacci n = 35] [sort size = 10000000] [max threads = hardware threads]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../../../cpp/testing/report.hpp"
+#include "stacks.hpp"
+#include "thread_pool.hpp"
+
+template <typename F>
+double seconds(F&& work) {
+    auto begin = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// ## Fibonacci fan-out
+// The classic scheduler stress test: almost no work per task, so the run time is mostly spawn/steal/join overhead.
+constexpr int fib_cutoff = 10; // Below this a task would cost more than the work it does
+
+std::uint64_t fib_serial(int n) {
+    return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+template <typename Pool>
+std::uint64_t fib(Pool& pool, int n) {
+    if (n < fib_cutoff) {
+        return fib_serial(n);
+    }
+    std::uint64_t left = 0;
+    tasks::TaskGroup group;
+    pool.spawn(group, [&pool, &left, n] { left = fib(pool, n - 1); });
+    std::uint64_t right = fib(pool, n - 2);
+    pool.wait(group);
+    return left + right;
+}
+
+// ## Parallel quicksort
+// Partition, sort one half as a new task and the other half on this thread. Small ranges are sorted serially,
+// without recursion: the pending ranges are kept on an explicit ArrayStack.
+constexpr std::ptrdiff_t sort_cutoff = 4096;
+
+void insertion_sort(int* first, int* last) {
+    for (int* i = first + 1; i < last; i++) {
+        int value = *i;
+        int* j = i;
+        for (; j > first && *(j - 1) > value; j--) {
+            *j = *(j - 1);
+        }
+        *j = value;
+    }
+}
+
+// Splits [first, last) into < pivot, == pivot, > pivot and returns the bounds of the middle part
+std::pair<int*, int*> partition(int* first, int* last) {
+    int a = *first, b = first[(last - first) / 2], c = *(last - 1);
+    int pivot = std::max(std::min(a, b), std::min(std::max(a, b), c)); // Median of three
+    int* less_end = std::partition(first, last, [pivot](int x) { return x < pivot; });
+    int* equal_end = std::partition(less_end, last, [pivot](int x) { return !(pivot < x); });
+    return {less_end, equal_end};
+}
+
+void serial_quicksort(int* first, int* last) {
+    stacks::ArrayStack<std::pair<int*, int*>> pending(64);
+    pending.push({first, last});
+    while (!pending.empty()) {
+        auto [begin, end] = pending.pop();
+        if (end - begin <= 16) {
+            insertion_sort(begin, end);
+            continue;
+        }
+        auto [less_end, equal_end] = partition(begin, end);
+        pending.push({begin, less_end});
+        pending.push({equal_end, end});
+    }
+}
+
+template <typename Pool>
+void quicksort(Pool& pool, int* first, int* last) {
+    if (last - first <= sort_cutoff) {
+        serial_quicksort(first, last);
+        return;
+    }
+    auto [less_end, equal_end] = partition(first, last);
+    tasks::TaskGroup group;
+    pool.spawn(group, [&pool, first, less_end = less_end] { quicksort(pool, first, less_end); });
+    quicksort(pool, equal_end, last);
+    pool.wait(group);
+}
+
+// ## Harness
+void print(const std::string& pool, const std::string& benchmark, unsigned threads, double time, double baseline, std::size_t steals) {
+    std::cout << "| " << std::setw(16) << std::left << pool
+              << " | " << std::setw(10) << benchmark
+              << " | " << std::setw(7) << std::right << threads
+              << " | " << std::setw(9) << std::fixed << std::setprecision(1) << time * 1e3
+              << " | " << std::setw(7) << std::setprecision(2) << baseline / time
+              << " | " << std::setw(9) << steals << " |\n";
+    bench::report(pool + ", " + std::to_string(threads) + (threads == 1 ? " thread: " : " threads: ") + benchmark,
+                  time * 1e3, "ms");
+}
+
+// Single-threaded times without any pool, the speedups are relative to these
+struct Baseline {
+    double fib;
+    double sort;
+};
+
+template <typename Pool>
+void measure(const std::string& name, unsigned threads, int fib_n, const std::vector<int>& input, const Baseline& baseline) {
+    Pool pool(threads);
+
+    std::uint64_t result = 0;
+    double fib_time = seconds([&] { pool.run([&] { result = fib(pool, fib_n); }); });
+    if (result != fib_serial(fib_n)) {
+        std::cerr << name << ": wrong Fibonacci result" << std::endl;
+        std::exit(1);
+    }
+    print(name, "fib(" + std::to_string(fib_n) + ")", threads, fib_time, baseline.fib, pool.steals());
+
+    std::size_t steals_before = pool.steals();
+    std::vector<int> data = input;
+    double sort_time = seconds([&] { pool.run([&] { quicksort(pool, data.data(), data.data() + data.size()); }); });
+    if (!std::is_sorted(data.begin(), data.end())) {
+        std::cerr << name << ": quicksort didn't sort" << std::endl;
+        std::exit(1);
+    }
+    print(name, "quicksort", threads, sort_time, baseline.sort, pool.steals() - steals_before);
+}
+
+int main(int argc, char* argv[]) {
+    int fib_n = argc > 1 ? std::stoi(argv[1]) : 35;
+    std::size_t sort_size = argc > 2 ? std::stoull(argv[2]) : 10'000'000;
+    unsigned max_threads = argc > 3 ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<int> input(sort_size);
+    std::mt19937 rng(42);
+    for (int& value : input) {
+        value = static_cast<int>(rng());
+    }
+
+    std::vector<unsigned> thread_counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    Baseline baseline{};
+    volatile std::uint64_t sink = 0;
+    baseline.fib = seconds([&] { sink = fib_serial(fib_n); });
+    std::vector<int> serial = input;
+    baseline.sort = seconds([&] { serial_quicksort(serial.data(), serial.data() + serial.size()); });
+
+    std::cout << "## fib(" << fib_n << ") with tasks down to n = " << fib_cutoff << ", quicksort of " << sort_size
+              << " ints with tasks down to " << sort_cutoff << " elements\n\n";
+    std::cout << "| Pool             | Benchmark  | Threads | Time (ms) | Speedup | Steals    |\n";
+    std::cout << "|------------------|------------|---------|-----------|---------|-----------|\n";
+    for (unsigned threads : thread_counts) {
+        measure<tasks::WorkStealingPool>("WorkStealingPool", threads, fib_n, input, baseline);
+    }
+    for (unsigned threads : thread_counts) {
+        measure<tasks::SharedQueuePool>("SharedQueuePool", threads, fib_n, input, baseline);
+    }
+    std::cout << "\nSpeedup is relative to the same work done serially without a pool: fib " << baseline.fib * 1e3
+              << " ms, quicksort " << baseline.sort * 1e3 << " ms" << std::endl;
+    bench::report("Serial: fib(" + std::to_string(fib_n) + ")", baseline.fib * 1e3, "ms");
+    bench::report("Serial: quicksort", baseline.sort * 1e3, "ms");
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Header-only stacks used by thread_pool.hpp and scheduler_benchmark.cpp
+//   * stacks::ArrayStack    - plain contiguous stack
+//   * stacks::ChaseLevDeque - work-stealing deque: a stack for its owner thread, a queue for everyone else
+
+namespace stacks {
+
+inline constexpr std::size_t cache_line = 64;
+
+// ## Contiguous stack
+// The elements live in one growing array and the top of the stack is the end of the array, so push and pop
+// never move other elements and the most recently used elements are the ones most likely to be in the cache.
+template <typename T>
+class ArrayStack {
+public:
+    ArrayStack() = default;
+    explicit ArrayStack(std::size_t reserve) { items_.reserve(reserve); }
+
+    void push(const T& value) { items_.push_back(value); }
+    void push(T&& value) { items_.push_back(std::move(value)); }
+
+    template <typename... Args>
+    T& emplace(Args&&... args) { return items_.emplace_back(std::forward<Args>(args)...); }
+
+    // Undefined behaviour on an empty stack, same as std::stack
+    T pop() {
+        T value = std::move(items_.back());
+        items_.pop_back();
+        return value;
+    }
+
+    T& top() { return items_.back(); }
+    std::size_t size() const { return items_.size(); }
+    bool empty() const { return items_.empty(); }
+
+private:
+    std::vector<T> items_;
+};
+
+// ## Chase-Lev work-stealing deque
+// Owned by one thread, which pushes and pops at the bottom - exactly like a stack, so it always works on the
+// newest (and cache-hot) item. Other threads ("thieves") steal from the top, taking the oldest item - in fork/join
+// code that's the biggest piece of remaining work, so one steal keeps a thief busy for a long time.
+//
+// The owner and the thieves only race when there's a single item left, and that race is settled by a CAS on top_.
+// Everything else is plain loads and stores. This is the C11 version from "Correct and Efficient Work-Stealing
+// for Weak Memory Models" (Lê, Pop, Cohen, Zappa Nardelli, 2013).
+//
+// T has to be trivially copyable (usually a pointer): thieves may read a slot while the owner overwrites it.
+template <typename T>
+class ChaseLevDeque {
+    static_assert(std::is_trivially_copyable_v<T>, "ChaseLevDeque slots are read and written concurrently");
+
+    // Circular buffer. When it's full the owner copies it into one twice as big; the old buffer is kept alive
+    // until the deque is destroyed, because a slow thief may still be reading from it.
+    struct Buffer {
+        explicit Buffer(std::int64_t capacity)
+            : mask(capacity - 1), slots(std::make_unique<std::atomic<T>[]>(capacity)) {}
+
+        T get(std::int64_t index) const { return slots[index & mask].load(std::memory_order_relaxed); }
+        void put(std::int64_t index, T value) { slots[index & mask].store(value, std::memory_order_relaxed); }
+        std::int64_t capacity() const { return mask + 1; }
+
+        std::int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+public:
+    explicit ChaseLevDeque(std::int64_t capacity = 256) {
+        buffers_.push_back(std::make_unique<Buffer>(capacity));
+        buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    // Owner only
+    void push(T value) {
+        std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        std::int64_t top = top_.load(std::memory_order_acquire);
+        Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+        if (bottom - top > buffer->capacity() - 1) {
+            buffer = grow(buffer, bottom, top);
+        }
+        buffer->put(bottom, value);
+        // The paper uses a release fence + relaxed store here; a release store is the same thing for a single
+        // variable, costs nothing extra on x86, and is understood by ThreadSanitizer
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    // Owner only. Takes the newest item
+    std::optional<T> pop() {
+        std::int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed); // Reserve the item before looking at top_
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom) { // Was empty
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        T value = buffer->get(bottom);
+        if (top == bottom) {
+            // Last item - a thief may be going for it too, whoever moves top_ first gets it
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            if (!won) {
+                return std::nullopt;
+            }
+        }
+        return value;
+    }
+
+    // Any thread. Takes the oldest item. Also fails when it loses a race, so callers just try another victim
+    std::optional<T> steal() {
+        std::int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return std::nullopt;
+        }
+
+        Buffer* buffer = buffer_.load(std::memory_order_acquire);
+        T value = buffer->get(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    // Only a snapshot when other threads are active
+    std::int64_t size() const {
+        return bottom_.load(std::memory_order_relaxed) - top_.load(std::memory_order_relaxed);
+    }
+
+private:
+    Buffer* grow(Buffer* old, std::int64_t bottom, std::int64_t top) {
+        buffers_.push_back(std::make_unique<Buffer>(old->capacity() * 2));
+        Buffer* bigger = buffers_.back().get();
+        for (std::int64_t i = top; i < bottom; i++) {
+            bigger->put(i, old->get(i));
+        }
+        buffer_.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+    // top_ is hit by every thief, bottom_ by the owner on every push/pop - keep them on separate cache lines
+    alignas(cache_line) std::atomic<std::int64_t> top_{0};
+    alignas(cache_line) std::atomic<std::int64_t> bottom_{0};
+    alignas(cache_line) std::atomic<Buffer*> buffer_{nullptr};
+    std::vector<std::unique_ptr<Buffer>> buffers_; // Owner only
+};
+
+} // namespace stacks
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "stacks.hpp"
+
+// Fork/join thread pools used by scheduler_benchmark.cpp
+//   * tasks::WorkStealingPool - one ChaseLevDeque per worker, idle workers steal from the others
+//   * tasks::SharedQueuePool  - one std::deque behind one mutex, shared by all workers (the baseline)
+//
+// Both have the same interface:
+//   tasks::TaskGroup group;
+//   pool.spawn(group, [] { ... }); // fork - may run on any worker
+//   pool.wait(group);              // join - a worker that waits keeps running other tasks in the meantime
+//
+// Waiting workers have to keep working, otherwise recursive fork/join code deadlocks as soon as every worker
+// is waiting for a child task that nobody is left to run.
+
+namespace tasks {
+
+// Counts the spawned tasks that haven't finished yet
+struct TaskGroup {
+    std::atomic<std::int64_t> pending{0};
+};
+
+struct Task {
+    std::function<void()> work;
+    TaskGroup* group;
+};
+
+inline void execute(Task* task) {
+    task->work();
+    task->group->pending.fetch_sub(1, std::memory_order_release);
+    delete task;
+}
+
+// ## Work-stealing pool
+// Every worker pushes the tasks it spawns onto its own deque and pops them back LIFO, so most tasks run on
+// the thread that created them, right after their data was touched, without any shared state. Only an idle
+// worker touches another worker's deque, and it steals the oldest task there (see ChaseLevDeque).
+// Threads outside the pool submit through a small mutex-protected queue.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threads) {
+        for (unsigned i = 0; i < threads; i++) {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+        for (unsigned i = 0; i < threads; i++) {
+            workers_[i]->thread = std::thread([this, i] { worker_loop(i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        stop_.store(true, std::memory_order_release);
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker->thread.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    template <typename F>
+    void spawn(TaskGroup& group, F&& work) {
+        group.pending.fetch_add(1, std::memory_order_relaxed);
+        Task* task = new Task{std::forward<F>(work), &group};
+        if (current_pool_ == this) {
+            workers_[current_index_]->deque.push(task);
+        } else {
+            std::lock_guard<std::mutex> lock(injected_mutex_);
+            injected_.push_back(task);
+            injected_count_.fetch_add(1, std::memory_order_release);
+        }
+        if (sleepers_.load(std::memory_order_relaxed) > 0) {
+            wake_.notify_one();
+        }
+    }
+
+    void wait(TaskGroup& group) {
+        if (current_pool_ != this) {
+            // Not one of our workers - nothing to help with, just wait
+            while (group.pending.load(std::memory_order_acquire) != 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+            }
+            return;
+        }
+        while (group.pending.load(std::memory_order_acquire) != 0) {
+            if (Task* task = find_task(current_index_)) {
+                execute(task);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Runs work on the pool and blocks until it and everything it spawned has finished
+    template <typename F>
+    void run(F&& work) {
+        TaskGroup group;
+        spawn(group, std::forward<F>(work));
+        wait(group);
+    }
+
+    std::size_t threads() const { return workers_.size(); }
+
+    std::size_t steals() const {
+        std::size_t total = 0;
+        for (const auto& worker : workers_) {
+            total += worker->steals.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+private:
+    struct Worker {
+        stacks::ChaseLevDeque<Task*> deque;
+        std::thread thread;
+        alignas(stacks::cache_line) std::atomic<std::size_t> steals{0}; // Written only by this worker
+        std::uint32_t victim_seed = 0;
+    };
+
+    Task* find_task(std::size_t self) {
+        Worker& worker = *workers_[self];
+        if (std::optional<Task*> task = worker.deque.pop()) {
+            return *task;
+        }
+
+        if (injected_count_.load(std::memory_order_acquire) > 0) {
+            std::lock_guard<std::mutex> lock(injected_mutex_);
+            if (!injected_.empty()) {
+                Task* task = injected_.front();
+                injected_.pop_front();
+                injected_count_.fetch_sub(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+
+        // Start at a pseudo-random victim so the thieves don't all line up behind worker 0
+        std::size_t count = workers_.size();
+        worker.victim_seed = worker.victim_seed * 1664525u + 1013904223u;
+        std::size_t start = worker.victim_seed % count;
+        for (std::size_t i = 0; i < count; i++) {
+            std::size_t victim = (start + i) % count;
+            if (victim == self) {
+                continue;
+            }
+            if (std::optional<Task*> task = workers_[victim]->deque.steal()) {
+                worker.steals.store(worker.steals.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return *task;
+            }
+        }
+        return nullptr;
+    }
+
+    void worker_loop(std::size_t index) {
+        current_pool_ = this;
+        current_index_ = index;
+        workers_[index]->victim_seed = static_cast<std::uint32_t>(index * 2654435761u + 1);
+
+        unsigned idle = 0;
+        while (!stop_.load(std::memory_order_acquire)) {
+            if (Task* task = find_task(index)) {
+                execute(task);
+                idle = 0;
+            } else if (++idle < 64) {
+                std::this_thread::yield();
+            } else {
+                // Nothing to do for a while - sleep. spawn() doesn't take the mutex before notifying, so a wakeup
+                // can be missed; the timeout bounds how long that leaves a task waiting.
+                sleepers_.fetch_add(1, std::memory_order_relaxed);
+                {
+                    std::unique_lock<std::mutex> lock(sleep_mutex_);
+                    wake_.wait_for(lock, std::chrono::milliseconds(1));
+                }
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                idle = 0;
+            }
+        }
+        current_pool_ = nullptr;
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    std::mutex injected_mutex_;
+    std::deque<Task*> injected_;
+    std::atomic<std::size_t> injected_count_{0};
+
+    std::atomic<bool> stop_{false};
+    std::atomic<int> sleepers_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+
+    static inline thread_local WorkStealingPool* current_pool_ = nullptr;
+    static inline thread_local std::size_t current_index_ = 0;
+};
+
+// ## Shared queue pool
+// The textbook thread pool: every spawn and every pop goes through the same mutex. With coarse tasks the lock
+// is barely noticed, with fine-grained tasks all workers spend their time queueing for it.
+//
+// Tasks are taken from the back (newest first), like the owner end of a work-stealing deque. Taking the oldest
+// task while helping in wait() expands the task tree breadth-first, and every helped task nests another wait()
+// on the stack until the thread's stack overflows.
+class SharedQueuePool {
+public:
+    explicit SharedQueuePool(unsigned threads) {
+        for (unsigned i = 0; i < threads; i++) {
+            threads_.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    ~SharedQueuePool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        not_empty_.notify_all();
+        for (std::thread& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    SharedQueuePool(const SharedQueuePool&) = delete;
+    SharedQueuePool& operator=(const SharedQueuePool&) = delete;
+
+    template <typename F>
+    void spawn(TaskGroup& group, F&& work) {
+        group.pending.fetch_add(1, std::memory_order_relaxed);
+        Task* task = new Task{std::forward<F>(work), &group};
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(task);
+        }
+        not_empty_.notify_one();
+    }
+
+    void wait(TaskGroup& group) {
+        if (!is_worker_) {
+            while (group.pending.load(std::memory_order_acquire) != 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+            }
+            return;
+        }
+        while (group.pending.load(std::memory_order_acquire) != 0) {
+            Task* task = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!queue_.empty()) {
+                    task = queue_.back();
+                    queue_.pop_back();
+                }
+            }
+            if (task != nullptr) {
+                execute(task);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    template <typename F>
+    void run(F&& work) {
+        TaskGroup group;
+        spawn(group, std::forward<F>(work));
+        wait(group);
+    }
+
+    std::size_t threads() const { return threads_.size(); }
+    std::size_t steals() const { return 0; }
+
+private:
+    void worker_loop() {
+        is_worker_ = true;
+        for (;;) {
+            Task* task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                not_empty_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                if (queue_.empty()) {
+                    return; // stop_ and nothing left
+                }
+                task = queue_.back();
+                queue_.pop_back();
+            }
+            execute(task);
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::deque<Task*> queue_;
+    bool stop_ = false;
+
+    // A thread is only ever a worker of one SharedQueuePool, so a flag is enough
+    static inline thread_local bool is_worker_ = false;
+};
+
+} // namespace tasks
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// B+tree with cache-line-sized nodes
+//
+// A node holds many sorted keys instead of one, so a lookup follows log_B(n) pointers instead of log_2(n), and
+// searching inside a node is a linear scan over a few contiguous cache lines, which the hardware prefetcher
+// fetches in parallel. All values live in the leaves, and the leaves are linked together, so a range scan is a
+// walk over contiguous arrays.
+//
+// NodeBytes sets the node size; the key/child counts are derived from it. Keys and values are copied around with
+// plain assignment, so they should be small trivially copyable types (ints, pointers, ids).
+
+namespace trees {
+
+inline constexpr std::size_t cache_line = 64;
+
+template <typename K, typename V, std::size_t NodeBytes = 4 * cache_line>
+class BPlusTree {
+    static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>, "BPlusTree copies keys and values around");
+
+    // Common header of inner nodes and leaves
+    struct Node {
+        std::uint32_t count; // keys in the node
+        bool leaf;
+    };
+
+public:
+    // Inner node: count keys and count + 1 children. Child i holds the keys < keys[i], child i + 1 the keys >= keys[i]
+    static constexpr std::size_t inner_capacity = (NodeBytes - sizeof(Node) - sizeof(void*)) / (sizeof(K) + sizeof(void*));
+    // Leaf: count keys and values and a pointer to the next leaf
+    static constexpr std::size_t leaf_capacity = (NodeBytes - sizeof(Node) - sizeof(void*)) / (sizeof(K) + sizeof(V));
+    static_assert(inner_capacity >= 3 && leaf_capacity >= 2, "NodeBytes is too small");
+
+private:
+    struct alignas(cache_line) Inner : Node {
+        K keys[inner_capacity];
+        Node* children[inner_capacity + 1];
+    };
+
+    struct alignas(cache_line) Leaf : Node {
+        K keys[leaf_capacity];
+        V values[leaf_capacity];
+        Leaf* next;
+    };
+
+    static_assert(sizeof(Inner) <= NodeBytes && sizeof(Leaf) <= NodeBytes);
+
+public:
+    BPlusTree() = default;
+    ~BPlusTree() { clear(); }
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    // Returns false (and leaves the old value) if the key already exists
+    bool insert(const K& key, const V& value) {
+        if (root_ == nullptr) {
+            root_ = new_leaf();
+        }
+        Split split;
+        InsertResult result = insert(root_, key, value, split);
+        if (result == InsertResult::exists) {
+            return false;
+        }
+        if (result == InsertResult::split) {
+            // The root split - the tree grows one level at the top
+            Inner* root = new_inner();
+            root->count = 1;
+            root->keys[0] = split.key;
+            root->children[0] = root_;
+            root->children[1] = split.right;
+            root_ = root;
+        }
+        ++size_;
+        return true;
+    }
+
+    const V* find(const K& key) const {
+        if (root_ == nullptr) {
+            return nullptr;
+        }
+        const Leaf* leaf = find_leaf(key);
+        std::size_t index = lower_bound(leaf->keys, leaf->count, key);
+        if (index < leaf->count && !(key < leaf->keys[index])) {
+            return &leaf->values[index];
+        }
+        return nullptr;
+    }
+
+    // Calls visit(key, value) for up to `count` keys in order, starting at the first key >= from.
+    // Returns how many keys were visited
+    template <typename F>
+    std::size_t scan(const K& from, std::size_t count, F&& visit) const {
+        if (root_ == nullptr) {
+            return 0;
+        }
+        const Leaf* leaf = find_leaf(from);
+        std::size_t index = lower_bound(leaf->keys, leaf->count, from);
+        std::size_t visited = 0;
+        while (leaf != nullptr && visited < count) {
+            for (; index < leaf->count && visited < count; index++, visited++) {
+                visit(leaf->keys[index], leaf->values[index]);
+            }
+            leaf = leaf->next;
+            index = 0;
+        }
+        return visited;
+    }
+
+    // Replaces the contents with the given pairs, which must be sorted by key with no duplicates.
+    // Leaves are filled to `fill` (0-1] of their capacity and the inner levels are built bottom-up, in O(n)
+    // and without a single split. Leaving some room (fill < 1) makes later inserts cheaper.
+    // A fill outside (0, 1] would overrun the leaves - it throws std::invalid_argument and leaves the tree as it was.
+    void bulk_load(const std::vector<std::pair<K, V>>& sorted, double fill = 1.0) {
+        if (!(fill > 0 && fill <= 1)) { // Also catches NaN
+            throw std::invalid_argument("BPlusTree::bulk_load: fill must be in (0, 1]");
+        }
+        clear();
+        if (sorted.empty()) {
+            return;
+        }
+        std::size_t per_leaf = std::max<std::size_t>(1, static_cast<std::size_t>(leaf_capacity * fill));
+
+        // Level 0: the leaves, plus the smallest key of each (the separator its parent needs)
+        std::vector<Node*> level;
+        std::vector<K> first_keys;
+        Leaf* previous = nullptr;
+        for (std::size_t i = 0; i < sorted.size(); i += per_leaf) {
+            Leaf* leaf = new_leaf();
+            std::size_t count = std::min(per_leaf, sorted.size() - i);
+            for (std::size_t j = 0; j < count; j++) {
+                leaf->keys[j] = sorted[i + j].first;
+                leaf->values[j] = sorted[i + j].second;
+            }
+            leaf->count = static_cast<std::uint32_t>(count);
+            if (previous != nullptr) {
+                previous->next = leaf;
+            }
+            previous = leaf;
+            level.push_back(leaf);
+            first_keys.push_back(sorted[i].first);
+        }
+
+        // Inner levels until a single node is left
+        while (level.size() > 1) {
+            std::vector<Node*> parents;
+            std::vector<K> parent_first_keys;
+            std::size_t per_node = inner_capacity + 1; // children per inner node
+            for (std::size_t i = 0; i < level.size(); i += per_node) {
+                std::size_t children = std::min(per_node, level.size() - i);
+                if (children == 1 && !parents.empty()) {
+                    // A lone last child can't form a node by itself - move the previous (full) node's last
+                    // child over to make a pair
+                    Inner* last = static_cast<Inner*>(parents.back());
+                    --last->count;
+                    Inner* inner = new_inner();
+                    inner->count = 1;
+                    inner->children[0] = last->children[last->count + 1];
+                    inner->children[1] = level[i];
+                    inner->keys[0] = first_keys[i];
+                    parents.push_back(inner);
+                    parent_first_keys.push_back(first_keys[i - 1]);
+                    continue;
+                }
+                Inner* inner = new_inner();
+                inner->count = static_cast<std::uint32_t>(children - 1);
+                for (std::size_t j = 0; j < children; j++) {
+                    inner->children[j] = level[i + j];
+                    if (j > 0) {
+                        inner->keys[j - 1] = first_keys[i + j];
+                    }
+                }
+                parents.push_back(inner);
+                parent_first_keys.push_back(first_keys[i]);
+            }
+            level = std::move(parents);
+            first_keys = std::move(parent_first_keys);
+        }
+        root_ = level[0];
+        size_ = sorted.size();
+    }
+
+    void clear() {
+        if (root_ != nullptr) {
+            destroy(root_);
+        }
+        root_ = nullptr;
+        size_ = 0;
+    }
+
+    std::size_t size() const { return size_; }
+
+private:
+    enum class InsertResult { inserted, exists, split };
+
+    // When a node splits, its parent needs the new right node and the smallest key in it
+    struct Split {
+        K key;
+        Node* right;
+    };
+
+    static Leaf* new_leaf() {
+        Leaf* leaf = new Leaf();
+        leaf->leaf = true;
+        leaf->count = 0;
+        leaf->next = nullptr;
+        return leaf;
+    }
+
+    static Inner* new_inner() {
+        Inner* inner = new Inner();
+        inner->leaf = false;
+        inner->count = 0;
+        return inner;
+    }
+
+    // Number of keys < key. A linear scan without an early exit: the compiler can vectorize it, and there's no
+    // unpredictable branch - for a node that fits in a few cache lines that beats binary search
+    static std::size_t lower_bound(const K* keys, std::size_t count, const K& key) {
+        std::size_t index = 0;
+        for (std::size_t i = 0; i < count; i++) {
+            index += keys[i] < key;
+        }
+        return index;
+    }
+
+    // Number of keys <= key - the child to follow in an inner node
+    static std::size_t upper_bound(const K* keys, std::size_t count, const K& key) {
+        std::size_t index = 0;
+        for (std::size_t i = 0; i < count; i++) {
+            index += !(key < keys[i]);
+        }
+        return index;
+    }
+
+    const Leaf* find_leaf(const K& key) const {
+        const Node* node = root_;
+        while (!node->leaf) {
+            const Inner* inner = static_cast<const Inner*>(node);
+            node = inner->children[upper_bound(inner->keys, inner->count, key)];
+        }
+        return static_cast<const Leaf*>(node);
+    }
+
+    InsertResult insert(Node* node, const K& key, const V& value, Split& split) {
+        if (node->leaf) {
+            return insert_into_leaf(static_cast<Leaf*>(node), key, value, split);
+        }
+
+        Inner* inner = static_cast<Inner*>(node);
+        std::size_t child = upper_bound(inner->keys, inner->count, key);
+        Split child_split;
+        InsertResult result = insert(inner->children[child], key, value, child_split);
+        if (result != InsertResult::split) {
+            return result;
+        }
+
+        if (inner->count < inner_capacity) {
+            insert_child(inner, child, child_split);
+            return InsertResult::inserted;
+        }
+
+        // Full - move the upper half to a new node. The middle key moves up to the parent
+        Inner* right = new_inner();
+        std::size_t middle = inner->count / 2;
+        split.key = inner->keys[middle];
+        split.right = right;
+        right->count = inner->count - static_cast<std::uint32_t>(middle) - 1;
+        for (std::size_t i = 0; i < right->count; i++) {
+            right->keys[i] = inner->keys[middle + 1 + i];
+        }
+        for (std::size_t i = 0; i <= right->count; i++) {
+            right->children[i] = inner->children[middle + 1 + i];
+        }
+        inner->count = static_cast<std::uint32_t>(middle);
+
+        if (child <= middle) {
+            insert_child(inner, child, child_split);
+        } else {
+            insert_child(right, child - middle - 1, child_split);
+        }
+        return InsertResult::split;
+    }
+
+    // Puts the new right child after children[child]
+    static void insert_child(Inner* inner, std::size_t child, const Split& split) {
+        for (std::size_t i = inner->count; i > child; i--) {
+            inner->keys[i] = inner->keys[i - 1];
+            inner->children[i + 1] = inner->children[i];
+        }
+        inner->keys[child] = split.key;
+        inner->children[child + 1] = split.right;
+        ++inner->count;
+    }
+
+    InsertResult insert_into_leaf(Leaf* leaf, const K& key, const V& value, Split& split) {
+        std::size_t index = lower_bound(leaf->keys, leaf->count, key);
+        if (index < leaf->count && !(key < leaf->keys[index])) {
+            return InsertResult::exists;
+        }
+
+        InsertResult result = InsertResult::inserted;
+        if (leaf->count == leaf_capacity) {
+            // Full - the upper half moves to a new leaf, whose first key becomes the separator in the parent
+            Leaf* right = new_leaf();
+            std::size_t middle = leaf->count / 2;
+            right->count = leaf->count - static_cast<std::uint32_t>(middle);
+            for (std::size_t i = 0; i < right->count; i++) {
+                right->keys[i] = leaf->keys[middle + i];
+                right->values[i] = leaf->values[middle + i];
+            }
+            leaf->count = static_cast<std::uint32_t>(middle);
+            right->next = leaf->next;
+            leaf->next = right;
+            split.key = right->keys[0];
+            split.right = right;
+            result = InsertResult::split;
+
+            if (index > middle) {
+                leaf = right;
+                index -= middle;
+            }
+        }
+
+        for (std::size_t i = leaf->count; i > index; i--) {
+            leaf->keys[i] = leaf->keys[i - 1];
+            leaf->values[i] = leaf->values[i - 1];
+        }
+        leaf->keys[index] = key;
+        leaf->values[index] = value;
+        ++leaf->count;
+        if (result == InsertResult::split && leaf == split.right) {
+            split.key = leaf->keys[0]; // The new key may have become the smallest in the right leaf
+        }
+        return result;
+    }
+
+    void destroy(Node* node) {
+        if (node->leaf) {
+            delete static_cast<Leaf*>(node);
+            return;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        for (std::size_t i = 0; i <= inner->count; i++) {
+            destroy(inner->children[i]);
+        }
+        delete inner;
+    }
+
+    Node* root_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace trees
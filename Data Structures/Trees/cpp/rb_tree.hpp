@@ -0,0 +1,251 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Pointer-based red-black tree - the baseline for tree_benchmark.cpp
+//
+// Every key lives in its own heap node with pointers to its children and parent. This is the same design as
+// std::map (which is a red-black tree in every major standard library), so it has the same problem: a lookup
+// in a tree of n keys follows ~log2(n) pointers, and once the tree is bigger than the cache each one is a miss.
+//
+// Only what the benchmark needs: insert, find, range scan and bulk load. No erase.
+
+namespace trees {
+
+template <typename K, typename V>
+class RedBlackTree {
+    enum class Color : unsigned char { red, black };
+
+    struct Node {
+        K key;
+        V value;
+        Node* left = nullptr;
+        Node* right = nullptr;
+        Node* parent = nullptr;
+        Color color = Color::red;
+    };
+
+public:
+    RedBlackTree() = default;
+    ~RedBlackTree() { clear(); }
+    RedBlackTree(const RedBlackTree&) = delete;
+    RedBlackTree& operator=(const RedBlackTree&) = delete;
+
+    // Returns false (and leaves the old value) if the key already exists
+    bool insert(const K& key, const V& value) {
+        Node* parent = nullptr;
+        Node* current = root_;
+        while (current != nullptr) {
+            parent = current;
+            if (key < current->key) {
+                current = current->left;
+            } else if (current->key < key) {
+                current = current->right;
+            } else {
+                return false;
+            }
+        }
+
+        Node* node = new Node{key, value};
+        node->parent = parent;
+        if (parent == nullptr) {
+            root_ = node;
+        } else if (key < parent->key) {
+            parent->left = node;
+        } else {
+            parent->right = node;
+        }
+        ++size_;
+        fix_insert(node);
+        return true;
+    }
+
+    const V* find(const K& key) const {
+        Node* current = root_;
+        while (current != nullptr) {
+            if (key < current->key) {
+                current = current->left;
+            } else if (current->key < key) {
+                current = current->right;
+            } else {
+                return &current->value;
+            }
+        }
+        return nullptr;
+    }
+
+    // Calls visit(key, value) for up to `count` keys in order, starting at the first key >= from.
+    // Returns how many keys were visited
+    template <typename F>
+    std::size_t scan(const K& from, std::size_t count, F&& visit) const {
+        Node* node = lower_bound(from);
+        std::size_t visited = 0;
+        for (; node != nullptr && visited < count; node = successor(node), visited++) {
+            visit(node->key, node->value);
+        }
+        return visited;
+    }
+
+    // Replaces the contents with the given pairs, which must be sorted by key with no duplicates.
+    // Builds a perfectly balanced tree in O(n) instead of n inserts with rebalancing.
+    void bulk_load(const std::vector<std::pair<K, V>>& sorted) {
+        clear();
+        size_ = sorted.size();
+        // In a balanced tree of n nodes all levels but the deepest are full. Coloring the deepest level red
+        // and everything else black gives every path the same number of black nodes.
+        std::size_t red_depth = 0;
+        while ((std::size_t{2} << red_depth) - 1 < sorted.size()) {
+            ++red_depth;
+        }
+        bool perfect = (std::size_t{2} << red_depth) - 1 == sorted.size();
+        root_ = build(sorted, 0, sorted.size(), nullptr, 0, perfect ? static_cast<std::size_t>(-1) : red_depth);
+    }
+
+    void clear() {
+        // Iterative post-order delete, so a degenerate tree can't overflow the stack
+        Node* node = root_;
+        while (node != nullptr) {
+            if (node->left != nullptr) {
+                node = node->left;
+            } else if (node->right != nullptr) {
+                node = node->right;
+            } else {
+                Node* parent = node->parent;
+                if (parent != nullptr) {
+                    (parent->left == node ? parent->left : parent->right) = nullptr;
+                }
+                delete node;
+                node = parent;
+            }
+        }
+        root_ = nullptr;
+        size_ = 0;
+    }
+
+    std::size_t size() const { return size_; }
+
+private:
+    Node* build(const std::vector<std::pair<K, V>>& sorted, std::size_t first, std::size_t last,
+                Node* parent, std::size_t depth, std::size_t red_depth) {
+        if (first >= last) {
+            return nullptr;
+        }
+        std::size_t middle = first + (last - first) / 2;
+        Node* node = new Node{sorted[middle].first, sorted[middle].second};
+        node->parent = parent;
+        node->color = depth == red_depth ? Color::red : Color::black;
+        node->left = build(sorted, first, middle, node, depth + 1, red_depth);
+        node->right = build(sorted, middle + 1, last, node, depth + 1, red_depth);
+        return node;
+    }
+
+    Node* lower_bound(const K& key) const {
+        Node* current = root_;
+        Node* result = nullptr;
+        while (current != nullptr) {
+            if (current->key < key) {
+                current = current->right;
+            } else {
+                result = current;
+                current = current->left;
+            }
+        }
+        return result;
+    }
+
+    static Node* successor(Node* node) {
+        if (node->right != nullptr) {
+            node = node->right;
+            while (node->left != nullptr) {
+                node = node->left;
+            }
+            return node;
+        }
+        Node* parent = node->parent;
+        while (parent != nullptr && node == parent->right) {
+            node = parent;
+            parent = parent->parent;
+        }
+        return parent;
+    }
+
+    void rotate_left(Node* node) {
+        Node* child = node->right;
+        node->right = child->left;
+        if (child->left != nullptr) {
+            child->left->parent = node;
+        }
+        replace_child(node, child);
+        child->left = node;
+        node->parent = child;
+    }
+
+    void rotate_right(Node* node) {
+        Node* child = node->left;
+        node->left = child->right;
+        if (child->right != nullptr) {
+            child->right->parent = node;
+        }
+        replace_child(node, child);
+        child->right = node;
+        node->parent = child;
+    }
+
+    // Puts `replacement` where `node` hangs in the tree
+    void replace_child(Node* node, Node* replacement) {
+        replacement->parent = node->parent;
+        if (node->parent == nullptr) {
+            root_ = replacement;
+        } else if (node == node->parent->left) {
+            node->parent->left = replacement;
+        } else {
+            node->parent->right = replacement;
+        }
+    }
+
+    // The new node is red. The only rule it can break is "a red node has no red children", fixed by
+    // recoloring while the uncle is red and by at most two rotations otherwise (CLRS, chapter 13)
+    void fix_insert(Node* node) {
+        while (node->parent != nullptr && node->parent->color == Color::red) {
+            Node* parent = node->parent;
+            Node* grandparent = parent->parent;
+            bool parent_is_left = parent == grandparent->left;
+            Node* uncle = parent_is_left ? grandparent->right : grandparent->left;
+
+            if (uncle != nullptr && uncle->color == Color::red) {
+                parent->color = Color::black;
+                uncle->color = Color::black;
+                grandparent->color = Color::red;
+                node = grandparent;
+                continue;
+            }
+
+            if (parent_is_left) {
+                if (node == parent->right) {
+                    rotate_left(parent);
+                    node = parent;
+                    parent = node->parent;
+                }
+                rotate_right(grandparent);
+            } else {
+                if (node == parent->left) {
+                    rotate_right(parent);
+                    node = parent;
+                    parent = node->parent;
+                }
+                rotate_left(grandparent);
+            }
+            parent->color = Color::black;
+            grandparent->color = Color::red;
+            break;
+        }
+        root_->color = Color::black;
+    }
+
+    Node* root_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace trees
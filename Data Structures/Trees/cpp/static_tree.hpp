@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Static (read-only) search tree in an implicit B-ary Eytzinger layout
+//
+// Built once from sorted data (bulk load only - no inserts). There are no pointers at all: the tree is one array
+// of nodes, each node is one cache line of B sorted keys, and the children of node k are nodes k * (B + 1) + 1 ...
+// k * (B + 1) + B + 1 - the Eytzinger layout (the one used for binary heaps) generalized from 2 to B + 1 children.
+// A lookup touches one cache line per level, log_(B+1)(n) levels in total, and since the address of the next
+// node is computed rather than loaded, the CPU can start fetching it immediately.
+//
+// Inside a node the search is "count the keys smaller than x", which is B independent comparisons: with
+// AVX2/SSE2 that's a couple of vector compares and a popcount instead of a chain of unpredictable branches.
+// The SIMD path is used for int32_t keys (compile with -mavx2 to get the AVX2 one), other key types use a
+// branchless scalar loop the compiler is free to vectorize.
+//
+// The keys and values are also kept in plain sorted arrays; every tree slot stores the rank of its key in them,
+// so a lookup ends with an index into the sorted arrays, and a range scan is a walk over them.
+// Popularized by "Array Layouts for Comparison-Based Searching" (Khuong, Morin) and Algorithmica's "S-tree".
+
+namespace trees {
+
+template <typename K, typename V>
+class StaticTree {
+public:
+    static constexpr std::size_t cache_line = 64;
+    static constexpr std::size_t B = cache_line / sizeof(K); // keys per node
+    static_assert(B >= 2, "keys bigger than half a cache line don't fit this layout");
+    static_assert(std::numeric_limits<K>::is_specialized, "padding slots need std::numeric_limits<K>::max()");
+
+    StaticTree() = default;
+
+    // The pairs must be sorted by key with no duplicates
+    void bulk_load(const std::vector<std::pair<K, V>>& sorted) {
+        n_ = sorted.size();
+        keys_.resize(n_);
+        values_.resize(n_);
+        for (std::size_t i = 0; i < n_; i++) {
+            keys_[i] = sorted[i].first;
+            values_[i] = sorted[i].second;
+        }
+
+        nodes_ = (n_ + B - 1) / B;
+        tree_.reset(static_cast<K*>(std::aligned_alloc(cache_line, std::max<std::size_t>(1, nodes_) * cache_line)));
+        if (tree_ == nullptr) {
+            throw std::bad_alloc();
+        }
+        ranks_ = std::make_unique<std::uint32_t[]>(nodes_ * B);
+        next_rank_ = 0;
+        build(0);
+    }
+
+    const V* find(const K& key) const {
+        std::size_t rank = lower_bound(key);
+        if (rank < n_ && !(key < keys_[rank])) {
+            return &values_[rank];
+        }
+        return nullptr;
+    }
+
+    // Calls visit(key, value) for up to `count` keys in order, starting at the first key >= from.
+    // Returns how many keys were visited
+    template <typename F>
+    std::size_t scan(const K& from, std::size_t count, F&& visit) const {
+        std::size_t rank = lower_bound(from);
+        std::size_t visited = 0;
+        for (; rank < n_ && visited < count; rank++, visited++) {
+            visit(keys_[rank], values_[rank]);
+        }
+        return visited;
+    }
+
+    // Index of the first key >= key in the sorted arrays, n if there's none
+    std::size_t lower_bound(const K& key) const {
+        std::size_t result = n_;
+        std::size_t node = 0;
+        while (node < nodes_) {
+            const K* keys = tree_.get() + node * B;
+            std::size_t index = count_less(keys, key); // keys[index] is the first key >= key in this node
+            if (index < B) {
+                result = ranks_[node * B + index]; // Best candidate so far - every deeper one is smaller
+            }
+            node = node * (B + 1) + index + 1;
+        }
+        return result;
+    }
+
+    std::size_t size() const { return n_; }
+
+private:
+    struct Free {
+        void operator()(K* ptr) const { std::free(ptr); }
+    };
+
+    // In-order fill: for every node, the subtree left of each key gets the smaller keys first. Unused slots get
+    // the largest possible key and rank n, so a search never stops at them before a real key
+    void build(std::size_t node) {
+        if (node >= nodes_) {
+            return;
+        }
+        for (std::size_t i = 0; i < B; i++) {
+            build(node * (B + 1) + i + 1);
+            std::size_t slot = node * B + i;
+            if (next_rank_ < n_) {
+                tree_[slot] = keys_[next_rank_];
+                ranks_[slot] = static_cast<std::uint32_t>(next_rank_++);
+            } else {
+                tree_[slot] = std::numeric_limits<K>::max();
+                ranks_[slot] = static_cast<std::uint32_t>(n_);
+            }
+        }
+        build(node * (B + 1) + B + 1);
+    }
+
+    static std::size_t count_less(const K* keys, const K& key) {
+        if constexpr (std::is_same_v<K, std::int32_t>) {
+#if defined(__AVX2__)
+            __m256i x = _mm256_set1_epi32(key);
+            __m256i low = _mm256_load_si256(reinterpret_cast<const __m256i*>(keys));
+            __m256i high = _mm256_load_si256(reinterpret_cast<const __m256i*>(keys + 8));
+            // x > key[i] sets all bits of lane i. Packing the two results to 16-bit lanes keeps one movemask
+            __m256i less = _mm256_packs_epi32(_mm256_cmpgt_epi32(x, low), _mm256_cmpgt_epi32(x, high));
+            return static_cast<std::size_t>(__builtin_popcount(_mm256_movemask_epi8(less))) / 2;
+#elif defined(__SSE2__)
+            __m128i x = _mm_set1_epi32(key);
+            const __m128i* vectors = reinterpret_cast<const __m128i*>(keys);
+            __m128i a = _mm_packs_epi32(_mm_cmpgt_epi32(x, _mm_load_si128(vectors + 0)), _mm_cmpgt_epi32(x, _mm_load_si128(vectors + 1)));
+            __m128i b = _mm_packs_epi32(_mm_cmpgt_epi32(x, _mm_load_si128(vectors + 2)), _mm_cmpgt_epi32(x, _mm_load_si128(vectors + 3)));
+            __m128i less = _mm_packs_epi16(a, b); // One byte per key
+            return static_cast<std::size_t>(__builtin_popcount(_mm_movemask_epi8(less)));
+#endif
+        }
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < B; i++) {
+            count += keys[i] < key;
+        }
+        return count;
+    }
+
+    std::size_t n_ = 0;
+    std::size_t nodes_ = 0;
+    std::unique_ptr<K[], Free> tree_;
+    std::unique_ptr<std::uint32_t[]> ranks_;
+    std::size_t next_rank_ = 0; // Only used while building
+    std::vector<K> keys_;
+    std::vector<V> values_;
+};
+
+} // namespace trees
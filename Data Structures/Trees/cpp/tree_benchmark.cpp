@@ -0,0 +1,227 @@
+// Insert, bulk load, lookup and range scan throughput of the trees in this directory against std::map
+//
+// Build: g++ -std=c++20 -O2 -mavx2 tree_benchmark.cpp -o tree_benchmark (leave out -mavx2 for the SSE2 version)
+// Usage: ./tree_benchmark [max size = 10000000]
+//        sizes go from 1K up to max size in steps of 10x. Every tree holds its own copy of the data, so the
+//        largest size that fits is roughly free memory / 150 bytes
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../../cpp/testing/report.hpp"
+#include "bplus_tree.hpp"
+#include "rb_tree.hpp"
+#include "static_tree.hpp"
+
+using Key = std::int32_t;
+using Value = std::int32_t;
+using Pairs = std::vector<std::pair<Key, Value>>;
+
+// Keeps the compiler from optimizing the measured work away
+volatile std::int64_t sink;
+
+template <typename F>
+double seconds(F&& work) {
+    auto begin = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// std::map behind the same interface as the trees
+class StdMap {
+public:
+    bool insert(const Key& key, const Value& value) { return map_.emplace(key, value).second; }
+    const Value* find(const Key& key) const {
+        auto it = map_.find(key);
+        return it != map_.end() ? &it->second : nullptr;
+    }
+    template <typename F>
+    std::size_t scan(const Key& from, std::size_t count, F&& visit) const {
+        std::size_t visited = 0;
+        for (auto it = map_.lower_bound(from); it != map_.end() && visited < count; ++it, ++visited) {
+            visit(it->first, it->second);
+        }
+        return visited;
+    }
+    void bulk_load(const Pairs& sorted) {
+        map_.clear();
+        for (const auto& [key, value] : sorted) {
+            map_.emplace_hint(map_.end(), key, value); // O(1) amortized with a correct hint
+        }
+    }
+
+private:
+    std::map<Key, Value> map_;
+};
+
+struct Row {
+    std::optional<double> insert; // ns per key, random order. Not every tree supports it
+    double bulk_load;             // ns per key, sorted input
+    double lookup;                // ns per lookup of a random existing key
+    double scan;                  // ns per key visited by range scans
+
+    // What the lookups and scans found, which every tree must agree on with std::map
+    std::int64_t lookup_total = 0; // Sum of the values found by the lookups
+    std::int64_t insert_total = 0; // The same lookups on the tree built by insert, if there is one
+    std::int64_t scan_total = 0;   // Sum of the values visited by the scans
+    std::size_t visited = 0;       // Keys visited by the scans
+    std::size_t misses_found = 0;  // Lookups of keys that aren't in the tree that found something anyway
+};
+
+constexpr std::size_t lookups = 1'000'000;
+constexpr std::size_t scans = 100'000;
+constexpr std::size_t scan_length = 100;
+
+template <typename Tree>
+std::int64_t lookup_total(const Tree& tree, const std::vector<Key>& probes) {
+    std::int64_t total = 0;
+    for (Key key : probes) {
+        const Value* value = tree.find(key);
+        total += value != nullptr ? *value : 0;
+    }
+    return total;
+}
+
+template <typename Tree>
+Row measure(const Pairs& shuffled, const Pairs& sorted, const std::vector<Key>& probes) {
+    Row row{};
+    if constexpr (requires(Tree tree) { tree.insert(Key{}, Value{}); }) {
+        Tree tree;
+        row.insert = seconds([&] {
+            for (const auto& [key, value] : shuffled) {
+                tree.insert(key, value);
+            }
+        }) * 1e9 / shuffled.size();
+        row.insert_total = lookup_total(tree, probes);
+    }
+
+    Tree tree;
+    row.bulk_load = seconds([&] { tree.bulk_load(sorted); }) * 1e9 / sorted.size();
+
+    row.lookup = seconds([&] { row.lookup_total = lookup_total(tree, probes); }) * 1e9 / probes.size();
+    sink = row.lookup_total;
+
+    double scan_time = seconds([&] {
+        std::int64_t total = 0;
+        for (std::size_t i = 0; i < scans; i++) {
+            row.visited += tree.scan(probes[i % probes.size()], scan_length, [&](Key, Value value) { total += value; });
+        }
+        row.scan_total = total;
+    });
+    row.scan = scan_time * 1e9 / std::max<std::size_t>(1, row.visited);
+
+    // Keys are odd, so key + 1 is never in the tree
+    for (std::size_t i = 0; i < std::min<std::size_t>(probes.size(), 1000); i++) {
+        row.misses_found += tree.find(probes[i] + 1) != nullptr;
+    }
+    return row;
+}
+
+// Every tree's lookups and scans against std::map's, after the fact: the results come out of the timed loops
+void check(const std::string& name, std::size_t size, const Row& expected, const Row& row) {
+    auto fail = [&](const std::string& what) {
+        std::cerr << "ERROR: " << name << " with " << size << " keys: " << what << std::endl;
+        std::exit(1);
+    };
+    if (row.lookup_total != expected.lookup_total) {
+        fail("lookups found values summing to " + std::to_string(row.lookup_total) + ", std::map " +
+             std::to_string(expected.lookup_total));
+    }
+    if (row.insert && row.insert_total != expected.insert_total) {
+        fail("lookups after insert found values summing to " + std::to_string(row.insert_total) + ", std::map " +
+             std::to_string(expected.insert_total));
+    }
+    if (row.visited != expected.visited || row.scan_total != expected.scan_total) {
+        fail("scans visited " + std::to_string(row.visited) + " keys summing to " + std::to_string(row.scan_total) +
+             ", std::map " + std::to_string(expected.visited) + " summing to " + std::to_string(expected.scan_total));
+    }
+    if (row.misses_found != 0) {
+        fail(std::to_string(row.misses_found) + " lookups of missing keys found something");
+    }
+}
+
+void print(const std::string& name, std::size_t size, const Row& row) {
+    std::cout << "| " << std::setw(20) << std::left << name
+              << " | " << std::setw(11) << std::right << size
+              << std::fixed << std::setprecision(1) << " | ";
+    if (row.insert) {
+        std::cout << std::setw(11) << *row.insert;
+    } else {
+        std::cout << std::setw(11) << "-";
+    }
+    std::cout << " | " << std::setw(11) << row.bulk_load
+              << " | " << std::setw(11) << row.lookup
+              << " | " << std::setw(11) << row.scan << " |\n";
+    std::string prefix = name + ", " + std::to_string(size) + ": ";
+    if (row.insert) {
+        bench::report(prefix + "insert", *row.insert, "ns");
+    }
+    bench::report(prefix + "bulk load", row.bulk_load, "ns");
+    bench::report(prefix + "lookup", row.lookup, "ns");
+    bench::report(prefix + "scan", row.scan, "ns");
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t max_size = argc > 1 ? std::stoull(argv[1]) : 10'000'000;
+    // Keys are the odd numbers 1, 3, 5... - 2 * size - 1 has to fit in Key
+    constexpr std::size_t size_limit = (static_cast<std::size_t>(std::numeric_limits<Key>::max()) + 1) / 2;
+    if (max_size > size_limit) {
+        std::cerr << "ERROR: at most " << size_limit << " keys, " << sizeof(Key) << "-byte keys can't hold more" << std::endl;
+        return 1;
+    }
+    std::mt19937 rng(42);
+
+    std::cout << "## " << sizeof(Key) << "-byte keys and values, times in ns\n\n";
+    std::cout << "BPlusTree (4 lines): " << trees::BPlusTree<Key, Value>::inner_capacity << " keys per inner node, "
+              << trees::BPlusTree<Key, Value>::leaf_capacity << " per leaf. StaticTree: "
+              << trees::StaticTree<Key, Value>::B << " keys per node. In-node search: "
+#if defined(__AVX2__)
+              << "AVX2\n\n";
+#elif defined(__SSE2__)
+              << "SSE2\n\n";
+#else
+              << "scalar\n\n";
+#endif
+    std::cout << "| Tree                 | Size        | insert/key  | bulk/key    | lookup      | scan/key    |\n";
+    std::cout << "|----------------------|-------------|-------------|-------------|-------------|-------------|\n";
+
+    for (std::size_t size = 1000; size <= max_size; size *= 10) {
+        // Odd keys only, spread over the whole range, so lookups of even keys would miss
+        Pairs sorted(size);
+        for (std::size_t i = 0; i < size; i++) {
+            sorted[i] = {static_cast<Key>(2 * i + 1), static_cast<Value>(i)};
+        }
+        Pairs shuffled = sorted;
+        std::shuffle(shuffled.begin(), shuffled.end(), rng);
+        std::vector<Key> probes(lookups);
+        for (Key& key : probes) {
+            key = sorted[std::uniform_int_distribution<std::size_t>(0, size - 1)(rng)].first;
+        }
+
+        Row reference = measure<StdMap>(shuffled, sorted, probes);
+        check("std::map", size, reference, reference);
+        print("std::map", size, reference);
+        auto run = [&]<typename Tree>(const std::string& name) {
+            Row row = measure<Tree>(shuffled, sorted, probes);
+            check(name, size, reference, row);
+            print(name, size, row);
+        };
+        run.operator()<trees::RedBlackTree<Key, Value>>("RedBlackTree");
+        run.operator()<trees::BPlusTree<Key, Value, trees::cache_line>>("BPlusTree (1 line)");
+        run.operator()<trees::BPlusTree<Key, Value>>("BPlusTree (4 lines)");
+        run.operator()<trees::StaticTree<Key, Value>>("StaticTree");
+    }
+    std::cout << "\nLookups are " << lookups << " random existing keys, scans are " << scans << " range scans of "
+              << scan_length << " keys from a random key" << std::endl;
+}
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "image.hpp"
+
+// The three stages of an edge-detection pipeline, each in three versions
+//   * grayscale - RGB to 8-bit luma, (77 R + 150 G + 29 B) / 256 - BT.601 weights in fixed point, like cv::cvtColor
+//   * blur      - 5x5 Gaussian blur, weights [1 4 6 4 1] x [1 4 6 4 1] / 256, like cv::GaussianBlur(5x5, sigma 0)
+//   * sobel     - gradient magnitude approximated as (|gx| + |gy|) / 8, from the 3x3 Sobel x and y derivatives
+//                 (cv::Sobel computes one of those per call, and leaves the magnitude to the caller)
+// Borders replicate the edge pixel. All versions produce exactly the same bytes - integer math, same rounding.
+//
+// naive::    - the textbook loops: for every output pixel, every input pixel under the kernel, clamped into
+//              the image. The reference the others are checked against
+// blocked::  - what makes it fast on one core:
+//                1. separable kernels: a 5x5 Gaussian is a 5-tap horizontal pass followed by a 5-tap vertical
+//                   one, 10 multiply-adds per pixel instead of 25; a 3x3 Sobel is 3 + 3 instead of 9 (x2)
+//                2. line buffers: the horizontal pass only keeps the last 5 (or 3) rows, in a ring, not a whole
+//                   intermediate image, so the vertical pass reads them from the cache instead of memory
+//                3. column strips: the image is processed in strips of strip_width columns, top to bottom, so
+//                   the line buffers stay inside the L2 cache however wide the image is
+//                4. vectorizable inner loops: the border pixels are handled separately, leaving the middle of
+//                   every row as a plain loop over contiguous memory with no branches and no clamping - the
+//                   compiler turns it into SIMD instructions (check with -fopt-info-vec)
+// threaded:: - the blocked version on horizontal bands of rows, one per thread. Bands are independent: a band
+//              reads the input rows above and below it, but only writes its own
+
+namespace vision {
+
+// Columns per strip. The fused pipeline's line buffers take about 22 bytes per column: 4096 columns is 90 KiB,
+// inside any L2 cache, so a 4K UHD frame (3840 wide) is done in one strip. Strips narrow enough for L1 (about
+// 1500 columns for 32 KiB) sound better but measure worse: every row kernel is a call, and the shorter the rows,
+// the more of the time goes to calls and loop edges instead of full vectors. pipeline_benchmark prints the effect
+inline constexpr int default_strip_width = 4096;
+
+// GCC only vectorizes loops at -O2 when that needs no extra code for the leftover elements ("very cheap" cost
+// model) - these loops do, so the row kernels ask for the full vectorizer themselves, like simd/kernels_generic.hpp.
+// target_clones compiles every kernel three times - for AVX2, SSSE3 and plain x86-64 - and picks one when the
+// program starts, from what the CPU supports (the same idea as simd::kernels<T>(), done by the compiler). Besides
+// 2x wider registers it matters for grayscale: picking R, G and B out of RGBRGB... needs byte shuffles, which
+// SSE2 doesn't have, so without SSSE3 that loop isn't vectorized at all. ThreadSanitizer crashes on the resolver
+// that picks the clone, which runs before the sanitizer is set up - -fsanitize=thread builds go without
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__) && !defined(__SANITIZE_THREAD__)
+#define VISION_VECTORIZE \
+    __attribute__((target_clones("avx2", "ssse3", "default"), optimize("tree-vectorize", "vect-cost-model=dynamic")))
+#elif defined(__GNUC__) && !defined(__clang__)
+#define VISION_VECTORIZE __attribute__((optimize("tree-vectorize", "vect-cost-model=dynamic")))
+#else
+#define VISION_VECTORIZE
+#endif
+
+// ## Row kernels
+// One row of one pass, for the output columns [x0, x1). Every kernel splits the columns into the border, where
+// reads are clamped, and the interior, a branch-free loop for the vectorizer. __restrict promises the compiler the
+// rows don't overlap, otherwise it would have to check at runtime before using vector instructions
+namespace rows {
+
+VISION_VECTORIZE inline void grayscale(const std::uint8_t* __restrict rgb, std::uint8_t* __restrict gray, int x0, int x1) {
+    for (int x = x0; x < x1; x++) {
+        gray[x] = static_cast<std::uint8_t>((77 * rgb[3 * x] + 150 * rgb[3 * x + 1] + 29 * rgb[3 * x + 2] + 128) >> 8);
+    }
+}
+
+// Horizontal [1 4 6 4 1], unnormalized - at most 16 * 255, so it fits 16 bits
+VISION_VECTORIZE inline void blur_horizontal(const std::uint8_t* __restrict src, std::uint16_t* __restrict dst, int x0, int x1, int width) {
+    auto border = [&](int x) {
+        dst[x] = static_cast<std::uint16_t>(src[clamp(x - 2, width)] + 4 * src[clamp(x - 1, width)] + 6 * src[x] +
+                                            4 * src[clamp(x + 1, width)] + src[clamp(x + 2, width)]);
+    };
+    int inner0 = std::max(x0, 2);
+    int inner1 = std::min(x1, width - 2);
+    for (int x = x0; x < std::min(x1, inner0); x++) {
+        border(x);
+    }
+    for (int x = inner0; x < inner1; x++) {
+        dst[x] = static_cast<std::uint16_t>(src[x - 2] + 4 * (src[x - 1] + src[x + 1]) + 6 * src[x] + src[x + 2]);
+    }
+    for (int x = std::max(x0, inner1); x < x1; x++) {
+        border(x);
+    }
+}
+
+// Vertical [1 4 6 4 1] over 5 horizontally blurred rows, then / 256 rounded. The largest sum is 256 * 255 + 128,
+// still 16 bits
+VISION_VECTORIZE inline void blur_vertical(const std::uint16_t* __restrict r0, const std::uint16_t* __restrict r1,
+                          const std::uint16_t* __restrict r2, const std::uint16_t* __restrict r3,
+                          const std::uint16_t* __restrict r4, std::uint8_t* __restrict dst, int x0, int x1) {
+    for (int x = x0; x < x1; x++) {
+        dst[x] = static_cast<std::uint8_t>((r0[x] + 4 * (r1[x] + r3[x]) + 6 * r2[x] + r4[x] + 128) >> 8);
+    }
+}
+
+// Sobel is separable too: gx = [1 2 1]^T x [-1 0 1] and gy = [-1 0 1]^T x [1 2 1]. The horizontal pass makes
+// both the difference d = right - left and the smoothed s = left + 2 center + right
+VISION_VECTORIZE inline void sobel_horizontal(const std::uint8_t* __restrict src, std::int16_t* __restrict d, std::int16_t* __restrict s,
+                             int x0, int x1, int width) {
+    auto border = [&](int x) {
+        int left = src[clamp(x - 1, width)];
+        int right = src[clamp(x + 1, width)];
+        d[x] = static_cast<std::int16_t>(right - left);
+        s[x] = static_cast<std::int16_t>(left + 2 * src[x] + right);
+    };
+    int inner0 = std::max(x0, 1);
+    int inner1 = std::min(x1, width - 1);
+    for (int x = x0; x < std::min(x1, inner0); x++) {
+        border(x);
+    }
+    for (int x = inner0; x < inner1; x++) {
+        d[x] = static_cast<std::int16_t>(src[x + 1] - src[x - 1]);
+        s[x] = static_cast<std::int16_t>(src[x - 1] + 2 * src[x] + src[x + 1]);
+    }
+    for (int x = std::max(x0, inner1); x < x1; x++) {
+        border(x);
+    }
+}
+
+// |gx| + |gy| is at most 2 * 4 * 255, so / 8 maps it onto 0-255 exactly
+VISION_VECTORIZE inline void sobel_vertical(const std::int16_t* __restrict d0, const std::int16_t* __restrict d1,
+                           const std::int16_t* __restrict d2, const std::int16_t* __restrict s0,
+                           const std::int16_t* __restrict s2, std::uint8_t* __restrict dst, int x0, int x1) {
+    for (int x = x0; x < x1; x++) {
+        int gx = d0[x] + 2 * d1[x] + d2[x];
+        int gy = s2[x] - s0[x];
+        dst[x] = static_cast<std::uint8_t>((std::abs(gx) + std::abs(gy)) >> 3);
+    }
+}
+
+} // namespace rows
+
+// ## Line buffer
+// The last N rows an intermediate pass produced, in a ring. row(y, compute) returns row y, calling compute(y, row)
+// to fill it first if it isn't there. Rows are requested top to bottom, at most N consecutive ones at a time, so
+// every row is computed once per strip. Each row is a full image row, but only the current strip's columns are
+// ever touched - that's what stays in the cache
+template <typename T, int N>
+class LineBuffer {
+public:
+    explicit LineBuffer(int width) : stride_(static_cast<std::size_t>(width) + cache_line), data_(N * stride_) {
+        clear();
+    }
+
+    void clear() { std::fill(tags_, tags_ + N, -1); }
+
+    template <typename F>
+    T* row(int y, F&& compute) {
+        int slot = y % N;
+        T* data = data_.data() + slot * stride_;
+        if (tags_[slot] != y) {
+            compute(y, data);
+            tags_[slot] = y;
+        }
+        return data;
+    }
+
+private:
+    std::size_t stride_;
+    std::vector<T> data_;
+    int tags_[N];
+};
+
+// ## Naive
+namespace naive {
+
+inline void grayscale(const Image<std::uint8_t>& rgb, Image<std::uint8_t>& gray) {
+    for (int y = 0; y < rgb.height(); y++) {
+        for (int x = 0; x < rgb.width(); x++) {
+            gray.at(x, y) = static_cast<std::uint8_t>((77 * rgb.at(x, y, 0) + 150 * rgb.at(x, y, 1) + 29 * rgb.at(x, y, 2) + 128) >> 8);
+        }
+    }
+}
+
+inline void blur(const Image<std::uint8_t>& in, Image<std::uint8_t>& out) {
+    constexpr int weights[5] = {1, 4, 6, 4, 1};
+    for (int y = 0; y < in.height(); y++) {
+        for (int x = 0; x < in.width(); x++) {
+            int sum = 0;
+            for (int ky = 0; ky < 5; ky++) {
+                for (int kx = 0; kx < 5; kx++) {
+                    sum += weights[ky] * weights[kx] * in.at(clamp(x + kx - 2, in.width()), clamp(y + ky - 2, in.height()));
+                }
+            }
+            out.at(x, y) = static_cast<std::uint8_t>((sum + 128) >> 8);
+        }
+    }
+}
+
+inline void sobel(const Image<std::uint8_t>& in, Image<std::uint8_t>& out) {
+    constexpr int kernel_x[3][3] = {{-1, 0, 1}, {-2, 0, 2}, {-1, 0, 1}};
+    constexpr int kernel_y[3][3] = {{-1, -2, -1}, {0, 0, 0}, {1, 2, 1}};
+    for (int y = 0; y < in.height(); y++) {
+        for (int x = 0; x < in.width(); x++) {
+            int gx = 0;
+            int gy = 0;
+            for (int ky = 0; ky < 3; ky++) {
+                for (int kx = 0; kx < 3; kx++) {
+                    int pixel = in.at(clamp(x + kx - 1, in.width()), clamp(y + ky - 1, in.height()));
+                    gx += kernel_x[ky][kx] * pixel;
+                    gy += kernel_y[ky][kx] * pixel;
+                }
+            }
+            out.at(x, y) = static_cast<std::uint8_t>((std::abs(gx) + std::abs(gy)) >> 3);
+        }
+    }
+}
+
+} // namespace naive
+
+// ## Blocked
+// The *_band functions compute the output rows [y0, y1) - a whole image, or one thread's share of it
+namespace blocked {
+
+inline void grayscale_band(const Image<std::uint8_t>& rgb, Image<std::uint8_t>& gray, int y0, int y1) {
+    for (int y = y0; y < y1; y++) {
+        rows::grayscale(rgb.row(y), gray.row(y), 0, rgb.width());
+    }
+}
+
+inline void blur_band(const Image<std::uint8_t>& in, Image<std::uint8_t>& out, int y0, int y1,
+                      int strip_width = default_strip_width) {
+    int width = in.width();
+    int height = in.height();
+    LineBuffer<std::uint16_t, 5> horizontal(width);
+    for (int x0 = 0; x0 < width; x0 += strip_width) {
+        int x1 = std::min(x0 + strip_width, width);
+        horizontal.clear();
+        auto blur_row = [&](int y, std::uint16_t* row) { rows::blur_horizontal(in.row(y), row, x0, x1, width); };
+        for (int y = y0; y < y1; y++) {
+            const std::uint16_t* r[5];
+            for (int k = 0; k < 5; k++) {
+                r[k] = horizontal.row(clamp(y + k - 2, height), blur_row);
+            }
+            rows::blur_vertical(r[0], r[1], r[2], r[3], r[4], out.row(y), x0, x1);
+        }
+    }
+}
+
+inline void sobel_band(const Image<std::uint8_t>& in, Image<std::uint8_t>& out, int y0, int y1,
+                       int strip_width = default_strip_width) {
+    int width = in.width();
+    int height = in.height();
+    std::size_t half = static_cast<std::size_t>(width) + cache_line;
+    LineBuffer<std::int16_t, 3> horizontal(2 * static_cast<int>(half)); // d in the first half of a row, s in the second
+    for (int x0 = 0; x0 < width; x0 += strip_width) {
+        int x1 = std::min(x0 + strip_width, width);
+        horizontal.clear();
+        auto sobel_row = [&](int y, std::int16_t* row) { rows::sobel_horizontal(in.row(y), row, row + half, x0, x1, width); };
+        for (int y = y0; y < y1; y++) {
+            const std::int16_t* above = horizontal.row(clamp(y - 1, height), sobel_row);
+            const std::int16_t* center = horizontal.row(y, sobel_row);
+            const std::int16_t* below = horizontal.row(clamp(y + 1, height), sobel_row);
+            rows::sobel_vertical(above, center, below, above + half, below + half, out.row(y), x0, x1);
+        }
+    }
+}
+
+inline void grayscale(const Image<std::uint8_t>& rgb, Image<std::uint8_t>& gray) {
+    grayscale_band(rgb, gray, 0, rgb.height());
+}
+
+inline void blur(const Image<std::uint8_t>& in, Image<std::uint8_t>& out, int strip_width = default_strip_width) {
+    blur_band(in, out, 0, in.height(), strip_width);
+}
+
+inline void sobel(const Image<std::uint8_t>& in, Image<std::uint8_t>& out, int strip_width = default_strip_width) {
+    sobel_band(in, out, 0, in.height(), strip_width);
+}
+
+} // namespace blocked
+
+// ## Threaded
+// Calls band(y0, y1) for `threads` equal bands of [0, height), one per thread, the first on the calling thread.
+// Threads are started per call: about 20 us each, against the milliseconds a 4K frame takes
+template <typename F>
+void parallel_bands(int height, unsigned threads, F&& band) {
+    threads = std::clamp(threads, 1u, static_cast<unsigned>(std::max(height, 1)));
+    auto begin = [&](unsigned t) { return static_cast<int>(static_cast<long long>(height) * t / threads); };
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; t++) {
+        workers.emplace_back([&, t] { band(begin(t), begin(t + 1)); });
+    }
+    band(0, begin(1));
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+namespace threaded {
+
+inline void grayscale(const Image<std::uint8_t>& rgb, Image<std::uint8_t>& gray, unsigned threads) {
+    parallel_bands(rgb.height(), threads, [&](int y0, int y1) { blocked::grayscale_band(rgb, gray, y0, y1); });
+}
+
+inline void blur(const Image<std::uint8_t>& in, Image<std::uint8_t>& out, unsigned threads) {
+    parallel_bands(in.height(), threads, [&](int y0, int y1) { blocked::blur_band(in, out, y0, y1); });
+}
+
+inline void sobel(const Image<std::uint8_t>& in, Image<std::uint8_t>& out, unsigned threads) {
+    parallel_bands(in.height(), threads, [&](int y0, int y1) { blocked::sobel_band(in, out, y0, y1); });
+}
+
+} // namespace threaded
+
+} // namespace vision
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+// Minimal image container for the pipeline in filters.hpp and pipeline.hpp - the part of cv::Mat they need
+//
+// Pixels are stored row after row, channels interleaved (RGB RGB RGB ...), like cv::Mat. Every row starts on a
+// cache line: the row length is padded to a multiple of 64 bytes (the "stride", OpenCV's "step"), so a row never
+// shares a cache line with the previous one and vector loads at the start of a row are aligned.
+
+namespace vision {
+
+inline constexpr std::size_t cache_line = 64;
+
+template <typename T>
+class Image {
+public:
+    Image() = default;
+    Image(int width, int height, int channels = 1)
+        : width_(width),
+          height_(height),
+          channels_(channels),
+          stride_(round_up(static_cast<std::size_t>(width) * channels * sizeof(T), cache_line) / sizeof(T)),
+          data_(static_cast<T*>(::operator new(stride_ * height * sizeof(T), std::align_val_t(cache_line)))) {
+        std::fill_n(data_.get(), stride_ * height, T{});
+    }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int channels() const { return channels_; }
+    std::size_t stride() const { return stride_; } // Elements from one row to the next
+
+    T* row(int y) { return data_.get() + y * stride_; }
+    const T* row(int y) const { return data_.get() + y * stride_; }
+    T& at(int x, int y, int channel = 0) { return row(y)[x * channels_ + channel]; }
+    const T& at(int x, int y, int channel = 0) const { return row(y)[x * channels_ + channel]; }
+
+    // Same size and the same pixels; the row padding isn't compared
+    bool operator==(const Image& other) const {
+        if (width_ != other.width_ || height_ != other.height_ || channels_ != other.channels_) {
+            return false;
+        }
+        for (int y = 0; y < height_; y++) {
+            if (!std::equal(row(y), row(y) + width_ * channels_, other.row(y))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct AlignedDelete {
+        void operator()(T* ptr) const { ::operator delete(ptr, std::align_val_t(cache_line)); }
+    };
+
+    static std::size_t round_up(std::size_t size, std::size_t alignment) {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    int width_ = 0;
+    int height_ = 0;
+    int channels_ = 0;
+    std::size_t stride_ = 0;
+    std::unique_ptr<T, AlignedDelete> data_;
+};
+
+// Reading outside the image returns the nearest edge pixel ("replicate" border, cv::BORDER_REPLICATE)
+inline int clamp(int value, int size) {
+    return std::clamp(value, 0, size - 1);
+}
+
+} // namespace vision
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "filters.hpp"
+#include "image.hpp"
+
+// Edge detection: RGB frame -> grayscale -> 5x5 Gaussian blur -> Sobel magnitude
+//
+// Run one stage after another (naive::edges, blocked::edges, threaded::edges) and the pipeline writes a full
+// grayscale frame, reads it back to blur it, writes the blurred frame and reads it back again for Sobel. A 4K
+// grayscale frame is 8 MB - bigger than most L2 caches and many L3 slices - so each of those trips goes to
+// main memory, and for simple filters the memory traffic, not the arithmetic, sets the frame rate.
+//
+// fused::edges runs all three stages in one pass. The grayscale and blurred rows only ever exist in line
+// buffers (filters.hpp): to produce output row y, Sobel needs the blurred rows y-1..y+1, which need the
+// horizontally blurred rows y-3..y+3, which are computed from the grayscale rows, which are computed from the
+// RGB rows. Those rows are made on demand, each once, and all of them fit in the L2 cache. Main memory only sees
+// the RGB frame going in and the edge frame coming out.
+//
+// Images wider than a strip (default_strip_width) pay for a little recomputation at the strip edges: Sobel
+// needs 1 blurred column to each side of the strip, the blur 2 more grayscale columns - 6 extra columns per strip.
+
+namespace vision {
+
+// The intermediate frames the unfused versions need
+struct Scratch {
+    Scratch(int width, int height) : gray(width, height), blurred(width, height) {}
+    Image<std::uint8_t> gray;
+    Image<std::uint8_t> blurred;
+};
+
+namespace naive {
+
+inline void edges(const Image<std::uint8_t>& rgb, Image<std::uint8_t>& out, Scratch& scratch) {
+    grayscale(rgb, scratch.gray);
+    blur(scratch.gray, scratch.blurred);
+    sobel(scratch.blurred, out);
+}
+
+} // namespace naive
+
+namespace blocked {
+
+inline void edges(const Image<std::uint8_t>& rgb, Image<std::uint8_t>& out, Scratch& scratch) {
+    grayscale(rgb, scratch.gray);
+    blur(scratch.gray, scratch.blurred);
+    sobel(scratch.blurred, out);
+}
+
+} // namespace blocked
+
+namespace threaded {
+
+inline void edges(const Image<std::uint8_t>& rgb, Image<std::uint8_t>& out, Scratch& scratch, unsigned threads) {
+    grayscale(rgb, scratch.gray, threads);
+    blur(scratch.gray, scratch.blurred, threads);
+    sobel(scratch.blurred, out, threads);
+}
+
+} // namespace threaded
+
+namespace fused {
+
+inline void edges_band(const Image<std::uint8_t>& rgb, Image<std::uint8_t>& out, int y0, int y1,
+                       int strip_width = default_strip_width) {
+    int width = rgb.width();
+    int height = rgb.height();
+    std::size_t half = static_cast<std::size_t>(width) + cache_line;
+    std::vector<std::uint8_t> gray(width);
+    std::vector<std::uint8_t> blurred(width);
+    LineBuffer<std::uint16_t, 5> blur_rows(width);
+    LineBuffer<std::int16_t, 3> sobel_rows(2 * static_cast<int>(half)); // d, then s - as in blocked::sobel_band
+
+    for (int x0 = 0; x0 < width; x0 += strip_width) {
+        int x1 = std::min(x0 + strip_width, width);
+        // The columns each stage has to produce for this strip
+        int blur_x0 = std::max(x0 - 1, 0);
+        int blur_x1 = std::min(x1 + 1, width);
+        int gray_x0 = std::max(blur_x0 - 2, 0);
+        int gray_x1 = std::min(blur_x1 + 2, width);
+        blur_rows.clear();
+        sobel_rows.clear();
+
+        auto blur_row = [&](int y, std::uint16_t* row) {
+            rows::grayscale(rgb.row(y), gray.data(), gray_x0, gray_x1);
+            rows::blur_horizontal(gray.data(), row, blur_x0, blur_x1, width);
+        };
+        auto sobel_row = [&](int y, std::int16_t* row) {
+            const std::uint16_t* r[5];
+            for (int k = 0; k < 5; k++) {
+                r[k] = blur_rows.row(clamp(y + k - 2, height), blur_row);
+            }
+            rows::blur_vertical(r[0], r[1], r[2], r[3], r[4], blurred.data(), blur_x0, blur_x1);
+            rows::sobel_horizontal(blurred.data(), row, row + half, x0, x1, width);
+        };
+        for (int y = y0; y < y1; y++) {
+            const std::int16_t* above = sobel_rows.row(clamp(y - 1, height), sobel_row);
+            const std::int16_t* center = sobel_rows.row(y, sobel_row);
+            const std::int16_t* below = sobel_rows.row(clamp(y + 1, height), sobel_row);
+            rows::sobel_vertical(above, center, below, above + half, below + half, out.row(y), x0, x1);
+        }
+    }
+}
+
+// A band only needs the RGB rows around it, so threads split the frame exactly like the single stages do
+inline void edges(const Image<std::uint8_t>& rgb, Image<std::uint8_t>& out, unsigned threads = 1) {
+    parallel_bands(rgb.height(), threads, [&](int y0, int y1) { edges_band(rgb, out, y0, y1); });
+}
+
+} // namespace fused
+
+} // namespace vision
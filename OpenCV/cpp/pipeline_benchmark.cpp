@@ -0,0 +1,178 @@
+// Frames per second of the edge-detection pipeline from pipeline.hpp: every stage in its naive, blocked and
+// threaded version, then the whole pipeline run stage by stage vs fused. The frames are synthetic (shapes,
+// gradients and noise), so no camera, video file or GPU is needed.
+//
+// Build: g++ -std=c++20 -O2 -pthread pipeline_benchmark.cpp -o pipeline_benchmark
+// Usage: ./pipeline_benchmark [width = 3840] [height = 2160] [threads = hardware threads]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "../../cpp/testing/report.hpp"
+#include "filters.hpp"
+#include "image.hpp"
+#include "pipeline.hpp"
+
+using vision::Image;
+
+// A frame with something for the edge detector to find: a diagonal color gradient, filled circles and
+// rectangles with hard edges, and a little noise so the blur has work to do
+Image<std::uint8_t> make_frame(int width, int height) {
+    Image<std::uint8_t> frame(width, height, 3);
+    std::uint32_t noise = 12345;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            noise = noise * 1664525 + 1013904223; // Linear congruential generator, plenty for noise
+            int grain = static_cast<int>(noise >> 28) - 8;
+            int r = 255 * x / width;
+            int g = 255 * y / height;
+            int b = 128;
+            int cx = x % 256 - 128;
+            int cy = y % 256 - 128;
+            if (cx * cx + cy * cy < 80 * 80) {
+                r = 255 - r;
+                b = 32;
+            } else if ((x / 64 + y / 64) % 7 == 0) {
+                g = 255 - g;
+                b = 224;
+            }
+            frame.at(x, y, 0) = static_cast<std::uint8_t>(std::clamp(r + grain, 0, 255));
+            frame.at(x, y, 1) = static_cast<std::uint8_t>(std::clamp(g + grain, 0, 255));
+            frame.at(x, y, 2) = static_cast<std::uint8_t>(std::clamp(b + grain, 0, 255));
+        }
+    }
+    return frame;
+}
+
+template <typename F>
+double seconds(F&& work) {
+    auto begin = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// Milliseconds per frame: one frame to warm up, then frames until a second has passed (at least 3)
+template <typename F>
+double ms_per_frame(F&& process) {
+    process();
+    int frames = 0;
+    double total = 0;
+    while (frames < 3 || total < 1.0) {
+        total += seconds(process);
+        frames++;
+    }
+    return total * 1000 / frames;
+}
+
+void check(const Image<std::uint8_t>& expected, const Image<std::uint8_t>& actual, const std::string& what) {
+    if (!(expected == actual)) {
+        std::cerr << "ERROR: " << what << " differs from the naive version" << std::endl;
+        std::exit(1);
+    }
+}
+
+// Every version against the naive one, on a frame with an odd size and with strips narrower than the kernels'
+// reach, so the border and strip-edge code is exercised too
+void verify(unsigned threads) {
+    constexpr int width = 203;
+    constexpr int height = 77;
+    Image<std::uint8_t> rgb = make_frame(width, height);
+    Image<std::uint8_t> gray(width, height);
+    Image<std::uint8_t> blurred(width, height);
+    Image<std::uint8_t> edges(width, height);
+    vision::naive::grayscale(rgb, gray);
+    vision::naive::blur(gray, blurred);
+    vision::naive::sobel(blurred, edges);
+
+    Image<std::uint8_t> out(width, height);
+    vision::blocked::grayscale(rgb, out);
+    check(gray, out, "blocked::grayscale");
+    vision::threaded::grayscale(rgb, out, threads + 2);
+    check(gray, out, "threaded::grayscale");
+    for (int strip : {1, 3, 64, width}) {
+        vision::blocked::blur(gray, out, strip);
+        check(blurred, out, "blocked::blur, strip " + std::to_string(strip));
+        vision::blocked::sobel(blurred, out, strip);
+        check(edges, out, "blocked::sobel, strip " + std::to_string(strip));
+        vision::fused::edges_band(rgb, out, 0, height, strip);
+        check(edges, out, "fused::edges, strip " + std::to_string(strip));
+    }
+    vision::threaded::blur(gray, out, threads + 2);
+    check(blurred, out, "threaded::blur");
+    vision::threaded::sobel(blurred, out, threads + 2);
+    check(edges, out, "threaded::sobel");
+    vision::fused::edges(rgb, out, threads + 2);
+    check(edges, out, "threaded fused::edges");
+}
+
+// `table` tells the rows of the three tables apart in the JSON, where they have no heading
+void print_row(const std::string& table, const std::string& name, double ms, unsigned threads) {
+    double fps = 1000 / ms;
+    std::cout << "| " << std::setw(34) << std::left << name << std::right << " | " << std::setw(7) << threads
+              << std::fixed << std::setprecision(2) << " | " << std::setw(10) << ms << " | " << std::setw(8) << fps
+              << " | " << std::setw(13) << fps / threads << " |\n";
+    bench::report(table + ": " + name, fps, "FPS");
+}
+
+int main(int argc, char* argv[]) {
+    int width = argc > 1 ? std::stoi(argv[1]) : 3840;
+    int height = argc > 2 ? std::stoi(argv[2]) : 2160;
+    unsigned threads = argc > 3 ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+
+    verify(threads);
+
+    Image<std::uint8_t> rgb = make_frame(width, height);
+    Image<std::uint8_t> edges(width, height);
+    Image<std::uint8_t> out(width, height);
+    vision::Scratch scratch(width, height);
+    vision::Scratch reference(width, height);
+    vision::naive::edges(rgb, edges, reference);
+
+    std::cout << "## " << width << "x" << height << " frames, " << threads << " threads\n\n";
+    std::cout << "| Stage / version                    | Threads | ms/frame   | FPS      | FPS per core  |\n";
+    std::cout << "|------------------------------------|---------|------------|----------|---------------|\n";
+    print_row("Stage", "grayscale naive", ms_per_frame([&] { vision::naive::grayscale(rgb, scratch.gray); }), 1);
+    print_row("Stage", "grayscale blocked", ms_per_frame([&] { vision::blocked::grayscale(rgb, scratch.gray); }), 1);
+    print_row("Stage", "grayscale threaded",
+              ms_per_frame([&] { vision::threaded::grayscale(rgb, scratch.gray, threads); }), threads);
+    print_row("Stage", "blur naive", ms_per_frame([&] { vision::naive::blur(reference.gray, scratch.blurred); }), 1);
+    print_row("Stage", "blur blocked", ms_per_frame([&] { vision::blocked::blur(reference.gray, scratch.blurred); }), 1);
+    print_row("Stage", "blur threaded",
+              ms_per_frame([&] { vision::threaded::blur(reference.gray, scratch.blurred, threads); }), threads);
+    print_row("Stage", "sobel naive", ms_per_frame([&] { vision::naive::sobel(reference.blurred, out); }), 1);
+    print_row("Stage", "sobel blocked", ms_per_frame([&] { vision::blocked::sobel(reference.blurred, out); }), 1);
+    print_row("Stage", "sobel threaded",
+              ms_per_frame([&] { vision::threaded::sobel(reference.blurred, out, threads); }), threads);
+
+    std::cout << "\n## Whole pipeline: grayscale -> blur -> sobel\n\n";
+    std::cout << "| Pipeline                           | Threads | ms/frame   | FPS      | FPS per core  |\n";
+    std::cout << "|------------------------------------|---------|------------|----------|---------------|\n";
+    print_row("Pipeline", "naive, stage by stage", ms_per_frame([&] { vision::naive::edges(rgb, out, scratch); }), 1);
+    check(edges, out, "naive::edges");
+    print_row("Pipeline", "blocked, stage by stage", ms_per_frame([&] { vision::blocked::edges(rgb, out, scratch); }), 1);
+    check(edges, out, "blocked::edges");
+    print_row("Pipeline", "threaded, stage by stage",
+              ms_per_frame([&] { vision::threaded::edges(rgb, out, scratch, threads); }), threads);
+    check(edges, out, "threaded::edges");
+    print_row("Pipeline", "fused", ms_per_frame([&] { vision::fused::edges(rgb, out); }), 1);
+    check(edges, out, "fused::edges");
+    print_row("Pipeline", "fused, threaded", ms_per_frame([&] { vision::fused::edges(rgb, out, threads); }), threads);
+    check(edges, out, "threaded fused::edges");
+
+    std::cout << "\n## Fused pipeline by strip width, 1 thread\n\n";
+    std::cout << "| Strip width                        | Threads | ms/frame   | FPS      | FPS per core  |\n";
+    std::cout << "|------------------------------------|---------|------------|----------|---------------|\n";
+    for (int strip : {256, 1024, 2048, width}) {
+        std::string name = strip == width ? "whole rows (" + std::to_string(width) + ")" : std::to_string(strip);
+        print_row("Fused by strip width", name,
+                  ms_per_frame([&] { vision::fused::edges_band(rgb, out, 0, height, strip); }), 1);
+        check(edges, out, "fused::edges, strip " + std::to_string(strip));
+    }
+    std::cout << "\nFPS per core: FPS / threads - what one core of a vision box delivers" << std::endl;
+}
@@ -0,0 +1,34 @@
+// Benchmark target example: times building the greeting with bench.hpp (cpp/testing). Registered with
+// add_benchmark() in CMakeLists.txt, which also makes it a ctest test - it fails if a greeting comes out wrong
+
+#include <iostream>
+#include <string>
+
+#include "bench.hpp"
+
+std::string greet_concat(const std::string& name) {
+    return "Hello " + name + "!";
+}
+
+std::string greet_append(const std::string& name) {
+    std::string greeting;
+    greeting.reserve(6 + name.size() + 1);
+    greeting.append("Hello ").append(name).append("!");
+    return greeting;
+}
+
+int main(int argc, char* argv[]) {
+    std::string name = "World";
+    for (const std::string& greeting : {greet_concat(name), greet_append(name)}) {
+        if (greeting != "Hello World!") {
+            std::cerr << "ERROR: greeting is \"" << greeting << "\"" << std::endl;
+            return 1;
+        }
+    }
+
+    bench::Runner runner(argc, argv);
+    runner.run("greeting/operator+", [&] { bench::do_not_optimize(greet_concat(name)); });
+    runner.run("greeting/append", [&] { bench::do_not_optimize(greet_append(name)); });
+
+    return runner.finish();
+}
@@ -0,0 +1,271 @@
+// Branchy vs branchless code, on data the branch predictor can learn (sorted) and data it can't (random):
+// filtering, clamping and binary search with plain `if`s vs the primitives from branchless.hpp, then the three
+// dispatch loops of the bytecode interpreter in interpreter.hpp. Next to the times it reports mispredicted
+// branches per element from the hardware counters (perf_counters.hpp), which is what the difference comes from.
+//
+// Build: g++ -std=c++20 -O2 branch_benchmark.cpp -o branch_benchmark
+// Usage: ./branch_benchmark [elements = 1000000] [collatz numbers = 100000]
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../testing/measure.hpp"
+#include "../../testing/perf_counters.hpp"
+#include "../../testing/report.hpp"
+#include "branchless.hpp"
+#include "interpreter.hpp"
+
+using bench::fail;
+using bench::format;
+using bench::measure;
+using bench::Measurement;
+using bench::PerfCounters;
+
+// ## Kernels
+// The branchy versions are written the way anyone would write them. GCC keeps the filter's and the binary search's
+// branches - it can't make a store conditional, and std::lower_bound's loop exits early - but it turns the clamp's
+// two ifs into conditional moves by itself, so that pair shows what the compiler already does for free
+
+std::size_t filter_branchy(const std::vector<int>& in, std::vector<int>& out, int threshold) {
+    std::size_t count = 0;
+    for (int v : in) {
+        if (v < threshold) {
+            out[count++] = v;
+        }
+    }
+    return count;
+}
+
+std::size_t filter_branchless(const std::vector<int>& in, std::vector<int>& out, int threshold) {
+    return branchless::compact(in.data(), in.size(), out.data(), [threshold](int v) { return v < threshold; });
+}
+
+void clamp_branchy(const std::vector<int>& in, std::vector<int>& out, int low, int high) {
+    for (std::size_t i = 0; i < in.size(); i++) {
+        int v = in[i];
+        if (v < low) {
+            v = low;
+        } else if (v > high) {
+            v = high;
+        }
+        out[i] = v;
+    }
+}
+
+void clamp_branchless(const std::vector<int>& in, std::vector<int>& out, int low, int high) {
+    for (std::size_t i = 0; i < in.size(); i++) {
+        out[i] = branchless::clamp(in[i], low, high);
+    }
+}
+
+// Sum of the indices found, so the searches can't be optimized away and both versions can be compared
+std::size_t search_branchy(const std::vector<int>& sorted, const std::vector<int>& keys) {
+    std::size_t sum = 0;
+    for (int key : keys) {
+        sum += static_cast<std::size_t>(std::lower_bound(sorted.begin(), sorted.end(), key) - sorted.begin());
+    }
+    return sum;
+}
+
+std::size_t search_branchless(const std::vector<int>& sorted, const std::vector<int>& keys) {
+    std::size_t sum = 0;
+    for (int key : keys) {
+        sum += branchless::lower_bound(sorted.data(), sorted.size(), key);
+    }
+    return sum;
+}
+
+// Collatz step totals for 1..n without the interpreter
+std::int64_t collatz_native(std::int64_t n) {
+    std::int64_t steps = 0;
+    for (std::int64_t i = n; i > 0; i--) {
+        for (std::int64_t x = i; x != 1; steps++) {
+            x = x % 2 ? 3 * x + 1 : x / 2;
+        }
+    }
+    return steps;
+}
+
+// Values in [0, range), uniformly random
+std::vector<int> random_values(std::size_t n, int range, std::uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> distribution(0, range - 1);
+    std::vector<int> values(n);
+    for (int& v : values) {
+        v = distribution(generator);
+    }
+    return values;
+}
+
+// Every branchless kernel against its branchy twin, on sizes that end mid-way through anything unrolled and on
+// the edges: nothing kept, everything kept, keys below and above every element
+void verify() {
+    for (std::size_t n : {0, 1, 2, 3, 17, 1000, 1001}) {
+        std::vector<int> in = random_values(n, 100, static_cast<std::uint32_t>(n));
+        std::vector<int> expected(n);
+        std::vector<int> actual(n);
+        for (int threshold : {-1, 0, 50, 100, 101}) {
+            std::size_t count = filter_branchy(in, expected, threshold);
+            if (filter_branchless(in, actual, threshold) != count || !std::equal(expected.begin(), expected.begin() + count, actual.begin())) {
+                fail("branchless filter differs, n = " + std::to_string(n) + ", threshold " + std::to_string(threshold));
+            }
+        }
+        clamp_branchy(in, expected, 25, 75);
+        clamp_branchless(in, actual, 25, 75);
+        if (expected != actual) {
+            fail("branchless clamp differs, n = " + std::to_string(n));
+        }
+        std::vector<int> sorted = in;
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<int> keys = {-1, 0, 1, 49, 50, 99, 100, 1000};
+        for (int key : keys) {
+            std::size_t index = branchless::lower_bound(sorted.data(), sorted.size(), key);
+            if (index != static_cast<std::size_t>(std::lower_bound(sorted.begin(), sorted.end(), key) - sorted.begin())) {
+                fail("branchless lower_bound differs, n = " + std::to_string(n) + ", key " + std::to_string(key));
+            }
+        }
+    }
+
+    interpreter::Program program = interpreter::collatz(1000);
+    std::int64_t expected = collatz_native(1000);
+    interpreter::Machine machines[3];
+    interpreter::run_switch(program, machines[0]);
+    interpreter::run_table(program, machines[1]);
+    interpreter::run_goto(program, machines[2]);
+    for (const interpreter::Machine& m : machines) {
+        if (m.r[3] != expected || m.executed != machines[0].executed) {
+            fail("interpreter computed " + std::to_string(m.r[3]) + " Collatz steps, expected " + std::to_string(expected));
+        }
+    }
+}
+
+void print_header(const std::string& what) {
+    std::cout << "| " << std::setw(30) << std::left << what << std::right
+              << " | Branchy ns | Branchy misses | Branchless ns | Branchless misses | Speedup |\n";
+    std::cout << "|--------------------------------|------------|----------------|---------------|-------------------|---------|\n";
+}
+
+// `section` tells the rows of different tables apart in the JSON, where they have no heading
+void print_row(const std::string& section, const std::string& name, Measurement branchy, Measurement branchless) {
+    std::cout << "| " << std::setw(30) << std::left << name << std::right << " | " << std::setw(10) << format(branchy.ns, 2)
+              << " | " << std::setw(14) << format(branchy.branch_misses, 3) << " | " << std::setw(13) << format(branchless.ns, 2)
+              << " | " << std::setw(17) << format(branchless.branch_misses, 3) << " | " << std::setw(6)
+              << format(branchy.ns / branchless.ns, 2) << "x |\n";
+    bench::report(section + ", " + name + ": branchy", branchy.ns, "ns");
+    bench::report(section + ", " + name + ": branchless", branchless.ns, "ns");
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    int collatz_numbers = argc > 2 ? std::stoi(argv[2]) : 100000;
+
+    verify();
+
+    PerfCounters counters;
+    if (!counters.available(PerfCounters::branch_misses)) {
+        std::cout << "Branch misses: n/a, hardware counters unavailable (" << counters.error() << ")\n\n";
+    }
+
+    constexpr int range = 1000;
+    std::vector<int> random = random_values(n, range, 42);
+    std::vector<int> sorted = random;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<int> expected(n);
+    std::vector<int> out(n);
+    double items = static_cast<double>(n);
+
+    std::cout << "## Filter: copy the elements below a threshold, " << n << " ints in [0, " << range << ")\n\n";
+    print_header("Data, elements kept");
+    struct FilterCase {
+        const char* name;
+        const std::vector<int>& data;
+        int threshold;
+    };
+    for (const FilterCase& c : {FilterCase{"sorted, 50%", sorted, range / 2}, FilterCase{"random, 1%", random, range / 100},
+                                FilterCase{"random, 10%", random, range / 10}, FilterCase{"random, 50%", random, range / 2},
+                                FilterCase{"random, 90%", random, range * 9 / 10}}) {
+        std::size_t count = 0;
+        Measurement branchy = measure(counters, items, [&] { count = filter_branchy(c.data, expected, c.threshold); });
+        Measurement branchless = measure(counters, items, [&] {
+            if (filter_branchless(c.data, out, c.threshold) != count) {
+                fail("branchless filter kept a different number of elements");
+            }
+        });
+        if (!std::equal(expected.begin(), expected.begin() + count, out.begin())) {
+            fail(std::string("branchless filter differs on ") + c.name);
+        }
+        print_row("Filter", c.name, branchy, branchless);
+    }
+
+    std::cout << "\n## Clamp to [" << range / 4 << ", " << range * 3 / 4 << "], " << n << " ints\n\n";
+    print_header("Data");
+    for (const auto& [name, data] : {std::pair<const char*, const std::vector<int>&>{"sorted", sorted}, {"random", random}}) {
+        Measurement branchy = measure(counters, items, [&] { clamp_branchy(data, expected, range / 4, range * 3 / 4); });
+        Measurement branchless = measure(counters, items, [&] { clamp_branchless(data, out, range / 4, range * 3 / 4); });
+        if (expected != out) {
+            fail(std::string("branchless clamp differs on ") + name);
+        }
+        print_row("Clamp", name, branchy, branchless);
+    }
+
+    // Distinct keys, so the array is as deep as its size says
+    std::vector<int> haystack(n);
+    for (std::size_t i = 0; i < n; i++) {
+        haystack[i] = static_cast<int>(2 * i);
+    }
+    std::vector<int> keys = random_values(n, static_cast<int>(std::min<std::size_t>(2 * n + 1, 2000000000)), 7);
+    std::vector<int> sorted_keys = keys;
+    std::sort(sorted_keys.begin(), sorted_keys.end());
+    std::cout << "\n## Binary search: std::lower_bound vs branchless::lower_bound, " << n << " keys in " << n << " ints\n\n";
+    print_header("Keys");
+    for (const auto& [name, queries] : {std::pair<const char*, const std::vector<int>&>{"sorted", sorted_keys}, {"random", keys}}) {
+        std::size_t sums[2] = {};
+        Measurement branchy = measure(counters, items, [&] { sums[0] = search_branchy(haystack, queries); });
+        Measurement branchless = measure(counters, items, [&] { sums[1] = search_branchless(haystack, queries); });
+        if (sums[0] != sums[1]) {
+            fail(std::string("branchless lower_bound differs on ") + name + " keys");
+        }
+        print_row("Binary search", name, branchy, branchless);
+    }
+
+    interpreter::Program program = interpreter::collatz(collatz_numbers);
+    std::int64_t steps = collatz_native(collatz_numbers);
+    interpreter::Machine probe;
+    interpreter::run_switch(program, probe);
+    double instructions = static_cast<double>(probe.executed);
+    std::cout << "\n## Interpreter dispatch: Collatz steps of 1.." << collatz_numbers << ", " << probe.executed
+              << " bytecode instructions\n\n";
+    std::cout << "| Dispatch               | ns/instruction | M instructions/s | Misses/instruction | Speedup |\n";
+    std::cout << "|------------------------|----------------|------------------|--------------------|---------|\n";
+    struct Dispatch {
+        const char* name;
+        void (*run)(const interpreter::Program&, interpreter::Machine&);
+    };
+    double switch_ns = 0;
+    for (const Dispatch& d : {Dispatch{"switch", interpreter::run_switch}, Dispatch{"function pointer table", interpreter::run_table},
+                              Dispatch{"computed goto", interpreter::run_goto}}) {
+        interpreter::Machine m;
+        Measurement result = measure(counters, instructions, [&] {
+            m = {};
+            d.run(program, m);
+        });
+        if (m.r[3] != steps) {
+            fail(std::string(d.name) + " dispatch computed the wrong result");
+        }
+        if (switch_ns == 0) {
+            switch_ns = result.ns;
+        }
+        std::cout << "| " << std::setw(22) << std::left << d.name << std::right << " | " << std::setw(14) << format(result.ns, 2)
+                  << " | " << std::setw(16) << format(1000 / result.ns, 0) << " | " << std::setw(18) << format(result.branch_misses, 3)
+                  << " | " << std::setw(6) << format(switch_ns / result.ns, 2) << "x |\n";
+        bench::report(std::string("Interpreter: ") + d.name, result.ns, "ns");
+    }
+    std::cout << "\nTimes are per element (per search, per bytecode instruction); misses are mispredicted branches per element"
+              << std::endl;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+// Branchless primitives
+//
+// The CPU guesses the outcome of every conditional branch and keeps executing down the guessed path. A right
+// guess costs almost nothing; a wrong one throws away everything done since - 15-20 cycles on current x86 cores.
+// Predictors learn patterns (sorted data, loop exits), but on random data half the guesses of a 50/50 condition
+// are wrong. These functions compute both outcomes and pick one with arithmetic - a mask, a conditional move,
+// an index advanced by a bool - so there's nothing left to predict. They always pay for both sides, so they win on
+// unpredictable conditions and can lose a little on predictable ones: branch_benchmark.cpp has the numbers.
+//
+//     int v = branchless::clamp(x, 0, 255);
+//     std::size_t kept = branchless::compact(in, n, out, [](int v) { return v >= 0; });
+//     std::size_t i = branchless::lower_bound(sorted, n, key);
+
+namespace branchless {
+
+// All bits set if condition, else zero: `sum += value & mask<int>(keep)` adds value only if keep
+template <typename T>
+    requires std::is_integral_v<T>
+constexpr T mask(bool condition) {
+    return static_cast<T>(-static_cast<std::make_signed_t<T>>(condition));
+}
+
+// condition ? a : b, with both already computed. A ternary between two plain values is exactly what compilers
+// turn into a conditional move (cmov on x86, csel on ARM) or, in a vectorized loop, a blend. The mask version,
+// b ^ ((a ^ b) & mask(condition)), does the same in five instructions instead of one - it's only worth it on
+// targets without conditional moves
+template <typename T>
+constexpr T select(bool condition, T a, T b) {
+    return condition ? a : b;
+}
+
+template <typename T>
+constexpr T min(T a, T b) {
+    return select(b < a, b, a);
+}
+
+template <typename T>
+constexpr T max(T a, T b) {
+    return select(a < b, b, a);
+}
+
+template <typename T>
+constexpr T clamp(T value, T low, T high) {
+    return min(max(value, low), high);
+}
+
+// Copies the elements for which keep(element) is true to out, in order, and returns how many. Every element is
+// written; the write position only moves on for the kept ones. out needs room for all n elements
+template <typename T, typename Keep>
+std::size_t compact(const T* in, std::size_t n, T* out, Keep keep) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        out[count] = in[i];
+        count += static_cast<bool>(keep(in[i]));
+    }
+    return count;
+}
+
+template <typename T, typename Predicate>
+std::size_t count_if(const T* in, std::size_t n, Predicate predicate) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        count += static_cast<bool>(predicate(in[i]));
+    }
+    return count;
+}
+
+// Index of the first element >= key in sorted data, like std::lower_bound. The range halves every step whatever
+// the comparison says, so the loop always runs log2(n) times and its only branch is the loop condition; the
+// comparison just decides how far `base` moves. Its cost: the CPU can't prefetch the next probe by guessing
+// std::lower_bound's branch, so on arrays far bigger than the cache it loses its edge
+template <typename T>
+std::size_t lower_bound(const T* data, std::size_t n, const T& key) {
+    if (n == 0) {
+        return 0;
+    }
+    const T* base = data;
+    while (n > 1) {
+        std::size_t half = n / 2;
+        base += (base[half] < key) * half;
+        n -= half;
+    }
+    return static_cast<std::size_t>(base - data) + (*base < key);
+}
+
+} // namespace branchless
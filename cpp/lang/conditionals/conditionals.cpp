@@ -0,0 +1,134 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <type_traits>
+
+#include "branchless.hpp"
+
+// # Conditionals
+// A condition is any expression that converts to bool: comparisons, integers and pointers (zero and null are
+// false, everything else true), or objects with an `explicit operator bool` like streams and std::optional.
+
+// ## `if`
+void if_statement(int temperature) {
+    if (temperature < 0) {
+        std::cout << temperature << ": freezing" << std::endl;
+    } else if (temperature < 20) {
+        std::cout << temperature << ": cold" << std::endl;
+    } else {
+        std::cout << temperature << ": warm" << std::endl;
+    }
+
+    // && and || short-circuit: the right side is only evaluated if the left side doesn't decide the result
+    // already, so it can rely on the left side being true (or false)
+    const int* sensor = &temperature;
+    if (sensor != nullptr && *sensor > 30) {
+        std::cout << "too hot" << std::endl;
+    }
+}
+
+// ## `if` with an initializer (C++17)
+// A variable that's only needed for the check lives in the if's scope - including the else branches - and no
+// further
+void if_with_initializer(const std::map<std::string, int>& stock, const std::string& item) {
+    if (auto it = stock.find(item); it != stock.end()) {
+        std::cout << item << ": " << it->second << " in stock" << std::endl;
+    } else {
+        std::cout << item << ": not sold here" << std::endl;
+    }
+    // `it` doesn't exist here
+}
+
+// ## The conditional operator
+// `condition ? a : b` is an expression, so it can initialize a const variable or sit in a function call.
+// Both sides must have a common type
+const char* parity(int n) {
+    return n % 2 == 0 ? "even" : "odd";
+}
+
+// ## `switch`
+// Jumps to the case label equal to the value; only integers and enums (no strings). Without a `break`, execution
+// falls through into the next case - occasionally useful, usually a bug, so intentional ones are marked with
+// [[fallthrough]] to silence the compiler's warning. Dense case values become a jump table: one indirect jump,
+// however many cases
+enum class Command : std::uint8_t { start, stop, pause, resume, reset };
+
+void switch_statement(Command command) {
+    switch (command) {
+    case Command::start:
+        std::cout << "starting" << std::endl;
+        break;
+    case Command::reset:
+        std::cout << "resetting, then ";
+        [[fallthrough]];
+    case Command::stop:
+        std::cout << "stopping" << std::endl;
+        break;
+    case Command::pause:
+    case Command::resume: // Several labels, one body
+        std::cout << "toggling pause" << std::endl;
+        break;
+    }
+    // No default: with an enum class, -Wall warns about any value without a case, which is worth more than
+    // a default that hides the enum growing
+}
+
+// ## [[likely]] and [[unlikely]] (C++20)
+// Hints about which way a branch usually goes. The compiler lays out the likely path as straight-line code and
+// moves the unlikely one out of the way - it doesn't change what the CPU's branch predictor guesses at runtime
+int checked_divide(int a, int b) {
+    if (b == 0) [[unlikely]] {
+        std::cout << "division by zero" << std::endl;
+        return 0;
+    }
+    return a / b;
+}
+
+// ## `if constexpr` (C++17)
+// Decided at compile time: the discarded branch isn't even compiled for that type, so it can use things the type
+// doesn't have
+template <typename T>
+std::string describe(const T& value) {
+    if constexpr (std::is_arithmetic_v<T>) {
+        return "number " + std::to_string(value);
+    } else {
+        return "text \"" + std::string(value) + "\"";
+    }
+}
+
+// ## Conditionals without branches
+// The CPU guesses which way each branch goes long before the condition is computed. On data with no pattern it's
+// wrong half the time, and every wrong guess costs ~15-20 cycles. branchless.hpp computes both outcomes and picks
+// one with arithmetic instead: branch_benchmark.cpp measures when that pays off
+void branchless_code() {
+    int values[] = {7, -3, 12, 0, 5, -8, 9};
+    constexpr std::size_t n = std::size(values);
+
+    // Instead of `if (v > 0) out[count++] = v;`: always write, only move on when the value is kept
+    int positive[n];
+    std::size_t count = branchless::compact(values, n, positive, [](int v) { return v > 0; });
+    std::cout << count << " positive values, the first is " << positive[0] << std::endl;
+
+    // A bool is 0 or 1, so it can be added; mask() turns it into all bits 0 or 1 for & and |
+    int sum = 0;
+    for (int v : values) {
+        sum += v & branchless::mask<int>(v > 0);
+    }
+    std::cout << "sum of the positive values: " << sum << ", 12 clamped to [0, 10]: " << branchless::clamp(12, 0, 10)
+              << std::endl;
+}
+
+int main() {
+    if_statement(-5);
+    if_statement(35);
+    if_with_initializer({{"apples", 12}, {"pears", 0}}, "apples");
+    if_with_initializer({{"apples", 12}, {"pears", 0}}, "kiwis");
+    std::cout << "7 is " << parity(7) << std::endl;
+    switch_statement(Command::reset);
+    switch_statement(Command::pause);
+    checked_divide(1, 0);
+    std::cout << describe(42) << ", " << describe("forty-two") << std::endl;
+    branchless_code();
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A tiny register-machine bytecode interpreter, with three ways to get from one instruction to the next
+//   * run_switch - a loop around a switch. The compiler makes the switch a jump table, so every instruction goes
+//                  through the same indirect jump at the top of the loop
+//   * run_table  - an array of function pointers, one per opcode: an indirect call per instruction, plus the
+//                  call/return overhead, but handlers can be replaced at runtime
+//   * run_goto   - "threaded code": GCC/Clang's computed goto (&&label, goto *ptr). Every handler ends with its own
+//                  indirect jump to the next handler, so the branch predictor sees a separate jump per opcode and
+//                  can learn "after a compare usually comes a conditional jump". Compilers without the extension
+//                  get run_switch
+//
+// All three run the same programs and count the instructions they execute. collatz(n) is the benchmark program.
+
+namespace interpreter {
+
+enum class Op : std::uint8_t {
+    movi, // r[a] = imm
+    mov,  // r[a] = r[b]
+    add,  // r[a] = r[b] + r[c]
+    addi, // r[a] = r[b] + imm
+    muli, // r[a] = r[b] * imm
+    andi, // r[a] = r[b] & imm
+    shri, // r[a] = r[b] >> imm
+    jmp,  // pc = imm
+    jz,   // if r[a] == 0: pc = imm
+    jnz,  // if r[a] != 0: pc = imm
+    halt,
+    count
+};
+
+struct Instruction {
+    Op op;
+    std::uint8_t a = 0;
+    std::uint8_t b = 0;
+    std::uint8_t c = 0;
+    std::int32_t imm = 0;
+};
+
+using Program = std::vector<Instruction>;
+
+constexpr std::size_t register_count = 8;
+
+struct Machine {
+    std::array<std::int64_t, register_count> r{};
+    std::uint64_t executed = 0; // Instructions run, halt included
+};
+
+// Total Collatz steps (n -> n/2 if even, 3n+1 if odd, until 1) of every number from 1 to n, left in r3. The
+// odd/even test is a data-dependent jump inside the program, so the sequence of opcodes is irregular - the hard
+// case for dispatch, and what real bytecode looks like
+inline Program collatz(std::int32_t n) {
+    return {
+        {Op::movi, 0, 0, 0, n},  // 0:  r0 = n
+        {Op::movi, 3, 0, 0, 0},  // 1:  r3 = 0 (steps)
+        {Op::mov, 1, 0},         // 2:  r1 = r0 (outer loop: the number)
+        {Op::addi, 4, 1, 0, -1}, // 3:  r4 = r1 - 1 (inner loop)
+        {Op::jz, 4, 0, 0, 13},   // 4:  r1 == 1: next number
+        {Op::addi, 3, 3, 0, 1},  // 5:  steps++
+        {Op::andi, 2, 1, 0, 1},  // 6:  r2 = r1 odd?
+        {Op::jz, 2, 0, 0, 11},   // 7:  even
+        {Op::muli, 1, 1, 0, 3},  // 8:  r1 = 3 * r1
+        {Op::addi, 1, 1, 0, 1},  // 9:  r1 = r1 + 1
+        {Op::jmp, 0, 0, 0, 3},   // 10
+        {Op::shri, 1, 1, 0, 1},  // 11: r1 = r1 / 2
+        {Op::jmp, 0, 0, 0, 3},   // 12
+        {Op::addi, 0, 0, 0, -1}, // 13: r0--
+        {Op::jnz, 0, 0, 0, 2},   // 14
+        {Op::halt},              // 15
+    };
+}
+
+// ## switch
+inline void run_switch(const Program& program, Machine& m) {
+    const Instruction* code = program.data();
+    std::int64_t* r = m.r.data();
+    std::uint64_t executed = 0;
+    std::size_t pc = 0;
+    while (true) {
+        const Instruction& in = code[pc++];
+        executed++;
+        switch (in.op) {
+        case Op::movi: r[in.a] = in.imm; break;
+        case Op::mov: r[in.a] = r[in.b]; break;
+        case Op::add: r[in.a] = r[in.b] + r[in.c]; break;
+        case Op::addi: r[in.a] = r[in.b] + in.imm; break;
+        case Op::muli: r[in.a] = r[in.b] * in.imm; break;
+        case Op::andi: r[in.a] = r[in.b] & in.imm; break;
+        case Op::shri: r[in.a] = r[in.b] >> in.imm; break;
+        case Op::jmp: pc = static_cast<std::size_t>(in.imm); break;
+        case Op::jz: if (r[in.a] == 0) pc = static_cast<std::size_t>(in.imm); break;
+        case Op::jnz: if (r[in.a] != 0) pc = static_cast<std::size_t>(in.imm); break;
+        case Op::halt:
+        case Op::count:
+            m.executed += executed;
+            return;
+        }
+    }
+}
+
+// ## Table of function pointers
+// Every handler returns the next pc; halt returns `stop`
+namespace handlers {
+
+constexpr std::size_t stop = ~std::size_t{0};
+using Handler = std::size_t (*)(const Instruction&, std::int64_t*, std::size_t);
+
+inline std::size_t movi(const Instruction& in, std::int64_t* r, std::size_t pc) { r[in.a] = in.imm; return pc + 1; }
+inline std::size_t mov(const Instruction& in, std::int64_t* r, std::size_t pc) { r[in.a] = r[in.b]; return pc + 1; }
+inline std::size_t add(const Instruction& in, std::int64_t* r, std::size_t pc) { r[in.a] = r[in.b] + r[in.c]; return pc + 1; }
+inline std::size_t addi(const Instruction& in, std::int64_t* r, std::size_t pc) { r[in.a] = r[in.b] + in.imm; return pc + 1; }
+inline std::size_t muli(const Instruction& in, std::int64_t* r, std::size_t pc) { r[in.a] = r[in.b] * in.imm; return pc + 1; }
+inline std::size_t andi(const Instruction& in, std::int64_t* r, std::size_t pc) { r[in.a] = r[in.b] & in.imm; return pc + 1; }
+inline std::size_t shri(const Instruction& in, std::int64_t* r, std::size_t pc) { r[in.a] = r[in.b] >> in.imm; return pc + 1; }
+inline std::size_t jmp(const Instruction& in, std::int64_t*, std::size_t) { return static_cast<std::size_t>(in.imm); }
+inline std::size_t jz(const Instruction& in, std::int64_t* r, std::size_t pc) {
+    return r[in.a] == 0 ? static_cast<std::size_t>(in.imm) : pc + 1;
+}
+inline std::size_t jnz(const Instruction& in, std::int64_t* r, std::size_t pc) {
+    return r[in.a] != 0 ? static_cast<std::size_t>(in.imm) : pc + 1;
+}
+inline std::size_t halt(const Instruction&, std::int64_t*, std::size_t) { return stop; }
+
+// Indexed by Op
+constexpr std::array<Handler, static_cast<std::size_t>(Op::count)> table = {movi, mov, add, addi, muli, andi,
+                                                                           shri, jmp, jz, jnz, halt};
+
+} // namespace handlers
+
+inline void run_table(const Program& program, Machine& m) {
+    const Instruction* code = program.data();
+    std::int64_t* r = m.r.data();
+    std::uint64_t executed = 0;
+    std::size_t pc = 0;
+    while (pc != handlers::stop) {
+        const Instruction& in = code[pc];
+        executed++;
+        pc = handlers::table[static_cast<std::size_t>(in.op)](in, r, pc);
+    }
+    m.executed += executed;
+}
+
+// ## Computed goto
+#if defined(__GNUC__)
+inline void run_goto(const Program& program, Machine& m) {
+    // Indexed by Op, like handlers::table
+    static constexpr void* labels[] = {&&op_movi, &&op_mov, &&op_add, &&op_addi, &&op_muli, &&op_andi,
+                                       &&op_shri, &&op_jmp, &&op_jz, &&op_jnz, &&op_halt};
+    const Instruction* code = program.data();
+    const Instruction* in = code;
+    std::int64_t* r = m.r.data();
+    std::uint64_t executed = 0;
+
+#define INTERPRETER_NEXT()                                  \
+    do {                                                    \
+        executed++;                                         \
+        goto* labels[static_cast<std::size_t>(in->op)];     \
+    } while (false)
+
+    INTERPRETER_NEXT();
+op_movi:
+    r[in->a] = in->imm;
+    in++;
+    INTERPRETER_NEXT();
+op_mov:
+    r[in->a] = r[in->b];
+    in++;
+    INTERPRETER_NEXT();
+op_add:
+    r[in->a] = r[in->b] + r[in->c];
+    in++;
+    INTERPRETER_NEXT();
+op_addi:
+    r[in->a] = r[in->b] + in->imm;
+    in++;
+    INTERPRETER_NEXT();
+op_muli:
+    r[in->a] = r[in->b] * in->imm;
+    in++;
+    INTERPRETER_NEXT();
+op_andi:
+    r[in->a] = r[in->b] & in->imm;
+    in++;
+    INTERPRETER_NEXT();
+op_shri:
+    r[in->a] = r[in->b] >> in->imm;
+    in++;
+    INTERPRETER_NEXT();
+op_jmp:
+    in = code + in->imm;
+    INTERPRETER_NEXT();
+op_jz:
+    in = r[in->a] == 0 ? code + in->imm : in + 1;
+    INTERPRETER_NEXT();
+op_jnz:
+    in = r[in->a] != 0 ? code + in->imm : in + 1;
+    INTERPRETER_NEXT();
+op_halt:
+    m.executed += executed;
+
+#undef INTERPRETER_NEXT
+}
+#else
+inline void run_goto(const Program& program, Machine& m) {
+    run_switch(program, m);
+}
+#endif
+
+} // namespace interpreter
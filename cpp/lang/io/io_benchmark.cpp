@@ -0,0 +1,313 @@
+// Reading a big file: counts the lines and sums every number of an integer CSV file, with std::getline and with
+// the readers from readers.hpp + io::Lines. Every reader runs once with the file in the page cache and once with
+// the file dropped from it, so it has to come from the disk. The file is generated on the first run and kept.
+//
+// Build: g++ -std=c++20 -O2 io_benchmark.cpp -o io_benchmark
+// Usage: ./io_benchmark [size in MiB = 2048] [file = /tmp/io_benchmark.csv]
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../../testing/report.hpp"
+#include "readers.hpp"
+#include "records.hpp"
+
+namespace fs = std::filesystem;
+
+constexpr int columns = 8;
+
+struct Result {
+    std::uint64_t lines = 0;
+    // Unsigned, so it wraps instead of overflowing: the last column alone goes up to 10^15, and a 2 GiB file has
+    // tens of millions of rows. The methods still agree, modulo 2^64
+    std::uint64_t sum = 0;
+};
+
+// ## The file
+// Rows of `columns` integers of mixed widths and signs, written with std::to_chars into a big buffer.
+// A file of about the right size from an earlier run is reused
+void generate(const fs::path& path, std::uintmax_t size) {
+    std::error_code error;
+    std::uintmax_t existing = fs::file_size(path, error);
+    if (!error && existing >= size && existing < size + 4096) {
+        return;
+    }
+    std::cout << "Generating " << path.string() << "..." << std::endl;
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        io::throw_errno(errno, "open " + path.string());
+    }
+    std::vector<char> buffer(io::default_chunk_size + 4096);
+    std::uint64_t state = 88172645463325252ull;
+    std::uintmax_t written = 0;
+    while (written < size) {
+        std::size_t used = 0;
+        while (used < io::default_chunk_size && written + used < size) {
+            for (int column = 0; column < columns; column++) {
+                state ^= state << 13; // xorshift64
+                state ^= state >> 7;
+                state ^= state << 17;
+                // Column c has up to 2c+1 digits, and every other column is signed
+                std::int64_t modulus = 1;
+                for (int digits = 0; digits <= 2 * column; digits++) {
+                    modulus *= 10;
+                }
+                std::int64_t value = static_cast<std::int64_t>(state % static_cast<std::uint64_t>(modulus));
+                if (column % 2 == 1 && (state >> 63) != 0) {
+                    value = -value;
+                }
+                used = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value).ptr - buffer.data();
+                buffer[used++] = column + 1 < columns ? ',' : '\n';
+            }
+        }
+        for (std::size_t done = 0; done < used;) {
+            ssize_t bytes = ::write(fd, buffer.data() + done, used - done);
+            if (bytes < 0) {
+                io::throw_errno(errno, "write " + path.string());
+            }
+            done += static_cast<std::size_t>(bytes);
+        }
+        written += used;
+    }
+    ::fsync(fd); // Dirty pages can't be dropped from the page cache, written ones can
+    ::close(fd);
+}
+
+// ## Page cache
+// POSIX_FADV_DONTNEED drops the file's pages from the page cache (no root needed, unlike
+// /proc/sys/vm/drop_caches), so the next read has to go to the disk
+void drop_from_cache(const fs::path& path) {
+    io::File file(path.string(), O_RDONLY);
+    ::posix_fadvise(file.fd(), 0, 0, POSIX_FADV_DONTNEED);
+}
+
+// How much of the file is in the page cache, 0 to 1: mincore() reports it for every page of a mapping
+double cached_fraction(const fs::path& path) {
+    io::File file(path.string(), O_RDONLY);
+    std::size_t size = file.size();
+    if (size == 0) {
+        return 1;
+    }
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, file.fd(), 0);
+    if (data == MAP_FAILED) {
+        return 0;
+    }
+    std::vector<unsigned char> pages((size + io::page_size - 1) / io::page_size);
+    std::size_t cached = 0;
+    if (::mincore(data, size, pages.data()) == 0) {
+        cached = std::count_if(pages.begin(), pages.end(), [](unsigned char page) { return page & 1; });
+    }
+    ::munmap(data, size);
+    return static_cast<double>(cached) / static_cast<double>(pages.size());
+}
+
+// ## The work
+template <typename Reader>
+Result count_lines(Reader& reader) {
+    Result result;
+    for (std::string_view line : io::Lines(reader)) {
+        (void)line;
+        result.lines++;
+    }
+    return result;
+}
+
+template <typename Reader>
+Result sum_csv(Reader& reader) {
+    Result result;
+    for (std::string_view line : io::Lines(reader)) {
+        result.lines++;
+        io::Fields fields(line);
+        std::int64_t value;
+        for (std::string_view field; fields.next(field);) {
+            if (!io::parse(field, value)) {
+                std::cerr << "ERROR: not a number: \"" << field << "\"" << std::endl;
+                std::exit(1);
+            }
+            result.sum += static_cast<std::uint64_t>(value);
+        }
+    }
+    return result;
+}
+
+Result getline_lines(const fs::path& path) {
+    Result result;
+    std::ifstream in(path);
+    for (std::string line; std::getline(in, line);) {
+        result.lines++;
+    }
+    return result;
+}
+
+// What most CSV code looks like: std::getline for lines, a std::stringstream to split them, std::stoll for numbers
+Result getline_csv(const fs::path& path) {
+    Result result;
+    std::ifstream in(path);
+    std::string field;
+    for (std::string line; std::getline(in, line);) {
+        result.lines++;
+        std::stringstream fields(line);
+        while (std::getline(fields, field, ',')) {
+            result.sum += static_cast<std::uint64_t>(std::stoll(field));
+        }
+    }
+    return result;
+}
+
+struct Method {
+    std::string name;
+    std::function<Result(const fs::path&)> lines;
+    std::function<Result(const fs::path&)> csv;
+};
+
+template <typename MakeReader>
+Method with_reader(std::string name, MakeReader make) {
+    return {std::move(name),
+            [make](const fs::path& path) { auto reader = make(path.string()); return count_lines(*reader); },
+            [make](const fs::path& path) { auto reader = make(path.string()); return sum_csv(*reader); }};
+}
+
+std::vector<Method> methods() {
+    return {
+        {"std::getline (+ stringstream)", getline_lines, getline_csv},
+        with_reader("ifstream::read + Lines", [](const std::string& p) { return std::make_unique<io::IfstreamReader>(p); }),
+        with_reader("pread + Lines", [](const std::string& p) { return std::make_unique<io::PreadReader>(p); }),
+        with_reader("pread O_DIRECT + Lines", [](const std::string& p) {
+            return std::make_unique<io::PreadReader>(p, io::default_chunk_size, true);
+        }),
+        with_reader("mmap + Lines", [](const std::string& p) { return std::make_unique<io::MmapReader>(p); }),
+        with_reader("io_uring + Lines", [](const std::string& p) { return std::make_unique<io::UringReader>(p); }),
+    };
+}
+
+// ## Verification
+// The line splitter against a plain loop over the whole string, with chunks small enough that records get split
+// between chunks: CRLF line endings, empty lines, a line longer than a chunk, no '\n' at the end
+void verify_records() {
+    std::string text = "1,2,3\r\n\n-4,5\n\r\n" + std::string(10000, '7') + "\n8\n,\n9";
+    fs::path path = fs::temp_directory_path() / "io_benchmark_verify.txt";
+    std::ofstream(path, std::ios::binary) << text;
+
+    std::vector<std::string> expected;
+    for (std::size_t start = 0; start <= text.size();) {
+        std::size_t end = std::min(text.find('\n', start), text.size());
+        std::string line = text.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        expected.push_back(line);
+        start = end + 1;
+    }
+
+    auto check = [&](auto& reader, const std::string& what) {
+        std::vector<std::string> actual;
+        for (std::string_view line : io::Lines(reader)) {
+            actual.emplace_back(line);
+        }
+        if (actual != expected) {
+            std::cerr << "ERROR: " << what << " splits the lines wrong" << std::endl;
+            std::exit(1);
+        }
+    };
+    for (std::size_t chunk : {1, 2, 3, 7, 4096, 1 << 20}) {
+        io::IfstreamReader reader(path.string(), chunk);
+        check(reader, "ifstream, chunk " + std::to_string(chunk));
+    }
+    io::PreadReader pread(path.string(), 4096);
+    check(pread, "pread");
+    io::PreadReader direct(path.string(), 4096, true);
+    check(direct, "pread O_DIRECT");
+    io::MmapReader mmap(path.string());
+    check(mmap, "mmap");
+    for (unsigned depth : {1, 2, 8}) {
+        io::UringReader uring(path.string(), 4096, depth);
+        check(uring, "io_uring, depth " + std::to_string(depth));
+    }
+    fs::remove(path);
+}
+
+template <typename F>
+double seconds(F&& work) {
+    auto begin = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// GB/s of one run, after checking its result
+double measure(const std::function<Result(const fs::path&)>& run, const fs::path& path, bool cold,
+               const Result& expected, const std::string& what) {
+    if (cold) {
+        drop_from_cache(path);
+    } else {
+        run(path); // Warm up: loads the file into the page cache
+    }
+    Result result;
+    double time = seconds([&] { result = run(path); });
+    if (result.lines != expected.lines || (expected.sum != 0 && result.sum != expected.sum)) {
+        std::cerr << "ERROR: " << what << ": " << result.lines << " lines, sum " << result.sum << ", expected "
+                  << expected.lines << " lines, sum " << expected.sum << std::endl;
+        std::exit(1);
+    }
+    return static_cast<double>(fs::file_size(path)) / time / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+    std::uintmax_t size = (argc > 1 ? std::stoull(argv[1]) : 2048) << 20;
+    fs::path path = argc > 2 ? fs::path(argv[2]) : fs::temp_directory_path() / "io_benchmark.csv";
+
+    verify_records();
+    generate(path, size);
+
+    // The reference result comes from std::getline, which shares no code with the readers
+    Result lines = getline_lines(path);
+    Result csv = getline_csv(path);
+    // Asked before the drop, with nothing left open or in flight that could pull the file back into the cache
+    bool direct = io::PreadReader(path.string(), io::default_chunk_size, true).direct();
+    bool uring = io::UringReader::available();
+    drop_from_cache(path);
+    double dropped = cached_fraction(path);
+
+    std::cout << "## " << (fs::file_size(path) >> 20) << " MiB, " << lines.lines << " lines of " << columns << " integers\n\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "| Method                         | Lines, cached | CSV, cached | Lines, disk | CSV, disk  |\n";
+    std::cout << "|--------------------------------|---------------|-------------|-------------|------------|\n";
+    for (const Method& method : methods()) {
+        double lines_cached = measure(method.lines, path, false, lines, method.name + ", lines");
+        double csv_cached = measure(method.csv, path, false, csv, method.name + ", CSV");
+        double lines_disk = measure(method.lines, path, true, lines, method.name + ", lines");
+        double csv_disk = measure(method.csv, path, true, csv, method.name + ", CSV");
+        std::cout << "| " << std::setw(30) << std::left << method.name << std::right << " | " << std::setw(13)
+                  << lines_cached << " | " << std::setw(11) << csv_cached << " | " << std::setw(11) << lines_disk
+                  << " | " << std::setw(10) << csv_disk << " |" << std::endl;
+        bench::report(method.name + ": lines, cached", lines_cached, "GB/s");
+        bench::report(method.name + ": CSV, cached", csv_cached, "GB/s");
+        bench::report(method.name + ": lines, disk", lines_disk, "GB/s");
+        bench::report(method.name + ": CSV, disk", csv_disk, "GB/s");
+    }
+    std::cout << "\nGB/s of the file. Disk: the file dropped from the page cache before the run (" << std::setprecision(0)
+              << dropped * 100 << "% of it stayed cached)\n";
+    if (!direct) {
+        std::cout << "O_DIRECT isn't supported by this filesystem, pread O_DIRECT is a normal pread here\n";
+    }
+    if (!uring) {
+        std::cout << "io_uring isn't available, io_uring is pread here\n";
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,499 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define IO_HAS_URING 1
+#else
+#define IO_HAS_URING 0
+#endif
+
+// Four ways to read a file from start to end (Linux/POSIX)
+//   * io::IfstreamReader - std::ifstream::read into a buffer, the portable baseline
+//   * io::PreadReader    - pread() into a large page-aligned buffer, optionally with O_DIRECT (no page cache)
+//   * io::MmapReader     - maps the whole file into memory; the kernel pages it in as it's read, no copy at all
+//   * io::UringReader    - io_uring: keeps several reads in flight while the caller works on the previous chunk,
+//                          so the disk never waits for the CPU. Falls back to pread where io_uring isn't available
+//
+// They all hand out the file in chunks, through the same two calls:
+//     io::PreadReader reader("log.csv");
+//     for (std::string_view chunk = reader.next(); !chunk.empty(); chunk = reader.next()) { ... }
+// A chunk stays valid until the next call to next(). records.hpp splits the chunks into lines.
+//
+// Errors throw std::system_error with the errno of the failed call.
+
+namespace io {
+
+inline constexpr std::size_t default_chunk_size = 1 << 20; // 1 MiB: big enough that syscalls are a rounding error
+inline constexpr std::size_t page_size = 4096;             // O_DIRECT needs buffers, sizes and offsets aligned to this
+
+[[noreturn]] inline void throw_errno(int error, const std::string& what) {
+    throw std::system_error(error, std::generic_category(), what);
+}
+
+// Page-aligned heap buffer
+class AlignedBuffer {
+public:
+    explicit AlignedBuffer(std::size_t size)
+        : size_(size), data_(static_cast<char*>(::operator new(size, std::align_val_t(page_size)))) {}
+
+    char* data() const { return data_.get(); }
+    std::size_t size() const { return size_; }
+
+private:
+    struct Delete {
+        void operator()(char* ptr) const { ::operator delete(ptr, std::align_val_t(page_size)); }
+    };
+    std::size_t size_;
+    std::unique_ptr<char, Delete> data_;
+};
+
+// Owns a file descriptor
+class File {
+public:
+    File(const std::string& path, int flags) : fd_(::open(path.c_str(), flags | O_CLOEXEC)) {
+        if (fd_ < 0) {
+            throw_errno(errno, "open " + path);
+        }
+    }
+    ~File() { ::close(fd_); }
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+
+    int fd() const { return fd_; }
+    std::size_t size() const {
+        struct stat info {};
+        if (::fstat(fd_, &info) != 0) {
+            throw_errno(errno, "fstat");
+        }
+        return static_cast<std::size_t>(info.st_size);
+    }
+
+private:
+    int fd_;
+};
+
+// ## std::ifstream
+// The file goes disk -> page cache -> filebuf -> our buffer. Reading large blocks skips most of filebuf's own work,
+// so this is what iostreams can do at best - std::getline on the same stream is much slower (io_benchmark.cpp)
+class IfstreamReader {
+public:
+    explicit IfstreamReader(const std::string& path, std::size_t chunk_size = default_chunk_size)
+        : file_(path, std::ios::binary), buffer_(chunk_size) {
+        if (!file_) {
+            throw_errno(errno, "open " + path);
+        }
+    }
+
+    std::string_view next() {
+        file_.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        return {buffer_.data(), static_cast<std::size_t>(file_.gcount())};
+    }
+
+private:
+    std::ifstream file_;
+    std::vector<char> buffer_;
+};
+
+// ## pread
+// One syscall per chunk, straight into our buffer: disk -> page cache -> buffer. POSIX_FADV_SEQUENTIAL makes the
+// kernel read ahead further than usual. With direct = true the file is opened with O_DIRECT, which skips the page
+// cache: the disk writes into our buffer. No memory is spent caching a file read once, but there's no read-ahead
+// either, so every read waits for the disk. Filesystems without O_DIRECT (tmpfs) get a normal buffered read
+class PreadReader {
+public:
+    explicit PreadReader(const std::string& path, std::size_t chunk_size = default_chunk_size, bool direct = false)
+        : file_(open(path, direct, direct_)), size_(file_.size()), buffer_(round_up(chunk_size, page_size)) {
+        if (!direct_) {
+            ::posix_fadvise(file_.fd(), 0, 0, POSIX_FADV_SEQUENTIAL);
+        }
+    }
+
+    bool direct() const { return direct_; }
+
+    std::string_view next() {
+        if (offset_ >= size_) {
+            return {};
+        }
+        ssize_t bytes;
+        do {
+            bytes = ::pread(file_.fd(), buffer_.data(), buffer_.size(), static_cast<off_t>(offset_));
+        } while (bytes < 0 && errno == EINTR);
+        if (bytes < 0) {
+            throw_errno(errno, "pread");
+        }
+        offset_ += static_cast<std::size_t>(bytes);
+        if (bytes == 0) {
+            offset_ = size_; // The file got shorter
+        }
+        return {buffer_.data(), static_cast<std::size_t>(bytes)};
+    }
+
+private:
+    static File open(const std::string& path, bool direct, bool& opened_direct) {
+        opened_direct = false;
+        if (direct) {
+            int fd = ::open(path.c_str(), O_RDONLY | O_DIRECT | O_CLOEXEC);
+            if (fd >= 0) {
+                ::close(fd);
+                opened_direct = true;
+                return File(path, O_RDONLY | O_DIRECT);
+            }
+        }
+        return File(path, O_RDONLY);
+    }
+
+    static std::size_t round_up(std::size_t size, std::size_t alignment) {
+        return std::max(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+
+    bool direct_ = false;
+    File file_;
+    std::size_t size_;
+    std::size_t offset_ = 0;
+    AlignedBuffer buffer_;
+};
+
+// ## mmap
+// The file becomes part of the address space; touching a page the first time faults it in from the page cache,
+// with no copy into a buffer of ours. MADV_SEQUENTIAL asks for aggressive read-ahead and lets the kernel drop pages
+// behind us. The whole file is one chunk, so nothing downstream ever has to stitch a line back together.
+// The catch: I/O errors arrive as SIGBUS instead of an error code, and so does the file being truncated meanwhile
+class MmapReader {
+public:
+    explicit MmapReader(const std::string& path) : file_(path, O_RDONLY), size_(file_.size()) {
+        if (size_ == 0) {
+            return; // mmap can't map 0 bytes
+        }
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_.fd(), 0);
+        if (data == MAP_FAILED) {
+            throw_errno(errno, "mmap " + path);
+        }
+        data_ = static_cast<const char*>(data);
+        ::madvise(data, size_, MADV_SEQUENTIAL);
+    }
+    ~MmapReader() {
+        if (data_ != nullptr) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+    }
+    MmapReader(const MmapReader&) = delete;
+    MmapReader& operator=(const MmapReader&) = delete;
+
+    std::string_view next() {
+        if (done_ || data_ == nullptr) {
+            return {};
+        }
+        done_ = true;
+        return {data_, size_};
+    }
+
+private:
+    File file_;
+    std::size_t size_;
+    const char* data_ = nullptr;
+    bool done_ = false;
+};
+
+// ## io_uring
+// Two ring buffers shared with the kernel: we put read requests into the submission queue, the kernel puts results
+// into the completion queue. One io_uring_enter() syscall submits any number of requests, and they all run while
+// we do other work. Here `depth` chunks are always in flight: when the caller asks for the next chunk, the buffer
+// of the one it just finished goes straight back to the kernel for the chunk `depth` positions further on.
+//
+// Written against the raw syscalls and <linux/io_uring.h>, without liburing. Where the header is missing or the
+// kernel refuses (older than 5.1, or io_uring blocked by a container's seccomp profile), it reads with pread
+// instead - uring() says which one it is
+class UringReader {
+public:
+    explicit UringReader(const std::string& path, std::size_t chunk_size = default_chunk_size, unsigned depth = 4)
+        : file_(path, O_RDONLY), size_(file_.size()), chunk_size_(std::max(chunk_size, page_size)) {
+#if IO_HAS_URING
+        depth = std::max(depth, 1u);
+        io_uring_params params{};
+        ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, depth, &params));
+        if (ring_fd_ >= 0) {
+            // The destructor doesn't run for a half-built object: undo the ring by hand if anything here throws
+            try {
+                map_rings(params);
+                ::posix_fadvise(file_.fd(), 0, 0, POSIX_FADV_SEQUENTIAL);
+                for (unsigned slot = 0; slot < depth; slot++) {
+                    slots_.push_back(Slot{AlignedBuffer(chunk_size_)});
+                }
+                for (unsigned slot = 0; slot < depth; slot++) {
+                    start(slot, slot);
+                }
+                enter(pending_submissions_, 0);
+            } catch (...) {
+                close_ring();
+                throw;
+            }
+            return;
+        }
+#endif
+        fallback_.emplace(path, chunk_size);
+    }
+
+    ~UringReader() {
+#if IO_HAS_URING
+        close_ring();
+#endif
+    }
+
+    UringReader(const UringReader&) = delete;
+    UringReader& operator=(const UringReader&) = delete;
+
+    bool uring() const { return !fallback_.has_value(); }
+
+    // Whether the kernel lets us set up a ring, without opening a file or starting any reads
+    static bool available() {
+#if IO_HAS_URING
+        io_uring_params params{};
+        int fd = static_cast<int>(::syscall(__NR_io_uring_setup, 1, &params));
+        if (fd >= 0) {
+            ::close(fd);
+            return true;
+        }
+#endif
+        return false;
+    }
+
+    std::string_view next() {
+        if (fallback_) {
+            return fallback_->next();
+        }
+#if IO_HAS_URING
+        std::size_t chunks = (size_ + chunk_size_ - 1) / chunk_size_;
+        if (held_ >= 0) {
+            // The caller is done with the previous chunk: reuse its buffer for the chunk depth positions ahead
+            start(static_cast<unsigned>(held_), next_chunk_ - 1 + slots_.size());
+            held_ = -1;
+        }
+        if (next_chunk_ >= chunks) {
+            return {};
+        }
+        unsigned slot = static_cast<unsigned>(next_chunk_ % slots_.size());
+        enter(pending_submissions_, 0);
+        while (!slots_[slot].done) {
+            enter(pending_submissions_, 1);
+            reap();
+        }
+        Slot& current = slots_[slot];
+        held_ = static_cast<int>(slot);
+        next_chunk_++;
+        return {current.buffer.data(), current.filled};
+#else
+        return {};
+#endif
+    }
+
+private:
+    struct Slot {
+        AlignedBuffer buffer;
+        iovec iov{};
+        std::size_t offset = 0;   // Where in the file the chunk starts
+        std::size_t expected = 0; // Bytes in the chunk
+        std::size_t filled = 0;   // Bytes read so far
+        bool done = true;
+    };
+
+#if IO_HAS_URING
+    void map_rings(const io_uring_params& params) {
+        sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP; // Both rings in one mapping, since 5.4
+        if (single_mmap) {
+            sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+        }
+        sq_ptr_ = map(sq_size_, IORING_OFF_SQ_RING);
+        cq_ptr_ = single_mmap ? sq_ptr_ : map(cq_size_, IORING_OFF_CQ_RING);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map(sqes_size_, IORING_OFF_SQES));
+
+        char* sq = static_cast<char*>(sq_ptr_);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    // Waits for every read, then unmaps the rings and closes the ring. Never throws: it runs in the destructor, and
+    // when the constructor fails, with an exception already on its way
+    void close_ring() noexcept {
+        if (ring_fd_ < 0) {
+            return;
+        }
+        // Entries that were queued but never submitted won't complete: the kernel has never seen them
+        in_flight_ -= std::min(in_flight_, pending_submissions_);
+        pending_submissions_ = 0;
+        // The kernel may still be writing into our buffers: wait for every read before freeing them. Errors don't
+        // matter any more, each completion only has to be counted
+        bool drained = cq_tail_ == nullptr || in_flight_ == 0; // Nothing is in flight before the rings are mapped
+        while (!drained) {
+            long result;
+            do {
+                result = ::syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            } while (result < 0 && errno == EINTR);
+            if (result < 0) {
+                break;
+            }
+            unsigned head = *cq_head_;
+            unsigned tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+            in_flight_ -= std::min(in_flight_, tail - head);
+            std::atomic_ref<unsigned>(*cq_head_).store(tail, std::memory_order_release);
+            drained = in_flight_ == 0;
+        }
+        if (!drained) {
+            // Can't tell when the kernel is done with the buffers, so they are never freed: a leak beats a write
+            // into freed memory
+            new std::vector<Slot>(std::move(slots_));
+        }
+        if (sqes_ != nullptr) {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_) {
+            ::munmap(cq_ptr_, cq_size_);
+        }
+        if (sq_ptr_ != nullptr) {
+            ::munmap(sq_ptr_, sq_size_);
+        }
+        ::close(ring_fd_);
+        ring_fd_ = -1;
+    }
+
+    void* map(std::size_t size, off_t offset) const {
+        void* ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+        if (ptr == MAP_FAILED) {
+            throw_errno(errno, "mmap io_uring");
+        }
+        return ptr;
+    }
+
+    // Queues a read of chunk `chunk` into `slot`, if the file has that chunk
+    void start(unsigned slot, std::size_t chunk) {
+        std::size_t offset = chunk * chunk_size_;
+        if (offset >= size_) {
+            return;
+        }
+        Slot& s = slots_[slot];
+        s.offset = offset;
+        s.expected = std::min(chunk_size_, size_ - offset);
+        s.filled = 0;
+        s.done = false;
+        submit(slot);
+    }
+
+    // Puts a read for the rest of the slot's chunk into the submission queue. The kernel only sees it after the
+    // release store of the tail, so the entry is fully written by then
+    void submit(unsigned slot) {
+        Slot& s = slots_[slot];
+        s.iov.iov_base = s.buffer.data() + s.filled;
+        s.iov.iov_len = s.expected - s.filled;
+        unsigned tail = *sq_tail_; // Only we write the tail
+        unsigned index = tail & sq_mask_;
+        io_uring_sqe& sqe = sqes_[index];
+        sqe = io_uring_sqe{};
+        sqe.opcode = IORING_OP_READV; // Since 5.1; IORING_OP_READ (no iovec) needs 5.6
+        sqe.fd = file_.fd();
+        sqe.addr = reinterpret_cast<std::uint64_t>(&s.iov);
+        sqe.len = 1;
+        sqe.off = s.offset + s.filled;
+        sqe.user_data = slot;
+        sq_array_[index] = index;
+        std::atomic_ref<unsigned>(*sq_tail_).store(tail + 1, std::memory_order_release);
+        pending_submissions_++;
+        in_flight_++;
+    }
+
+    // Submits what's queued, and with wait > 0 blocks until that many completions are there
+    void enter(unsigned to_submit, unsigned wait) {
+        if (to_submit == 0 && wait == 0) {
+            return;
+        }
+        long result;
+        do {
+            result = ::syscall(__NR_io_uring_enter, ring_fd_, to_submit, wait, wait > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        } while (result < 0 && errno == EINTR);
+        if (result < 0) {
+            throw_errno(errno, "io_uring_enter");
+        }
+        pending_submissions_ -= static_cast<unsigned>(result);
+    }
+
+    // Takes every completion off the queue. A short read (allowed, if rare) is resubmitted for the rest
+    void reap() {
+        unsigned head = *cq_head_; // Only we write the head
+        unsigned tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+        for (; head != tail; head++) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            Slot& s = slots_[cqe.user_data];
+            in_flight_--;
+            if (cqe.res < 0) {
+                std::atomic_ref<unsigned>(*cq_head_).store(head + 1, std::memory_order_release);
+                throw_errno(-cqe.res, "io_uring read");
+            }
+            s.filled += static_cast<std::size_t>(cqe.res);
+            if (cqe.res == 0) {
+                s.expected = s.filled; // The file got shorter
+            }
+            if (s.filled < s.expected) {
+                submit(static_cast<unsigned>(cqe.user_data));
+            } else {
+                s.done = true;
+            }
+        }
+        std::atomic_ref<unsigned>(*cq_head_).store(head, std::memory_order_release);
+    }
+
+    int ring_fd_ = -1;
+    void* sq_ptr_ = nullptr;
+    void* cq_ptr_ = nullptr;
+    std::size_t sq_size_ = 0;
+    std::size_t cq_size_ = 0;
+    std::size_t sqes_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned* sq_array_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+#endif
+
+    File file_;
+    std::size_t size_;
+    std::size_t chunk_size_;
+    std::vector<Slot> slots_;
+    std::size_t next_chunk_ = 0; // The chunk next() hands out next
+    int held_ = -1;              // Slot of the chunk the caller is working on
+    unsigned pending_submissions_ = 0;
+    unsigned in_flight_ = 0;
+    std::optional<PreadReader> fallback_;
+};
+
+} // namespace io
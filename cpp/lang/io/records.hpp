@@ -0,0 +1,154 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+// Splits what a reader from readers.hpp hands out into records (lines, by default), without allocating per record
+//
+//     io::MmapReader reader("log.csv");
+//     for (std::string_view line : io::Lines(reader)) { ... }
+//
+// Each record is a std::string_view into the reader's chunk, found with memchr (which checks 16-32 bytes per
+// instruction). Only a record split between two chunks gets copied - into one buffer that's reused for the next
+// split record, so after the first few chunks nothing is allocated at all. A view stays valid until the iterator
+// moves on. The delimiter isn't part of the record, a "\r" before it is dropped too (Windows line endings), and a
+// last record without a delimiter is still returned.
+
+namespace io {
+
+template <typename Reader>
+class Records {
+public:
+    explicit Records(Reader& reader, char delimiter = '\n') : reader_(reader), delimiter_(delimiter) {}
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+
+        iterator() = default;
+        explicit iterator(Records* records) : records_(records) { ++*this; }
+
+        reference operator*() const { return record_; }
+        pointer operator->() const { return &record_; }
+        iterator& operator++() {
+            if (!records_->next(record_)) {
+                records_ = nullptr;
+            }
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+        bool operator==(const iterator& other) const { return records_ == other.records_; }
+
+    private:
+        Records* records_ = nullptr;
+        std::string_view record_;
+    };
+
+    // A single pass over the reader: call begin() once
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+
+    // Moves to the next record; false at the end of the input
+    bool next(std::string_view& record) {
+        if (clear_carry_) {
+            carry_.clear(); // Keeps the capacity
+            clear_carry_ = false;
+        }
+        while (true) {
+            const char* end = chunk_.empty() ? nullptr
+                                             : static_cast<const char*>(std::memchr(chunk_.data(), delimiter_, chunk_.size()));
+            if (end != nullptr) {
+                std::string_view piece(chunk_.data(), static_cast<std::size_t>(end - chunk_.data()));
+                chunk_.remove_prefix(piece.size() + 1);
+                if (carry_.empty()) {
+                    record = trim(piece);
+                } else {
+                    carry_.append(piece);
+                    record = trim(carry_);
+                    clear_carry_ = true;
+                }
+                return true;
+            }
+            // The rest of the chunk is the start of a record that continues in the next chunk
+            carry_.append(chunk_);
+            chunk_ = reader_.next();
+            if (chunk_.empty()) {
+                if (carry_.empty()) {
+                    return false;
+                }
+                record = trim(carry_);
+                clear_carry_ = true;
+                return true;
+            }
+        }
+    }
+
+private:
+    std::string_view trim(std::string_view record) const {
+        if (delimiter_ == '\n' && !record.empty() && record.back() == '\r') {
+            record.remove_suffix(1);
+        }
+        return record;
+    }
+
+    Reader& reader_;
+    char delimiter_;
+    std::string_view chunk_;  // What's left of the current chunk
+    std::string carry_;       // A record split between chunks
+    bool clear_carry_ = false; // carry_ was handed out as a record, empty it before reusing it
+};
+
+template <typename Reader>
+class Lines : public Records<Reader> {
+public:
+    explicit Lines(Reader& reader) : Records<Reader>(reader, '\n') {}
+};
+
+// ## CSV
+// The fields of one record, split on `separator`. Like Records, it hands out views into the record. No quoting:
+// a field can't contain the separator, which is the case for numeric data
+class Fields {
+public:
+    explicit Fields(std::string_view record, char separator = ',') : rest_(record), separator_(separator) {}
+
+    // Moves to the next field; false after the last one
+    bool next(std::string_view& field) {
+        if (done_) {
+            return false;
+        }
+        std::size_t end = rest_.find(separator_);
+        if (end == std::string_view::npos) {
+            field = rest_;
+            done_ = true;
+        } else {
+            field = rest_.substr(0, end);
+            rest_.remove_prefix(end + 1);
+        }
+        return true;
+    }
+
+private:
+    std::string_view rest_;
+    char separator_;
+    bool done_ = false;
+};
+
+// std::from_chars: no locale, no exceptions, no allocation, no need for a terminating '\0' - the right tool for
+// parsing numbers out of a string_view. Returns false if the field isn't exactly one number
+template <typename T>
+bool parse(std::string_view field, T& value) {
+    const char* end = field.data() + field.size();
+    auto [ptr, error] = std::from_chars(field.data(), end, value);
+    return error == std::errc() && ptr == end;
+}
+
+} // namespace io
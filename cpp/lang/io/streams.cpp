@@ -0,0 +1,110 @@
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "readers.hpp"
+#include "records.hpp"
+
+namespace fs = std::filesystem;
+
+void streams(const fs::path& path) {
+    // ## Writing a file
+    // std::ofstream is an std::ostream like std::cout, so everything that can be printed can be written to a file.
+    // The stream buffers what we write and hands it to the OS in blocks, when the buffer is full or the stream is
+    // closed (here: destroyed at the end of the scope)
+    {
+        std::ofstream out(path);
+        out << "id,x,y\n";
+        for (int i = 0; i < 5; i++) {
+            out << i << ',' << i * 10 << ',' << -i << '\n';
+        }
+    }
+
+    // ## '\n' vs std::endl
+    // std::endl writes '\n' AND flushes the buffer - one write() syscall per line. Writing a million lines with
+    // std::endl is many times slower than with '\n'. Flush only when someone has to see the output now (a prompt,
+    // a progress message), std::cerr is never buffered anyway.
+    //
+    // std::ios::sync_with_stdio(false) goes one step further for std::cin/std::cout: by default they stay in sync
+    // with C's printf/scanf, which costs a lock and bypasses the buffer. Turn it off, at the start of main, in
+    // programs that read or print a lot - and then don't mix them with printf
+
+    // ## Reading line by line
+    // std::getline reads up to the next '\n' into a std::string. Reusing the same string keeps its memory, but
+    // every character still goes through the stream buffer one by one
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line); // Header
+    long long sum = 0;
+    while (std::getline(in, line)) {
+        // The classic way to split a line: a std::stringstream per line. Easy, and slow - the stream copies the
+        // line, every field is copied into a std::string (an allocation once it's too long for the small-string
+        // buffer), and std::stoll parses through strtoll, which checks the locale and errno on every call
+        std::stringstream fields(line);
+        std::string field;
+        while (std::getline(fields, field, ',')) {
+            sum += std::stoll(field);
+        }
+    }
+    std::cout << "sum with getline + stringstream: " << sum << std::endl;
+}
+
+void filesystem(const fs::path& path) {
+    // ## std::filesystem
+    // Paths, directories and file metadata, without platform-specific calls
+    std::cout << path.filename() << " in " << path.parent_path() << ": " << fs::file_size(path) << " bytes" << std::endl;
+    fs::path copy = path;
+    copy.replace_extension(".bak");
+    fs::copy_file(path, copy, fs::copy_options::overwrite_existing);
+    for (const fs::directory_entry& entry : fs::directory_iterator(path.parent_path())) {
+        if (entry.path().stem() == path.stem()) {
+            std::cout << "  " << entry.path().filename() << (entry.is_regular_file() ? " (file)" : "") << std::endl;
+        }
+    }
+    fs::remove(copy);
+
+    // Most functions have two versions: one that throws std::filesystem::filesystem_error, and one that takes an
+    // std::error_code. Use the second when failing is expected, like checking for a file that may not be there
+    std::error_code error;
+    std::uintmax_t size = fs::file_size(path.parent_path() / "does-not-exist", error);
+    std::cout << "file_size of a missing file: " << error.message() << " (returns " << static_cast<std::intmax_t>(size) << ")" << std::endl;
+}
+
+void fast_reading(const fs::path& path) {
+    // ## Reading without iostreams
+    // For big files, the reader classes from readers.hpp get the data into memory with mmap, pread or io_uring,
+    // and io::Lines (records.hpp) cuts it into std::string_views without copying or allocating. Numbers are parsed
+    // with std::from_chars. io_benchmark.cpp has the numbers: about 10x faster than getline + stringstream for CSV
+    io::MmapReader reader(path.string());
+    long long sum = 0;
+    bool header = true;
+    for (std::string_view line : io::Lines(reader)) {
+        if (header) {
+            header = false;
+            continue;
+        }
+        io::Fields fields(line);
+        std::int64_t value;
+        for (std::string_view field; fields.next(field);) {
+            if (io::parse(field, value)) {
+                sum += value;
+            }
+        }
+    }
+    std::cout << "sum with mmap + Lines + from_chars: " << sum << std::endl;
+
+    io::UringReader uring(path.string());
+    std::cout << "io_uring " << (uring.uring() ? "available" : "not available, reading with pread") << std::endl;
+}
+
+int main() {
+    fs::path path = fs::temp_directory_path() / "streams_tutorial.csv";
+    streams(path);
+    filesystem(path);
+    fast_reading(path);
+    fs::remove(path);
+}
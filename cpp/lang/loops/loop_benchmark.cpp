@@ -0,0 +1,244 @@
+// Loops, measured: sum reductions with one accumulator, unrolled, and with several accumulators (reductions.hpp),
+// then an element-wise loop run as a plain for loop, through std::for_each with every execution policy, and
+// hand-threaded (parallel.hpp). Next to the times it reports instructions per cycle and mispredicted branches per
+// element from the hardware counters (perf_counters.hpp).
+//
+// std::execution::par and par_unseq only run in parallel when the standard library has a thread pool to use:
+// libstdc++ uses TBB, so link with -ltbb. Without TBB, compile with -D_GLIBCXX_USE_TBB_PAR_BACKEND=0 and they run
+// on the calling thread. The "unseq" part is `#pragma omp simd`, which needs -fopenmp-simd (no OpenMP runtime).
+//
+// Build: g++ -std=c++20 -O2 -fopenmp-simd -pthread loop_benchmark.cpp -o loop_benchmark -ltbb
+// Usage: ./loop_benchmark [reduction elements = 4096] [parallel elements = 16777216] [threads = hardware threads]
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <execution>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../testing/measure.hpp"
+#include "../../testing/perf_counters.hpp"
+#include "../../testing/report.hpp"
+#include "parallel.hpp"
+#include "reductions.hpp"
+
+using bench::fail;
+using bench::format;
+using bench::measure;
+using bench::Measurement;
+using bench::PerfCounters;
+
+#if defined(_PSTL_PAR_BACKEND_TBB)
+constexpr bool parallel_policies = true;
+#else
+constexpr bool parallel_policies = false;
+#endif
+
+void print_header(const std::string& what, const std::string& second) {
+    std::cout << "| " << std::setw(28) << std::left << what << " | " << std::setw(7) << second << std::right
+              << " | ns/element | G elements/s | IPC  | Misses/element |\n";
+    std::cout << "|------------------------------|---------|------------|--------------|------|----------------|\n";
+}
+
+void print_row(const std::string& name, const std::string& second, Measurement result) {
+    std::cout << "| " << std::setw(28) << std::left << name << " | " << std::setw(7) << second << std::right << " | "
+              << std::setw(10) << format(result.ns, 3) << " | " << std::setw(12) << format(1 / result.ns, 2) << " | "
+              << std::setw(4) << format(result.ipc, 2) << " | " << std::setw(14) << format(result.branch_misses, 4) << " |\n";
+}
+
+// ## Reductions
+// Through function pointers, so the compiler can't move a sum it has proven to be the same out of the timing loop
+template <typename T>
+struct Reduction {
+    const char* name;
+    T (*sum)(const T*, std::size_t);
+};
+
+template <typename T>
+T accumulate(const T* data, std::size_t n) {
+    return std::accumulate(data, data + n, T{0});
+}
+
+// Allowed to add in any order, like the accumulators
+template <typename T>
+T reduce_unseq(const T* data, std::size_t n) {
+    return std::reduce(std::execution::unseq, data, data + n, T{0});
+}
+
+template <typename T>
+void reductions(PerfCounters& counters, const char* type, std::size_t n) {
+    // Small integers, so that a double sum is exact whatever the order and every version must agree exactly
+    std::vector<T> values(n);
+    for (std::size_t i = 0; i < n; i++) {
+        values[i] = static_cast<T>((i * 7919) % 1000);
+    }
+    const Reduction<T> kernels[] = {
+        {"simple", loops::sum_simple<T>},
+        {"std::accumulate", accumulate<T>},
+        {"unrolled x4, 1 accumulator", loops::sum_unrolled<T>},
+        {"2 accumulators", loops::sum_accumulators<2, T>},
+        {"4 accumulators", loops::sum_accumulators<4, T>},
+        {"8 accumulators", loops::sum_accumulators<8, T>},
+        {"std::reduce(unseq)", reduce_unseq<T>},
+    };
+    T expected = loops::sum_simple(values.data(), n);
+    // Enough sums per run that the clock's overhead doesn't count
+    std::size_t repetitions = std::max<std::size_t>(1, (1 << 20) / std::max<std::size_t>(n, 1));
+    for (const Reduction<T>& kernel : kernels) {
+        T result = 0;
+        Measurement timing = measure(counters, static_cast<double>(n * repetitions), [&] {
+            for (std::size_t r = 0; r < repetitions; r++) {
+                result = kernel.sum(values.data(), n);
+            }
+        });
+        if (result != expected) {
+            fail(std::string(kernel.name) + " summed " + type + "s to " + std::to_string(result) + ", expected " +
+                 std::to_string(expected));
+        }
+        print_row(kernel.name, type, timing);
+        bench::report(std::string("Sum of ") + type + "s: " + kernel.name, timing.ns, "ns");
+    }
+}
+
+// ## Element-wise loops
+// a * x + b reads 8 bytes and writes 8 per element and does almost nothing with them: once x and y are bigger than
+// the caches it's limited by memory bandwidth. The polynomial (Horner's method, degree 16) is 32 floating-point
+// operations per element: limited by the cores
+double light(double x) {
+    return 1.5 * x + 0.25;
+}
+
+double heavy(double x) {
+    double y = 1.0;
+    for (int k = 0; k < 16; k++) {
+        y = y * x + 1.0 / (k + 2);
+    }
+    return y;
+}
+
+template <typename F>
+void run_for(std::vector<double>& y, const std::vector<double>& x, F f) {
+    for (std::size_t i = 0; i < y.size(); i++) {
+        y[i] = f(x[i]);
+    }
+}
+
+// for_each hands out elements, not indices: the index is the element's distance from the start of y
+template <typename Policy, typename F>
+void run_for_each(Policy&& policy, std::vector<double>& y, const std::vector<double>& x, F f) {
+    const double* in = x.data();
+    double* out = y.data();
+    std::for_each(policy, y.begin(), y.end(), [=](double& element) { element = f(in[&element - out]); });
+}
+
+template <typename F>
+void run_threaded(std::vector<double>& y, const std::vector<double>& x, unsigned threads, F f) {
+    loops::parallel_for(y.size(), threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            y[i] = f(x[i]);
+        }
+    });
+}
+
+// The same, with each thread's range vectorized like the unseq policies do it
+template <typename F>
+void run_threaded_simd(std::vector<double>& y, const std::vector<double>& x, unsigned threads, F f) {
+    loops::parallel_for(y.size(), threads, [&](std::size_t begin, std::size_t end) {
+        const double* in = x.data();
+        double* out = y.data();
+#pragma omp simd
+        for (std::size_t i = begin; i < end; i++) {
+            out[i] = f(in[i]);
+        }
+    });
+}
+
+template <typename F>
+void element_wise(PerfCounters& counters, const char* name, F f, std::size_t n, unsigned threads) {
+    std::vector<double> x(n);
+    for (std::size_t i = 0; i < n; i++) {
+        x[i] = static_cast<double>(i % 1000) / 1000;
+    }
+    std::vector<double> expected(n);
+    std::vector<double> y(n);
+    run_for(expected, x, f);
+
+    // Vectorized code may contract a * x + b into one fused multiply-add, which rounds once instead of twice
+    auto check = [&](const std::string& loop) {
+        for (std::size_t i = 0; i < n; i++) {
+            if (std::abs(y[i] - expected[i]) > 1e-12 * std::abs(expected[i]) + 1e-15) {
+                fail(loop + " on " + name + ": element " + std::to_string(i) + " is " + std::to_string(y[i]) +
+                     ", expected " + std::to_string(expected[i]));
+            }
+        }
+        std::fill(y.begin(), y.end(), -1.0);
+    };
+
+    std::string pool = parallel_policies ? std::to_string(std::max(1u, std::thread::hardware_concurrency())) : "1";
+    std::string hand = std::to_string(threads);
+    double elements = static_cast<double>(n);
+    // TBB's worker threads never exit, so their counts never reach this process's counters - for the par rows they'd
+    // be the calling thread's alone, which mostly waits. The hand-threaded rows join their threads, which are counted
+    auto pooled = [](Measurement result) {
+        if (parallel_policies) {
+            result.ipc = -1;
+            result.branch_misses = -1;
+        }
+        return result;
+    };
+    auto print = [&](const std::string& loop, const std::string& used_threads, Measurement result) {
+        print_row(loop, used_threads, result);
+        bench::report(std::string(name) + ": " + loop, result.ns, "ns");
+    };
+    std::cout << "\n## " << name << ", " << n << " doubles\n\n";
+    print_header("Loop", "Threads");
+    print("for loop", "1", measure(counters, elements, [&] { run_for(y, x, f); }));
+    check("for loop");
+    print("for_each(seq)", "1", measure(counters, elements, [&] { run_for_each(std::execution::seq, y, x, f); }));
+    check("for_each(seq)");
+    print("for_each(unseq)", "1", measure(counters, elements, [&] { run_for_each(std::execution::unseq, y, x, f); }));
+    check("for_each(unseq)");
+    print("for_each(par)", pool, pooled(measure(counters, elements, [&] { run_for_each(std::execution::par, y, x, f); })));
+    check("for_each(par)");
+    print("for_each(par_unseq)", pool,
+          pooled(measure(counters, elements, [&] { run_for_each(std::execution::par_unseq, y, x, f); })));
+    check("for_each(par_unseq)");
+    print("hand-threaded", hand, measure(counters, elements, [&] { run_threaded(y, x, threads, f); }));
+    check("hand-threaded");
+    print("hand-threaded, omp simd", hand, measure(counters, elements, [&] { run_threaded_simd(y, x, threads, f); }));
+    check("hand-threaded, omp simd");
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t reduction_elements = argc > 1 ? std::stoul(argv[1]) : 4096;
+    std::size_t parallel_elements = argc > 2 ? std::stoul(argv[2]) : 16777216;
+    unsigned threads = argc > 3 ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+
+    PerfCounters counters;
+    if (!counters.any_available()) {
+        std::cout << "IPC, misses: n/a, hardware counters unavailable (" << counters.error() << ")\n";
+    }
+    if (parallel_policies) {
+        std::cout << "Parallel policies: TBB, hardware threads: " << std::max(1u, std::thread::hardware_concurrency())
+                  << ". IPC and misses of the par rows: n/a, the counters don't see TBB's threads\n\n";
+    } else {
+        std::cout << "Parallel policies: no backend, they run on the calling thread\n\n";
+    }
+
+    std::cout << "## Sum of " << reduction_elements << " elements (" << reduction_elements * 8 / 1024 << " KiB)\n\n";
+    print_header("Reduction", "Type");
+    reductions<std::int64_t>(counters, "int64", reduction_elements);
+    reductions<double>(counters, "double", reduction_elements);
+
+    // Lambdas, not function pointers, so every loop gets the workload inlined
+    element_wise(counters, "y = 1.5x + 0.25", [](double x) { return light(x); }, parallel_elements, threads);
+    element_wise(counters, "Polynomial of degree 16", [](double x) { return heavy(x); }, parallel_elements, threads);
+    std::cout << "\nG elements/s: billions of elements per second; with several threads, over all of them" << std::endl;
+}
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "reductions.hpp"
+
+// # Loops
+// Every loop repeats its body while a condition is true. They differ in where the condition is checked and in
+// how much bookkeeping they do for you.
+
+// ## `while`
+// Checks the condition before every pass, so the body may not run at all. For loops where the number of passes
+// isn't known up front
+void while_loop() {
+    int n = 27;
+    int steps = 0;
+    while (n != 1) {
+        n = n % 2 == 0 ? n / 2 : 3 * n + 1;
+        steps++;
+    }
+    std::cout << "27 reaches 1 after " << steps << " Collatz steps" << std::endl;
+}
+
+// ## `do..while`
+// Checks the condition after every pass: the body runs at least once. Typical for "try, then check whether to
+// try again"
+void do_while_loop() {
+    unsigned value = 1234;
+    int digits = 0;
+    do {
+        value /= 10;
+        digits++;
+    } while (value != 0); // 0 has one digit too, which a while loop would miss
+    std::cout << "1234 has " << digits << " digits" << std::endl;
+}
+
+// ## `for`
+// Initialization, condition and step in one line. The counter only exists inside the loop. std::size_t is the
+// type of sizes and indices: comparing an int with v.size() mixes signed and unsigned
+void for_loop() {
+    std::vector<int> squares(5);
+    for (std::size_t i = 0; i < squares.size(); i++) {
+        squares[i] = static_cast<int>(i * i);
+    }
+    // Counting down with an unsigned counter: i >= 0 is always true, so test before decrementing instead
+    for (std::size_t i = squares.size(); i-- > 0;) {
+        std::cout << squares[i] << (i > 0 ? " " : "\n");
+    }
+}
+
+// ## Range-based `for` (for each)
+// For every element of anything with begin() and end(): arrays, containers, strings, std::span... A reference
+// avoids copying each element and allows changing it; const& for reading only. Structured bindings (C++17) unpack
+// pairs and structs
+void for_each_loop() {
+    std::vector<std::string> names = {"ada", "grace", "linus"};
+    for (std::string& name : names) {
+        name[0] = static_cast<char>(name[0] - 'a' + 'A');
+    }
+    std::map<std::string, int> ages = {{"Ada", 36}, {"Grace", 85}};
+    for (const auto& [name, age] : ages) {
+        std::cout << name << " " << age << ", ";
+    }
+    std::cout << names.back() << std::endl;
+
+    // The algorithms in <algorithm> are loops with a name: std::for_each, std::count_if, std::find_if...
+    // They say what the loop is for, and take an execution policy to run in parallel (see loop_benchmark.cpp)
+    std::for_each(names.begin(), names.end(), [](const std::string& name) { std::cout << name.size() << " "; });
+    std::cout << std::endl;
+}
+
+// ## Loop control
+// `continue` skips to the next pass, `break` leaves the innermost loop. Leaving several nested loops at once is
+// easiest from a function of their own, with `return`
+int find_in_grid(const std::vector<std::vector<int>>& grid, int value) {
+    for (std::size_t row = 0; row < grid.size(); row++) {
+        for (std::size_t column = 0; column < grid[row].size(); column++) {
+            if (grid[row][column] == value) {
+                return static_cast<int>(row * 10 + column);
+            }
+        }
+    }
+    return -1;
+}
+
+void loop_control() {
+    int sum = 0;
+    for (int i = 0; i < 100; i++) {
+        if (i % 3 != 0) {
+            continue;
+        }
+        if (i > 20) {
+            break;
+        }
+        sum += i;
+    }
+    std::cout << "multiples of 3 up to 20 add up to " << sum << ", 5 is at " << find_in_grid({{1, 2}, {4, 5}}, 5) << std::endl;
+}
+
+// ## Loops and speed
+// A loop that adds into one variable can't go faster than one addition after the other. Splitting the sum over
+// several accumulators lets the CPU work on all of them at once (reductions.hpp, measured in loop_benchmark.cpp)
+void reductions() {
+    std::vector<double> values(1000);
+    for (std::size_t i = 0; i < values.size(); i++) {
+        values[i] = static_cast<double>(i);
+    }
+    std::cout << "sum: " << loops::sum_simple(values.data(), values.size()) << ", with 4 accumulators: "
+              << loops::sum_accumulators<4>(values.data(), values.size()) << std::endl;
+}
+
+int main() {
+    while_loop();
+    do_while_loop();
+    for_loop();
+    for_each_loop();
+    loop_control();
+    reductions();
+}
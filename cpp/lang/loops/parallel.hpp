@@ -0,0 +1,36 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Hand-threaded loops: the alternative to the parallel execution policies of <algorithm> (std::execution::par,
+// par_unseq), which depend on the standard library having a thread pool behind them - libstdc++ needs TBB for
+// that and runs them on the calling thread otherwise.
+//
+//     loops::parallel_for(n, threads, [&](std::size_t begin, std::size_t end) {
+//         for (std::size_t i = begin; i < end; i++) { y[i] = a * x[i] + b; }
+//     });
+
+namespace loops {
+
+// Calls body(begin, end) for `threads` equal ranges of [0, n), one per thread, the first on the calling thread.
+// Threads are started per call (about 20 us each), so the loop should take milliseconds, not microseconds. Equal
+// ranges suit loops where every element costs the same; uneven work needs smaller pieces handed out as threads
+// become free - what TBB does for std::execution::par
+template <typename F>
+void parallel_for(std::size_t n, unsigned threads, F&& body) {
+    threads = static_cast<unsigned>(std::clamp<std::size_t>(threads, 1, std::max<std::size_t>(n, 1)));
+    auto begin = [&](unsigned t) { return n / threads * t + std::min<std::size_t>(t, n % threads); };
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; t++) {
+        workers.emplace_back([&, t] { body(begin(t), begin(t + 1)); });
+    }
+    body(0, begin(1));
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+} // namespace loops
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+
+// Reductions: one value out of a whole array, here the sum
+//
+// A sum loop is one long dependency chain: every addition needs the result of the one before it. The loop can't
+// go faster than one element per addition latency - 1 cycle for integers, 3-4 for doubles - no matter how many
+// adders the core has (2-4 today). Unrolling alone doesn't change that, it only saves loop overhead. Several
+// accumulators do: element i goes to accumulator i % N, the N chains are independent, and the core works on all
+// of them at once. They are also what the compiler's SLP vectorizer packs into one SIMD register.
+//
+// The compiler won't do this to floating-point code by itself (without -ffast-math), because it changes the order
+// of the additions and so the rounding: the result can differ in the last bits. For integers, the order doesn't
+// matter.
+//
+//     double total = loops::sum_accumulators<4>(values.data(), values.size());
+
+namespace loops {
+
+template <typename T>
+T sum_simple(const T* data, std::size_t n) {
+    T sum = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+// Four elements per iteration, still one accumulator: a quarter of the loop counter updates and exit checks,
+// the same chain of additions
+template <typename T>
+T sum_unrolled(const T* data, std::size_t n) {
+    T sum = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        sum += data[i];
+        sum += data[i + 1];
+        sum += data[i + 2];
+        sum += data[i + 3];
+    }
+    for (; i < n; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+// `Accumulators` independent sums, which keep that many additions in flight at once. Enough of them to cover
+// latency x adders (4 x 2 = 8 for doubles on most x86 cores) is the sweet spot; more only adds register pressure
+template <std::size_t Accumulators, typename T>
+T sum_accumulators(const T* data, std::size_t n) {
+    static_assert(Accumulators > 0 && Accumulators <= 16, "Between 1 and 16 accumulators");
+    T sums[Accumulators] = {};
+    std::size_t i = 0;
+    for (; i + Accumulators <= n; i += Accumulators) {
+        // Fully unrolled, so every sums[k] lives in a register of its own
+#pragma GCC unroll 16
+        for (std::size_t k = 0; k < Accumulators; k++) {
+            sums[k] += data[i + k];
+        }
+    }
+    for (; i < n; i++) {
+        sums[0] += data[i];
+    }
+    T sum = 0;
+    for (T s : sums) {
+        sum += s;
+    }
+    return sum;
+}
+
+} // namespace loops
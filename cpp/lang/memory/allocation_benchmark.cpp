@@ -0,0 +1,514 @@
+// Compares the general purpose allocator (new/delete, malloc/free) with the custom allocators from arena.hpp
+// for lots of short-lived small objects, then measures fragmentation: how much memory stays resident when
+// short-lived and long-lived objects of mixed sizes are allocated side by side (Linux only).
+//
+// Build: g++ -std=c++20 -O2 -pthread allocation_benchmark.cpp -o allocation_benchmark
+// Usage: ./allocation_benchmark [objects per thread = 4000000] [max threads = hardware threads]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory_resource>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "../../testing/report.hpp"
+#include "arena.hpp"
+
+// ## Counting allocations
+// Replacing the global operator new lets us count every allocation made by the program (including the ones
+// made by std containers). The counter is thread local, so counting doesn't add any contention of its own.
+thread_local std::size_t allocator_calls = 0;
+
+void* operator new(std::size_t size) {
+    ++allocator_calls;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+// std::pmr::new_delete_resource() always passes the alignment, so the aligned overloads have to be counted too
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    ++allocator_calls;
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (void* ptr = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+// A typical small object: 32 bytes
+struct Small {
+    std::uint64_t id;
+    std::uint64_t a;
+    std::uint64_t b;
+    std::uint64_t c;
+};
+
+constexpr std::size_t batch_size = 1024; // Objects alive at the same time, e.g. created while handling one request
+
+struct Result {
+    std::size_t allocator_calls = 0; // Calls into the general purpose allocator (new + malloc)
+    std::uint64_t checksum = 0;      // Keeps the compiler from optimizing the work away
+};
+
+// The order objects are freed in. Shuffled, so the general purpose allocator can't just free in LIFO order
+std::vector<std::size_t> free_order() {
+    std::vector<std::size_t> order(batch_size);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+    return order;
+}
+
+// ## Workloads
+// Each one creates `objects` Small objects in batches of batch_size, touches them, and frees the whole batch
+Result run_new_delete(std::size_t objects) {
+    Result result;
+    std::vector<std::size_t> order = free_order();
+    std::vector<Small*> batch(batch_size);
+    allocator_calls = 0;
+    for (std::size_t done = 0; done < objects; done += batch_size) {
+        for (std::size_t i = 0; i < batch_size; i++) {
+            batch[i] = new Small{done + i, i, i, i};
+        }
+        for (std::size_t i : order) {
+            result.checksum += batch[i]->id;
+            delete batch[i];
+        }
+    }
+    result.allocator_calls = allocator_calls;
+    return result;
+}
+
+Result run_malloc_free(std::size_t objects) {
+    Result result;
+    std::vector<std::size_t> order = free_order();
+    std::vector<Small*> batch(batch_size);
+    for (std::size_t done = 0; done < objects; done += batch_size) {
+        for (std::size_t i = 0; i < batch_size; i++) {
+            batch[i] = static_cast<Small*>(std::malloc(sizeof(Small)));
+            *batch[i] = Small{done + i, i, i, i};
+            ++result.allocator_calls;
+        }
+        for (std::size_t i : order) {
+            result.checksum += batch[i]->id;
+            std::free(batch[i]);
+        }
+    }
+    return result;
+}
+
+Result run_arena(std::size_t objects) {
+    Result result;
+    allocator_calls = 0;
+    memory::Arena arena;
+    std::vector<Small*> batch(batch_size);
+    for (std::size_t done = 0; done < objects; done += batch_size) {
+        for (std::size_t i = 0; i < batch_size; i++) {
+            batch[i] = arena.create<Small>(Small{done + i, i, i, i});
+        }
+        for (Small* small : batch) {
+            result.checksum += small->id;
+        }
+        arena.reset(); // Frees the whole batch at once
+    }
+    result.allocator_calls = allocator_calls + arena.system_allocations();
+    return result;
+}
+
+Result run_pool(std::size_t objects) {
+    Result result;
+    allocator_calls = 0;
+    std::vector<std::size_t> order = free_order();
+    memory::Pool pool(sizeof(Small), batch_size);
+    std::vector<Small*> batch(batch_size);
+    for (std::size_t done = 0; done < objects; done += batch_size) {
+        for (std::size_t i = 0; i < batch_size; i++) {
+            batch[i] = pool.create<Small>(Small{done + i, i, i, i});
+        }
+        for (std::size_t i : order) {
+            result.checksum += batch[i]->id;
+            pool.destroy(batch[i]);
+        }
+    }
+    result.allocator_calls = allocator_calls + pool.system_allocations();
+    return result;
+}
+
+// std::pmr::list allocates one node per element - a good stand-in for any node based container
+Result run_pmr_list(std::size_t objects, std::pmr::memory_resource* resource) {
+    Result result;
+    allocator_calls = 0;
+    for (std::size_t done = 0; done < objects; done += batch_size) {
+        std::pmr::list<Small> list(resource);
+        for (std::size_t i = 0; i < batch_size; i++) {
+            list.push_back(Small{done + i, i, i, i});
+        }
+        for (const Small& small : list) {
+            result.checksum += small.id;
+        }
+    }
+    result.allocator_calls = allocator_calls;
+    return result;
+}
+
+Result run_list_default(std::size_t objects) {
+    return run_pmr_list(objects, std::pmr::new_delete_resource());
+}
+
+Result run_list_arena(std::size_t objects) {
+    memory::Arena arena;
+    memory::ArenaResource resource(arena);
+    Result result;
+    // One arena per batch would be the typical use, here we reset it between batches instead
+    for (std::size_t done = 0; done < objects; done += batch_size) {
+        Result batch = run_pmr_list(batch_size, &resource);
+        result.checksum += batch.checksum;
+        result.allocator_calls += batch.allocator_calls;
+        arena.reset();
+    }
+    result.allocator_calls += arena.system_allocations();
+    return result;
+}
+
+Result run_list_pool(std::size_t objects) {
+    // Node size is implementation defined, two pointers + the value is a safe upper bound
+    memory::Pool pool(sizeof(Small) + 2 * sizeof(void*), batch_size);
+    memory::PoolResource resource(pool);
+    Result result = run_pmr_list(objects, &resource);
+    result.allocator_calls += pool.system_allocations();
+    return result;
+}
+
+Result run_list_std_pool(std::size_t objects) {
+    std::pmr::unsynchronized_pool_resource resource;
+    return run_pmr_list(objects, &resource);
+}
+
+// ## Harness
+struct Benchmark {
+    std::string name;
+    Result (*run)(std::size_t objects);
+};
+
+// Runs the benchmark on `threads` threads at once, each with its own allocator, and reports wall time
+void measure(const Benchmark& benchmark, std::size_t objects, unsigned threads) {
+    std::vector<Result> results(threads);
+    std::vector<std::thread> workers;
+    std::atomic<bool> start{false};
+
+    for (unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            while (!start.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            results[t] = benchmark.run(objects);
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::size_t calls = 0;
+    std::uint64_t checksum = 0;
+    for (const Result& result : results) {
+        calls += result.allocator_calls;
+        checksum += result.checksum;
+    }
+    double total = static_cast<double>(objects) * threads;
+
+    std::cout << "| " << std::setw(24) << std::left << benchmark.name
+              << " | " << std::setw(7) << std::right << threads
+              << " | " << std::setw(9) << std::fixed << std::setprecision(1) << seconds * 1e3
+              << " | " << std::setw(10) << std::setprecision(2) << seconds * 1e9 / total * threads
+              << " | " << std::setw(12) << calls
+              << " | " << std::setw(15) << std::setprecision(4) << calls / total
+              << " |" << (checksum == 0 ? " (empty)" : "") << '\n';
+    std::string row = benchmark.name + ", " + std::to_string(threads) + (threads == 1 ? " thread" : " threads");
+    bench::report(row + ": ns/object", seconds * 1e9 / total * threads, "ns");
+    bench::report(row + ": calls per object", calls / total, "calls");
+}
+
+// ## Fragmentation
+// A request handler allocates scratch buffers of any size that die with the request, and now and then a record
+// that outlives it (a cache entry, a session). From one general purpose heap, every surviving record pins the
+// page it landed on, between the scratch buffers' holes: the heap can't give those pages back, so resident memory
+// stays far above the live data. Giving each lifetime its own allocator - an arena per request, a pool for the
+// records - keeps the survivors packed together and lets the scratch memory go as a whole.
+#if defined(__linux__)
+struct Record {
+    std::uint64_t key;
+    std::uint64_t values[7];
+};
+
+constexpr std::size_t churn_rounds = 64;   // Requests
+constexpr std::size_t record_every = 32;   // One long-lived Record per 32 scratch buffers
+constexpr std::size_t min_scratch = 16;    // Scratch buffers are 16 to 512 bytes
+constexpr std::size_t max_scratch = 512;
+
+// Everything from malloc/free
+struct MallocOnly {
+    void* scratch(std::size_t size) { return std::malloc(size); }
+    void end_round(std::vector<std::pair<void*, std::size_t>>& round) {
+        for (auto [ptr, size] : round) {
+            std::free(ptr);
+        }
+    }
+    Record* record() { return static_cast<Record*>(std::malloc(sizeof(Record))); }
+    void finish() {}
+};
+
+// Scratch from an arena that's reset after every round, records from malloc
+struct ArenaMalloc {
+    std::optional<memory::Arena> arena{std::in_place, 1 << 20};
+    void* scratch(std::size_t size) { return arena->allocate(size); }
+    void end_round(std::vector<std::pair<void*, std::size_t>>&) { arena->reset(); }
+    Record* record() { return static_cast<Record*>(std::malloc(sizeof(Record))); }
+    void finish() { arena.reset(); } // Gives the arena's blocks back
+};
+
+// Scratch from an arena, records from a pool
+struct ArenaPool {
+    std::optional<memory::Arena> arena{std::in_place, 1 << 20};
+    memory::Pool pool{sizeof(Record), 1024};
+    void* scratch(std::size_t size) { return arena->allocate(size); }
+    void end_round(std::vector<std::pair<void*, std::size_t>>&) { arena->reset(); }
+    Record* record() { return pool.create<Record>(); }
+    void finish() { arena.reset(); }
+};
+
+struct Footprint {
+    std::size_t live_peak = 0; // Bytes the program had allocated and not freed, at its highest
+    std::size_t rss_peak = 0;  // Resident memory at the same points, at its highest
+    std::size_t live_end = 0;  // After the last round: the records only
+    std::size_t rss_end = 0;
+};
+
+std::size_t resident_bytes() {
+    std::ifstream statm("/proc/self/statm");
+    std::size_t pages = 0;
+    std::size_t resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+// Resident memory gained since `start` (zero if the process shrank)
+std::size_t resident_growth(std::size_t start) {
+    std::size_t now = resident_bytes();
+    return now > start ? now - start : 0;
+}
+
+// `objects` scratch buffers over churn_rounds rounds, one Record per record_every of them. Resident memory is
+// counted from the start of the run, so memory the process already had doesn't count
+template <typename Strategy>
+Footprint churn(std::size_t objects) {
+    Strategy strategy;
+    std::size_t start = resident_bytes();
+    std::size_t per_round = std::max<std::size_t>(objects / churn_rounds, 1);
+    std::mt19937 random(7);
+    std::vector<std::pair<void*, std::size_t>> round;
+    std::vector<Record*> records;
+    std::size_t live = 0;
+    Footprint footprint;
+    for (std::size_t r = 0; r < churn_rounds; r++) {
+        for (std::size_t i = 0; i < per_round; i++) {
+            std::size_t size = min_scratch + random() % (max_scratch - min_scratch + 1);
+            void* buffer = strategy.scratch(size);
+            std::memset(buffer, 0xab, size);
+            round.emplace_back(buffer, size);
+            live += size;
+            if (i % record_every == 0) {
+                Record* record = strategy.record();
+                *record = Record{r * per_round + i, {}};
+                records.push_back(record);
+                live += sizeof(Record);
+            }
+        }
+        footprint.live_peak = std::max(footprint.live_peak, live);
+        footprint.rss_peak = std::max(footprint.rss_peak, resident_growth(start));
+        strategy.end_round(round);
+        for (const auto& buffer : round) {
+            live -= buffer.second;
+        }
+        round.clear();
+    }
+    strategy.finish();
+#if defined(__GLIBC__)
+    malloc_trim(0); // Returns every whole free page, also the ones in the middle of the heap
+#endif
+    footprint.live_end = live;
+    footprint.rss_end = resident_growth(start);
+    return footprint;
+}
+
+// Every strategy runs in a child process of its own, so it starts from a fresh heap and its resident memory
+// isn't mixed up with the other runs'
+Footprint in_child(Footprint (*run)(std::size_t), std::size_t objects) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        std::cerr << "ERROR: pipe failed" << std::endl;
+        std::exit(1);
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        Footprint footprint = run(objects);
+        bool written = write(fds[1], &footprint, sizeof(footprint)) == static_cast<ssize_t>(sizeof(footprint));
+        _exit(written ? 0 : 1);
+    }
+    close(fds[1]);
+    Footprint footprint;
+    bool received = pid > 0 && read(fds[0], &footprint, sizeof(footprint)) == static_cast<ssize_t>(sizeof(footprint));
+    close(fds[0]);
+    int status = 0;
+    if (pid > 0) {
+        waitpid(pid, &status, 0);
+    }
+    if (!received || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::cerr << "ERROR: the fragmentation run in a child process failed" << std::endl;
+        std::exit(1);
+    }
+    return footprint;
+}
+
+void fragmentation(std::size_t objects) {
+    struct Strategy {
+        const char* name;
+        Footprint (*run)(std::size_t);
+    };
+    const Strategy strategies[] = {
+        {"malloc/free", churn<MallocOnly>},
+        {"Arena + malloc", churn<ArenaMalloc>},
+        {"Arena + Pool", churn<ArenaPool>},
+    };
+    constexpr double mib = 1024.0 * 1024.0;
+    std::cout << "\n## Fragmentation: " << objects << " scratch buffers of " << min_scratch << "-" << max_scratch
+              << " bytes in " << churn_rounds << " rounds, one " << sizeof(Record) << "-byte record per " << record_every
+              << " kept to the end\n\n";
+    std::cout << "| Scratch + records        | Peak live MiB | Peak RSS MiB | Live at end MiB | RSS at end MiB | RSS / live at end |\n";
+    std::cout << "|--------------------------|---------------|--------------|-----------------|----------------|-------------------|\n";
+    for (const Strategy& strategy : strategies) {
+        Footprint f = in_child(strategy.run, objects);
+        double ratio = static_cast<double>(f.rss_end) / std::max<std::size_t>(f.live_end, 1);
+        std::cout << "| " << std::setw(24) << std::left << strategy.name << std::right << std::fixed << std::setprecision(2)
+                  << " | " << std::setw(13) << f.live_peak / mib << " | " << std::setw(12) << f.rss_peak / mib
+                  << " | " << std::setw(15) << f.live_end / mib << " | " << std::setw(14) << f.rss_end / mib
+                  << " | " << std::setw(17) << ratio << " |\n";
+        bench::report(std::string("Fragmentation, ") + strategy.name + ": RSS / live at end", ratio, "x");
+    }
+    std::cout << "\nRSS is resident memory grown since the run started, read from /proc/self/statm after each round and, "
+                 "at the end, after malloc_trim" << std::endl;
+}
+#else
+void fragmentation(std::size_t) {
+    std::cout << "\n## Fragmentation\n\nNeeds Linux (/proc/self/statm and fork)" << std::endl;
+}
+#endif
+
+// ## Checks
+// The pools hand out slots one after the other, so a slot size that isn't a multiple of the alignment shows up as
+// misaligned addresses. Vec3 is the natural case: 12 bytes, 4-aligned, smaller than the free list's pointer needs
+struct Vec3 {
+    float x, y, z;
+};
+
+void fail(const std::string& what) {
+    std::cerr << "ERROR: " << what << std::endl;
+    std::exit(1);
+}
+
+void verify() {
+    memory::Pool pool(sizeof(Vec3), 16, alignof(Vec3));
+    if (pool.slot_size() % alignof(void*) != 0 || pool.alignment() < alignof(void*)) {
+        fail("Pool(sizeof(Vec3), 16, alignof(Vec3)): " + std::to_string(pool.slot_size()) + "-byte slots, aligned to " +
+             std::to_string(pool.alignment()));
+    }
+    std::vector<Vec3*> vectors;
+    for (int i = 0; i < 40; i++) { // More than one chunk
+        Vec3* v = pool.create<Vec3>(Vec3{float(i), float(i), float(i)});
+        if (reinterpret_cast<std::uintptr_t>(v) % pool.alignment() != 0) {
+            fail("Pool: slot " + std::to_string(i) + " isn't aligned to " + std::to_string(pool.alignment()));
+        }
+        vectors.push_back(v);
+    }
+    for (int i = 0; i < 40; i++) {
+        if (vectors[i]->x != float(i) || vectors[i]->z != float(i)) {
+            fail("Pool: Vec3 " + std::to_string(i) + " was overwritten");
+        }
+        pool.destroy(vectors[i]);
+    }
+
+    auto throws = [](auto&& make) {
+        try {
+            make();
+        } catch (const std::invalid_argument&) {
+            return true;
+        }
+        return false;
+    };
+    memory::Arena arena;
+    if (!throws([] { memory::Pool(16, 16, 12); }) || !throws([&] { arena.allocate(16, 24); })) {
+        fail("an alignment that isn't a power of 2 was accepted");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t objects = argc > 1 ? std::stoull(argv[1]) : 4'000'000;
+    unsigned max_threads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+
+    verify();
+
+    const std::vector<Benchmark> benchmarks = {
+        {"new/delete", run_new_delete},
+        {"malloc/free", run_malloc_free},
+        {"Arena", run_arena},
+        {"Pool", run_pool},
+        {"pmr::list (new/delete)", run_list_default},
+        {"pmr::list (Arena)", run_list_arena},
+        {"pmr::list (Pool)", run_list_pool},
+        {"pmr::list (std pool)", run_list_std_pool},
+    };
+
+    std::cout << "## " << objects << " objects of " << sizeof(Small) << " bytes per thread, batches of " << batch_size << "\n\n";
+    std::cout << "| Allocator                | Threads | Time (ms) | ns/object* | Alloc. calls | Calls per object |\n";
+    std::cout << "|--------------------------|---------|-----------|------------|--------------|------------------|\n";
+    for (const Benchmark& benchmark : benchmarks) {
+        for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+            measure(benchmark, objects, threads);
+        }
+    }
+    std::cout << "\n* Per object per thread - stays flat when the allocator scales, grows when threads fight over it\n";
+    std::cout << "  \"Alloc. calls\" counts calls into the general purpose allocator (new + malloc)" << std::endl;
+
+    fragmentation(objects);
+}
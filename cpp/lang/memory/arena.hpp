@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Custom allocators used by dynamic_allocation.cpp and allocation_benchmark.cpp
+//
+// `new`/`malloc` are general purpose: they have to handle any size, any lifetime and any thread,
+// so every call pays for bookkeeping (size classes, locks or thread caches, free block coalescing).
+// When we know more about our objects than the general allocator does, we can do much less work.
+//
+// Build example: g++ -std=c++20 -O2 dynamic_allocation.cpp
+
+namespace memory {
+
+// ## Arena (bump allocator)
+// Asks the system for big blocks and hands out memory by moving a pointer forward ("bumping").
+// Freeing a single object is not possible - the whole arena is released at once with reset()
+// (or the destructor). Perfect for objects that die together, e.g. everything created while
+// handling one request.
+//
+// Not thread safe - give every thread its own arena instead of sharing one.
+class Arena {
+public:
+    explicit Arena(std::size_t block_size = 64 * 1024) : block_size_(block_size) {}
+    ~Arena() {
+        for (Block& block : blocks_) {
+            std::free(block.data);
+        }
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // alignment has to be a power of 2 (anything else throws std::invalid_argument): aligning is done with a mask
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+        if (!std::has_single_bit(alignment)) {
+            throw std::invalid_argument("Arena::allocate: the alignment has to be a power of 2");
+        }
+        std::byte* aligned = align_up(cursor_, alignment);
+        if (cursor_ == nullptr || aligned + size > end_) {
+            next_block(size + alignment);
+            aligned = align_up(cursor_, alignment);
+        }
+        cursor_ = aligned + size;
+        return aligned;
+    }
+
+    // Constructs an object inside the arena. The destructor is NEVER called by the arena, so only use
+    // it for trivially destructible types, or call the destructor yourself.
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Makes all memory available again. The blocks are kept, so a reused arena doesn't go back to the system
+    void reset() {
+        active_ = 0;
+        cursor_ = nullptr;
+        end_ = nullptr;
+    }
+
+    std::size_t system_allocations() const { return system_allocations_; } // How many times malloc was called
+    std::size_t bytes_reserved() const {
+        std::size_t total = 0;
+        for (const Block& block : blocks_) {
+            total += block.size;
+        }
+        return total;
+    }
+
+private:
+    struct Block {
+        std::byte* data;
+        std::size_t size;
+    };
+
+    static std::byte* align_up(std::byte* ptr, std::size_t alignment) {
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(ptr);
+        return reinterpret_cast<std::byte*>((address + alignment - 1) & ~(alignment - 1));
+    }
+
+    void next_block(std::size_t min_size) {
+        // Reuse the blocks kept by reset() first. Blocks that are too small are skipped until the next reset()
+        while (active_ < blocks_.size()) {
+            Block& block = blocks_[active_++];
+            if (block.size >= min_size) {
+                cursor_ = block.data;
+                end_ = block.data + block.size;
+                return;
+            }
+        }
+
+        std::size_t size = std::max(block_size_, min_size);
+        std::byte* data = static_cast<std::byte*>(std::malloc(size));
+        if (data == nullptr) {
+            throw std::bad_alloc();
+        }
+        ++system_allocations_;
+
+        blocks_.push_back({data, size});
+        active_ = blocks_.size();
+        cursor_ = data;
+        end_ = data + size;
+    }
+
+    std::size_t block_size_;
+    std::vector<Block> blocks_;
+    std::size_t active_ = 0; // blocks_[0..active_) are in use
+    std::byte* cursor_ = nullptr;
+    std::byte* end_ = nullptr;
+    std::size_t system_allocations_ = 0;
+};
+
+// ## Pool (fixed-size allocator)
+// Every slot has the same size, so any free slot fits any request. Freed slots are kept in a
+// singly linked "free list" that is stored inside the free slots themselves - no extra memory.
+// Both allocate() and deallocate() are a couple of pointer moves, and since all slots are the
+// same size the pool can't fragment. New slots are carved out of an Arena in chunks.
+//
+// Not thread safe - same as Arena.
+class Pool {
+public:
+    // alignment has to be a power of 2, like Arena's. Free slots hold a pointer, so slots are always aligned for
+    // one too: Pool(sizeof(Vec3), n, alignof(Vec3)) with a 12-byte, 4-aligned Vec3 gets 16-byte slots, 8-aligned
+    explicit Pool(std::size_t slot_size, std::size_t slots_per_chunk = 1024,
+                  std::size_t alignment = alignof(std::max_align_t))
+        : alignment_(slot_alignment(alignment)),
+          slot_size_(round_up(std::max(slot_size, sizeof(Slot)), alignment_)),
+          slots_per_chunk_(slots_per_chunk),
+          arena_(slot_size_ * slots_per_chunk) {}
+
+    void* allocate() {
+        if (free_ == nullptr) {
+            refill();
+        }
+        Slot* slot = free_;
+        free_ = slot->next;
+        return slot;
+    }
+
+    void deallocate(void* ptr) {
+        Slot* slot = static_cast<Slot*>(ptr);
+        slot->next = free_;
+        free_ = slot;
+    }
+
+    // T has to fit the pool's slots: a bigger T would overwrite the next slot, a more aligned one would be
+    // misaligned. The slot size is only known at runtime, so this is checked on every call - two compares
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        if (sizeof(T) > slot_size_ || alignof(T) > alignment_) {
+            throw std::invalid_argument("Pool::create: the type doesn't fit the pool's slot size or alignment");
+        }
+        return new (allocate()) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    void destroy(T* ptr) {
+        ptr->~T();
+        deallocate(ptr);
+    }
+
+    std::size_t slot_size() const { return slot_size_; }
+    std::size_t alignment() const { return alignment_; }
+    std::size_t system_allocations() const { return arena_.system_allocations(); }
+
+private:
+    struct Slot {
+        Slot* next;
+    };
+
+    static std::size_t slot_alignment(std::size_t alignment) {
+        if (!std::has_single_bit(alignment)) {
+            throw std::invalid_argument("Pool: the alignment has to be a power of 2");
+        }
+        return std::max(alignment, alignof(Slot));
+    }
+
+    static std::size_t round_up(std::size_t size, std::size_t alignment) {
+        return (size + alignment - 1) & ~(alignment - 1);
+    }
+
+    void refill() {
+        std::byte* chunk = static_cast<std::byte*>(arena_.allocate(slot_size_ * slots_per_chunk_, alignment_));
+        // Thread the new slots onto the free list back to front, so they're handed out in address order
+        for (std::size_t i = slots_per_chunk_; i-- > 0;) {
+            deallocate(chunk + i * slot_size_);
+        }
+    }
+
+    std::size_t alignment_; // Before slot_size_, which is computed from it
+    std::size_t slot_size_;
+    std::size_t slots_per_chunk_;
+    Arena arena_;
+    Slot* free_ = nullptr;
+};
+
+// ## std::pmr adapters
+// `std::pmr` ("polymorphic memory resource", C++17) containers take a `std::pmr::memory_resource*`
+// instead of an allocator template parameter, so `std::pmr::vector<int>` is the same type no matter
+// where its memory comes from. These adapters let the standard containers use Arena and Pool.
+//
+// The standard library ships similar resources: `std::pmr::monotonic_buffer_resource` (an arena)
+// and `std::pmr::unsynchronized_pool_resource` (pools for several size classes).
+
+// Every allocation comes from the arena, deallocation does nothing
+class ArenaResource : public std::pmr::memory_resource {
+public:
+    explicit ArenaResource(Arena& arena) : arena_(arena) {}
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        return arena_.allocate(bytes, alignment);
+    }
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    Arena& arena_;
+};
+
+// Requests that fit in a slot come from the pool, anything bigger goes to the upstream resource.
+// Node based containers (std::pmr::list, std::pmr::map, ...) only ever allocate one node at a time,
+// which is exactly what a pool is good at.
+class PoolResource : public std::pmr::memory_resource {
+public:
+    explicit PoolResource(Pool& pool, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : pool_(pool), upstream_(upstream) {}
+
+private:
+    bool fits(std::size_t bytes, std::size_t alignment) const {
+        return bytes <= pool_.slot_size() && alignment <= pool_.alignment();
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        return fits(bytes, alignment) ? pool_.allocate() : upstream_->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+        if (fits(bytes, alignment)) {
+            pool_.deallocate(ptr);
+        } else {
+            upstream_->deallocate(ptr, bytes, alignment);
+        }
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    Pool& pool_;
+    std::pmr::memory_resource* upstream_;
+};
+
+} // namespace memory
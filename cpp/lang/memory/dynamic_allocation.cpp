@@ -1,2 +1,88 @@
-// TODO: basics
-// TODO: explain the behaviour of initialized values after new
+#include <cstdlib>
+
+#include <iostream>
+#include <list>
+#include <memory_resource>
+
+#include "arena.hpp"
+
+struct Point {
+    int x;
+    int y;
+};
+
+void basics() {
+    // ## new and delete
+    // `new` asks the allocator for memory on the heap, constructs the object there and returns a pointer to it.
+    // Unlike statically allocated variables, the object lives until we destroy it with `delete` - leaving
+    // the scope only destroys the pointer, not the object it points to.
+    int* number = new int(5);
+    std::cout << "number: " << *number << "\tAddress: " << number << std::endl;
+    delete number; // Every `new` needs exactly one `delete`. Forgetting it leaks memory, doing it twice is undefined behaviour
+
+    // ## Arrays
+    // Arrays allocated with `new[]` MUST be freed with `delete[]`
+    int* numbers = new int[4]{1, 2, 3, 4};
+    std::cout << "numbers[3]: " << numbers[3] << std::endl;
+    delete[] numbers;
+
+    // ## Initialized values after new
+    // The rules are the same as for local variables:
+    Point* garbage = new Point;        // default-initialized - x and y contain garbage (whatever was in that memory before)
+    Point* zeroed = new Point();       // value-initialized - x and y are 0
+    Point* assigned = new Point{1, 2}; // aggregate-initialized - x is 1, y is 2
+    std::cout << "zeroed: " << zeroed->x << ", " << zeroed->y << std::endl;
+    std::cout << "assigned: " << assigned->x << ", " << assigned->y << std::endl;
+    // std::cout << garbage->x << std::endl; // reading garbage is undefined behaviour
+    delete garbage;
+    delete zeroed;
+    delete assigned;
+
+    // ## malloc and free
+    // The C way. malloc only hands out raw bytes - no constructors are called, so only use it for plain data.
+    // Never mix the two families: memory from malloc goes back with free, memory from new goes back with delete.
+    Point* raw = static_cast<Point*>(std::malloc(sizeof(Point)));
+    raw->x = 3; // Fine for a trivial type like Point
+    raw->y = 4;
+    std::free(raw);
+
+    std::cout << std::endl;
+}
+
+void custom_allocators() {
+    // Every `new` goes through the general purpose allocator, which has to track each block separately and
+    // synchronize between threads. When lots of small objects are created and destroyed together, it's much
+    // cheaper to take one big block and carve it up ourselves. See arena.hpp for the implementation and
+    // allocation_benchmark.cpp for the numbers.
+
+    // ## Arena
+    // Objects are placed one after another in a big block. Nothing is freed until reset().
+    memory::Arena arena;
+    Point* first = arena.create<Point>(Point{1, 2});
+    Point* second = arena.create<Point>(Point{3, 4});
+    std::cout << "arena: " << first << " " << second << " (" << arena.system_allocations() << " system allocation)" << std::endl;
+    arena.reset(); // first and second are now dangling - the memory will be reused by the next create()
+
+    // ## Pool
+    // Fixed-size slots, freed slots are reused by the next allocation
+    memory::Pool pool(sizeof(Point));
+    Point* pooled = pool.create<Point>(Point{5, 6});
+    pool.destroy(pooled);
+    Point* reused = pool.create<Point>(Point{7, 8});
+    std::cout << "pool: " << pooled << " reused as " << reused << std::endl;
+    pool.destroy(reused);
+
+    // ## Standard containers on custom memory
+    // std::pmr containers take a memory resource instead of using `new` directly
+    memory::ArenaResource resource(arena);
+    std::pmr::list<Point> points(&resource);
+    for (int i = 0; i < 3; i++) {
+        points.push_back(Point{i, i});
+    }
+    std::cout << "pmr::list nodes live in the arena, reserved: " << arena.bytes_reserved() << " bytes" << std::endl;
+}
+
+int main() {
+    basics();
+    custom_allocators();
+}
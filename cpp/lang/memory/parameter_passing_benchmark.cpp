@@ -0,0 +1,390 @@
+// Cost of passing arguments by value, const&, &&, pointer and view (std::string_view/std::span), for payloads
+// from a single int up to a std::vector with thousands of elements. Also counts the copies and moves every way
+// of passing makes, and the ones copy elision saves when returning by value - and exits with an error when those
+// counts aren't what the language rules say they must be.
+//
+// Build: g++ -std=c++20 -O2 parameter_passing_benchmark.cpp -o parameter_passing_benchmark
+// Usage: ./parameter_passing_benchmark
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../../testing/report.hpp"
+
+// The measured functions must really be called with their declared signature. noipa stops GCC from inlining
+// them and also from the interprocedural tricks (like turning a const int& parameter into an int) that would
+// make every way of passing look the same
+#define MEASURED [[gnu::noipa]]
+
+// ## Counting allocations
+// Same trick as allocation_benchmark.cpp: replacing the global operator new counts every heap allocation,
+// including the ones std::string and std::vector make when they're copied
+std::size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+// ## Counting copies and moves
+// Counted<T> behaves like T but counts how often it's copied and moved. Timing runs use the plain T, counting
+// runs use Counted<T> - the counts don't depend on the timing, so they never disturb it
+struct Counts {
+    std::size_t copies = 0;
+    std::size_t moves = 0;
+};
+Counts counts;
+
+template <typename T>
+struct Counted {
+    T value;
+
+    explicit Counted(T v) : value(std::move(v)) {}
+    Counted(const Counted& other) : value(other.value) { ++counts.copies; }
+    Counted(Counted&& other) noexcept : value(std::move(other.value)) { ++counts.moves; }
+    Counted& operator=(const Counted& other) {
+        value = other.value;
+        ++counts.copies;
+        return *this;
+    }
+    Counted& operator=(Counted&& other) noexcept {
+        value = std::move(other.value);
+        ++counts.moves;
+        return *this;
+    }
+};
+
+// ## Payloads
+// A plain struct the size of a cache line - too big for registers, but copying it is a couple of vector moves
+struct Pod64 {
+    std::uint64_t words[8];
+};
+
+// Something cheap that depends on the argument, so the call can't be skipped
+std::uint64_t digest(int x) { return static_cast<std::uint64_t>(x); }
+std::uint64_t digest(const Pod64& pod) { return pod.words[0] + pod.words[7]; }
+std::uint64_t digest(std::string_view text) { return text.size() + (text.empty() ? 0 : static_cast<unsigned char>(text[0])); }
+std::uint64_t digest(std::span<const int> items) { return items.size() + (items.empty() ? 0 : static_cast<std::uint64_t>(items[0])); }
+std::uint64_t digest(const std::string& text) { return digest(std::string_view(text)); }
+std::uint64_t digest(const std::vector<int>& items) { return digest(std::span<const int>(items)); }
+template <typename T>
+std::uint64_t digest(const Counted<T>& counted) { return digest(counted.value); }
+
+// Non-owning views of the payloads that have one
+std::string_view view_of(const std::string& text) { return text; }
+std::span<const int> view_of(const std::vector<int>& items) { return items; }
+template <typename T>
+auto view_of(const Counted<T>& counted) -> decltype(view_of(counted.value)) { return view_of(counted.value); }
+
+template <typename P>
+concept has_view = requires(const P& payload) { view_of(payload); };
+
+// ## The ways of passing
+// Read-only: the function only looks at the argument
+template <typename P>
+MEASURED std::uint64_t observe_by_value(P payload) { return digest(payload); }
+
+template <typename P>
+MEASURED std::uint64_t observe_by_cref(const P& payload) { return digest(payload); }
+
+template <typename P>
+MEASURED std::uint64_t observe_by_pointer(const P* payload) { return digest(*payload); }
+
+template <typename V>
+MEASURED std::uint64_t observe_by_view(V view) { return digest(view); }
+
+// Sink: the function keeps the argument, e.g. a setter or a constructor storing a member.
+//   set_cref  - one function, always copies
+//   set_value - "sink by value": the caller's argument is copied (lvalue) or moved (rvalue) into the parameter,
+//               which is then moved into the member
+//   set_rref  - the rvalue overload that usually sits next to set_cref, moves without the extra step
+template <typename P>
+struct Holder {
+    P value;
+
+    MEASURED void set_cref(const P& payload) { value = payload; }
+    MEASURED void set_value(P payload) { value = std::move(payload); }
+    MEASURED void set_rref(P&& payload) { value = std::move(payload); }
+};
+
+enum class Scenario {
+    observe_value,
+    observe_cref,
+    observe_pointer,
+    observe_view,
+    sink_cref_lvalue,
+    sink_value_lvalue,
+    sink_cref_rvalue,
+    sink_value_rvalue,
+    sink_rref_rvalue,
+};
+
+const char* name(Scenario scenario) {
+    switch (scenario) {
+    case Scenario::observe_value:
+        return "read: value";
+    case Scenario::observe_cref:
+        return "read: const&";
+    case Scenario::observe_pointer:
+        return "read: pointer";
+    case Scenario::observe_view:
+        return "read: view";
+    case Scenario::sink_cref_lvalue:
+        return "sink lvalue: const&";
+    case Scenario::sink_value_lvalue:
+        return "sink lvalue: value";
+    case Scenario::sink_cref_rvalue:
+        return "sink rvalue: const&";
+    case Scenario::sink_value_rvalue:
+        return "sink rvalue: value";
+    case Scenario::sink_rref_rvalue:
+        return "sink rvalue: &&";
+    }
+    return "?";
+}
+
+// Copies and moves per call, the same for every payload: they follow from the signatures alone
+Counts expected(Scenario scenario) {
+    switch (scenario) {
+    case Scenario::observe_value:
+    case Scenario::sink_cref_lvalue:
+    case Scenario::sink_cref_rvalue:
+        return {1, 0};
+    case Scenario::observe_cref:
+    case Scenario::observe_pointer:
+    case Scenario::observe_view:
+        return {0, 0};
+    case Scenario::sink_value_lvalue:
+        return {1, 1}; // Copied into the parameter, moved into the member
+    case Scenario::sink_value_rvalue:
+        return {0, 2}; // Moved into the parameter, moved into the member
+    case Scenario::sink_rref_rvalue:
+        return {0, 1};
+    }
+    return {};
+}
+
+void fail(const std::string& what) {
+    std::cerr << "ERROR: " << what << std::endl;
+    std::exit(1);
+}
+
+void check(const std::string& what, const Counts& expected, double copies, double moves) {
+    if (copies != static_cast<double>(expected.copies) || moves != static_cast<double>(expected.moves)) {
+        std::ostringstream message;
+        message << what << ": " << copies << " copies and " << moves << " moves, expected " << expected.copies
+                << " and " << expected.moves;
+        fail(message.str());
+    }
+}
+
+bool is_rvalue(Scenario scenario) {
+    return scenario == Scenario::sink_cref_rvalue || scenario == Scenario::sink_value_rvalue || scenario == Scenario::sink_rref_rvalue;
+}
+
+// Keeps the compiler from optimizing the measured work away
+volatile std::uint64_t sink;
+
+struct Measurement {
+    double ns = 0;          // per call
+    double allocations = 0; // per call
+    double copies = 0;      // per call
+    double moves = 0;       // per call
+};
+
+constexpr std::size_t batch = 256;
+
+// Calls the scenario `calls` times. Rvalue scenarios need a fresh object to move from on every call, so the
+// objects are copied from the prototype in batches outside the timed part
+template <typename P>
+Measurement run(Scenario scenario, const P& prototype, std::size_t calls) {
+    Holder<P> holder{prototype};
+    std::vector<P> pool;
+    Measurement result;
+    std::uint64_t total = 0;
+    double seconds = 0;
+    std::size_t allocations_before = 0;
+    std::size_t allocated = 0;
+    Counts counted;
+
+    for (std::size_t done = 0; done < calls; done += batch) {
+        if (is_rvalue(scenario)) {
+            pool.assign(batch, prototype);
+        }
+        counts = {};
+        allocations_before = allocations;
+        auto begin = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < batch; i++) {
+            switch (scenario) {
+            case Scenario::observe_value:
+                total += observe_by_value<P>(prototype);
+                break;
+            case Scenario::observe_cref:
+                total += observe_by_cref<P>(prototype);
+                break;
+            case Scenario::observe_pointer:
+                total += observe_by_pointer<P>(&prototype);
+                break;
+            case Scenario::observe_view:
+                if constexpr (has_view<P>) {
+                    total += observe_by_view(view_of(prototype));
+                }
+                break;
+            case Scenario::sink_cref_lvalue:
+                holder.set_cref(prototype);
+                break;
+            case Scenario::sink_value_lvalue:
+                holder.set_value(prototype);
+                break;
+            case Scenario::sink_cref_rvalue:
+                holder.set_cref(std::move(pool[i])); // Binds to const& - copied anyway
+                break;
+            case Scenario::sink_value_rvalue:
+                holder.set_value(std::move(pool[i]));
+                break;
+            case Scenario::sink_rref_rvalue:
+                holder.set_rref(std::move(pool[i]));
+                break;
+            }
+        }
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        allocated += allocations - allocations_before;
+        counted.copies += counts.copies;
+        counted.moves += counts.moves;
+        total += digest(holder.value);
+    }
+    sink = total;
+
+    std::size_t made = (calls + batch - 1) / batch * batch;
+    result.ns = seconds * 1e9 / made;
+    result.allocations = static_cast<double>(allocated) / made;
+    result.copies = static_cast<double>(counted.copies) / made;
+    result.moves = static_cast<double>(counted.moves) / made;
+    return result;
+}
+
+void print_row(const std::string& payload, Scenario scenario, const Measurement& time, const Measurement& count) {
+    std::cout << "| " << std::setw(20) << std::left << payload
+              << " | " << std::setw(19) << name(scenario) << std::right << std::fixed
+              << " | " << std::setw(9) << std::setprecision(1) << time.ns
+              << " | " << std::setw(6) << std::setprecision(2) << time.allocations
+              << " | " << std::setw(6) << count.copies
+              << " | " << std::setw(6) << count.moves << " |\n";
+    std::string row = payload + ", " + name(scenario);
+    bench::report(row + ": ns/call", time.ns, "ns");
+    bench::report(row + ": allocs", time.allocations, "allocs");
+    bench::report(row + ": copies", count.copies, "copies");
+    bench::report(row + ": moves", count.moves, "moves");
+}
+
+template <typename T>
+void measure(const std::string& payload, const T& prototype, std::size_t bytes) {
+    // Big payloads get fewer calls, so every row takes roughly the same time
+    std::size_t calls = std::max<std::size_t>(4 * batch, std::min<std::size_t>(1 << 20, (std::size_t{256} << 20) / (bytes + 64)));
+    Counted<T> counted_prototype(prototype);
+    for (Scenario scenario : {Scenario::observe_value, Scenario::observe_cref, Scenario::observe_pointer, Scenario::observe_view,
+                              Scenario::sink_cref_lvalue, Scenario::sink_value_lvalue, Scenario::sink_cref_rvalue,
+                              Scenario::sink_value_rvalue, Scenario::sink_rref_rvalue}) {
+        if (scenario == Scenario::observe_view && !has_view<T>) {
+            continue;
+        }
+        Measurement time = run(scenario, prototype, calls);
+        Measurement count = run(scenario, counted_prototype, batch);
+        print_row(payload, scenario, time, count);
+        check(payload + ", " + name(scenario), expected(scenario), count.copies, count.moves);
+    }
+}
+
+// ## Copy elision
+// Returning a local by value doesn't copy it: since C++17 a returned temporary (prvalue) is constructed directly
+// in the caller's variable, and compilers do the same for a named local (NRVO) when they can.
+// `return std::move(local);` turns that off and forces a move - a pessimization, not an optimization.
+using Tracked = Counted<std::string>;
+
+MEASURED Tracked return_prvalue() { return Tracked(std::string(100, 'x')); }
+
+MEASURED Tracked return_named() {
+    Tracked local(std::string(100, 'x'));
+    return local;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpessimizing-move" // The compiler knows, that's the point of the example
+MEASURED Tracked return_moved() {
+    Tracked local(std::string(100, 'x'));
+    return std::move(local);
+}
+#pragma GCC diagnostic pop
+
+// Two different locals can't both be constructed in the caller's variable - no NRVO, but still an implicit move
+MEASURED Tracked return_either(bool first) {
+    Tracked a(std::string(100, 'a'));
+    Tracked b(std::string(100, 'b'));
+    if (first) {
+        return a;
+    }
+    return b;
+}
+
+// The same choice as an expression: `first ? a : b` is an lvalue, not the name of a local, so nothing moves it -
+// the return copies
+MEASURED Tracked return_ternary(bool first) {
+    Tracked a(std::string(100, 'a'));
+    Tracked b(std::string(100, 'b'));
+    return first ? a : b;
+}
+
+template <typename F>
+void print_elision(const char* how, F&& make, Counts expected) {
+    counts = {};
+    Tracked result = make();
+    sink = result.value.size();
+    check(how, expected, static_cast<double>(counts.copies), static_cast<double>(counts.moves));
+    std::cout << "| " << std::setw(30) << std::left << how << " | " << std::setw(6) << std::right << counts.copies
+              << " | " << std::setw(6) << counts.moves << " |\n";
+    bench::report(std::string(how) + ": copies", counts.copies, "copies");
+    bench::report(std::string(how) + ": moves", counts.moves, "moves");
+}
+
+int main() {
+    std::cout << "## Passing arguments\n\n";
+    std::cout << "| Payload              | Passing             | ns/call   | allocs | copies | moves  |\n";
+    std::cout << "|----------------------|---------------------|-----------|--------|--------|--------|\n";
+    measure("int", 42, sizeof(int));
+    measure("Pod64", Pod64{{1, 2, 3, 4, 5, 6, 7, 8}}, sizeof(Pod64));
+    for (std::size_t length : {8, 64, 1024, 16384}) {
+        measure("string(" + std::to_string(length) + ")", std::string(length, 'x'), length);
+    }
+    for (std::size_t length : {4, 256, 16384}) {
+        measure("vector<int>(" + std::to_string(length) + ")", std::vector<int>(length, 1), length * sizeof(int));
+    }
+    std::cout << "\nallocs, copies and moves are per call. \"sink\" stores the argument in an existing object, \"lvalue\"\n"
+              << "passes a named variable the caller keeps using, \"rvalue\" passes std::move(variable)\n\n";
+
+    std::cout << "## Returning by value\n\n";
+    std::cout << "| Return                         | copies | moves  |\n";
+    std::cout << "|--------------------------------|--------|--------|\n";
+    print_elision("return Tracked(...);", return_prvalue, {0, 0});
+    print_elision("return local;", return_named, {0, 0}); // NRVO isn't guaranteed, but GCC and Clang do it here
+    print_elision("return std::move(local);", return_moved, {0, 1});
+    print_elision("if (first) return a; return b;", [] { return return_either(true); }, {0, 1});
+    print_elision("return first ? a : b;", [] { return return_ternary(true); }, {1, 0});
+    std::cout << std::endl;
+}
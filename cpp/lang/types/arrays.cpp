@@ -0,0 +1,131 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include "soa.hpp"
+
+// # Arrays
+// An array is a fixed number of elements of one type, stored one right after another. Element i is at
+// address + i * sizeof(element), so indexing costs one multiply-add, and walking the array in order reads memory
+// in order - which is what caches and prefetchers are built for.
+
+// Takes any contiguous range of ints: a C array, std::array or std::vector, without copying it
+int sum(std::span<const int> numbers) {
+    return std::accumulate(numbers.begin(), numbers.end(), 0);
+}
+
+void basics() {
+    // ## C arrays
+    // The size is part of the type and must be known at compile time. Passed to a function, a C array decays to
+    // a pointer to its first element and the size is lost - sizeof(numbers) in the function would be the size of
+    // a pointer
+    int numbers[4] = {1, 2, 3, 4};
+    std::cout << "C array: " << sizeof(numbers) << " bytes, " << std::size(numbers) << " elements, sum " << sum(numbers) << std::endl;
+
+    // ## std::array
+    // The same thing in memory, but it doesn't decay, can be copied and returned, and knows its size
+    std::array<int, 4> array = {5, 6, 7, 8};
+    std::cout << "std::array: " << sizeof(array) << " bytes, sum " << sum(array) << std::endl;
+
+    // ## std::vector
+    // The elements are on the heap and the size can change. When it outgrows its capacity, the vector allocates
+    // a bigger block (usually twice the size) and moves everything there - which invalidates every pointer and
+    // reference into it. reserve() allocates once up front
+    std::vector<int> vector;
+    vector.reserve(100);
+    for (int i = 0; i < 100; i++) {
+        vector.push_back(i);
+    }
+    std::cout << "std::vector: " << vector.size() << " elements, capacity " << vector.capacity() << ", sum " << sum(vector) << std::endl;
+
+    // ## Multidimensional arrays
+    // int grid[3][4] is 3 rows of 4 ints, row after row (row-major). grid[y][x] with x in the inner loop walks
+    // memory in order; with y in the inner loop every access jumps a whole row ahead
+    int grid[3][4] = {};
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 4; x++) {
+            grid[y][x] = y * 4 + x;
+        }
+    }
+    std::cout << "grid[2][1] is element " << &grid[2][1] - &grid[0][0] << " of the block" << std::endl;
+}
+
+// # Arrays of structs vs structs of arrays
+// The members a particle simulation step reads (position, velocity) and the ones only reports need (id, color,
+// mass) are split into two structs - hot and cold - even though they describe the same particle
+struct ParticleInfo {
+    std::uint32_t id;
+    std::uint32_t color;
+    float mass;
+    float charge;
+};
+
+struct Particle {
+    float x, y;
+    float vx, vy;
+    ParticleInfo info;
+};
+
+// Named access to one element of a soa::vector: references in the order of the vector's members
+struct ParticleRef {
+    float& x;
+    float& y;
+    float& vx;
+    float& vy;
+    ParticleInfo& info;
+};
+
+void layouts() {
+    // ## Array of structs (AoS)
+    // The natural layout: std::vector<Particle>. Moving the particles reads x, y, vx and vy - 16 of every 32 bytes.
+    // The other 16 come along anyway, because memory is read in whole 64-byte cache lines
+    std::vector<Particle> aos;
+    for (std::uint32_t i = 0; i < 8; i++) {
+        float f = static_cast<float>(i);
+        aos.push_back(Particle{f, -f, 1.0f, 0.5f, ParticleInfo{i, 0xff0000ff, 1.0f, 0.0f}});
+    }
+
+    // ## Struct of arrays (SoA)
+    // One array per member. A loop over x and vx reads only those two arrays, every byte of every cache line is
+    // used, and consecutive particles sit in consecutive floats - exactly what a SIMD register loads.
+    // ParticleInfo stays together as one column: it's cold, and splitting it up would only make the rare access
+    // to a whole record touch four cache lines instead of one
+    using Particles = soa::vector<Particle, &Particle::x, &Particle::y, &Particle::vx, &Particle::vy, &Particle::info>;
+    Particles soa(aos); // AoS -> SoA
+
+    // The same element-wise interface as std::vector, through a proxy
+    soa[3].get<&Particle::x>() += 100;
+    auto p = soa[4].as<ParticleRef>();
+    p.y = 42;
+    Particle copy = soa[5]; // Gathered from the columns
+    // Like with std::vector, growing moves the columns: references from get() and as() dangle afterwards, p included
+    soa.push_back(Particle{9, 9, 0, 0, ParticleInfo{8, 0, 2.0f, 0.0f}});
+    std::cout << "soa[3].x = " << soa[3].get<&Particle::x>() << ", soa[4].y = " << soa[4].get<&Particle::y>()
+              << ", soa[5].info.id = " << copy.info.id << ", size " << soa.size() << std::endl;
+
+    // Loops over whole columns are the point: plain arrays, aligned to 64 bytes, that the compiler vectorizes
+    std::span<float> x = soa.column<&Particle::x>();
+    std::span<float> vx = soa.column<&Particle::vx>();
+    for (std::size_t i = 0; i < x.size(); i++) {
+        x[i] += vx[i];
+    }
+    std::cout << "x column at " << x.data() << ", y column at " << soa.column<&Particle::y>().data() << std::endl;
+
+    // SoA -> AoS, for code that wants structs
+    std::vector<Particle> back = soa.to_aos();
+    std::cout << "back to AoS: particle 3 at x = " << back[3].x << std::endl;
+
+    // ## Array of structs of arrays (AoSoA)
+    // The middle ground: blocks of 8 or 16 particles, SoA inside each block. Loops still get whole SIMD registers
+    // per member, and all members of one particle are within one block - a few cache lines apart, not megabytes.
+    // layout_benchmark.cpp compares all three
+}
+
+int main() {
+    basics();
+    layouts();
+}
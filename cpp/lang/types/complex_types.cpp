@@ -1,3 +1,105 @@
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "intrusive_ptr.hpp"
+
 // TODO: string
-// TODO: Smart pointers
 // TODO: mention programmer-defined custom types in later tutorials
+
+// # Smart pointers
+// A smart pointer is an object that owns heap memory and frees it in its destructor, so `delete` is never
+// written by hand and can't be forgotten, skipped by an early return, or skipped by an exception.
+// They live in <memory>.
+
+struct Widget {
+    std::string name;
+    int size;
+
+    Widget(std::string n, int s) : name(std::move(n)), size(s) { std::cout << "  Widget " << name << " created" << std::endl; }
+    ~Widget() { std::cout << "  Widget " << name << " destroyed" << std::endl; }
+};
+
+// ## std::unique_ptr
+// Exactly one owner. Can't be copied, only moved - moving transfers ownership. Costs nothing over a raw pointer:
+// same size, and the destructor is just `delete`. The default choice for owning a heap object.
+void unique_pointers() {
+    std::cout << "## unique_ptr" << std::endl;
+    std::unique_ptr<Widget> first = std::make_unique<Widget>("first", 1);
+    std::cout << "  size: " << first->size << ", sizeof(unique_ptr): " << sizeof(first) << std::endl;
+
+    // std::unique_ptr<Widget> copy = first; // Doesn't compile - a copy would mean two owners
+    std::unique_ptr<Widget> owner = std::move(first); // first is now empty (nullptr)
+    std::cout << "  first is " << (first ? "set" : "empty") << " after the move" << std::endl;
+} // owner goes out of scope here and deletes the Widget
+
+// ## std::shared_ptr
+// Shared ownership: any number of shared_ptrs can point to the same object, which is deleted when the last one
+// goes away. The owners are counted in a "control block" - a separate heap allocation with the reference count.
+// Every copy increments the count and every destruction decrements it, both with atomic instructions because
+// the copies might be on different threads (libstdc++ uses plain ones until the process starts its first thread).
+// A shared_ptr is two pointers: one to the object, one to the block.
+void shared_pointers() {
+    std::cout << "## shared_ptr" << std::endl;
+    std::shared_ptr<Widget> separate(new Widget("separate", 2)); // 2 allocations: the Widget, then the control block
+    std::shared_ptr<Widget> together = std::make_shared<Widget>("together", 3); // 1 allocation holding both
+    {
+        std::shared_ptr<Widget> copy = together;
+        std::cout << "  use_count with a copy: " << together.use_count() << std::endl;
+    }
+    std::cout << "  use_count after the copy is gone: " << together.use_count()
+              << ", sizeof(shared_ptr): " << sizeof(together) << std::endl;
+
+    // A weak_ptr points at a shared object without owning it; lock() returns a shared_ptr if it's still alive.
+    // make_shared's single allocation has one downside: the memory is only freed once the weak_ptrs are gone too
+    std::weak_ptr<Widget> observer = together;
+    if (std::shared_ptr<Widget> locked = observer.lock()) {
+        std::cout << "  weak_ptr sees " << locked->name << std::endl;
+    }
+}
+
+// ## Intrusive pointers
+// intrusive_ptr.hpp: the reference count lives inside the object, which inherits from smart::RefCounted.
+// One allocation, a one-pointer-wide handle, and the count is next to the data the code is about to read.
+// With smart::LocalCount the count is a plain integer - no atomic instructions - for objects that stay on one thread.
+struct Document : smart::RefCounted<Document> {
+    std::string title;
+    explicit Document(std::string t) : title(std::move(t)) {}
+};
+
+struct Scratch : smart::RefCounted<Scratch, smart::LocalCount> { // Single-thread only
+    int value = 0;
+};
+
+void intrusive_pointers() {
+    std::cout << "## IntrusivePtr" << std::endl;
+    smart::IntrusivePtr<Document> document = smart::make_intrusive<Document>("notes");
+    smart::IntrusivePtr<Document> copy = document;
+    std::cout << "  use_count: " << document.use_count() << ", sizeof(IntrusivePtr): " << sizeof(document) << std::endl;
+
+    // The count is in the object, so a raw pointer can be turned back into an owner at any time
+    Document* raw = document.get();
+    smart::IntrusivePtr<Document> again(raw);
+    std::cout << "  use_count after adopting the raw pointer: " << document.use_count() << std::endl;
+
+    smart::IntrusivePtr<Scratch> scratch = smart::make_intrusive<Scratch>();
+    scratch->value = 42;
+    std::cout << "  single-thread count: " << scratch.use_count() << std::endl;
+}
+
+// ## Which one?
+//   * unique_ptr whenever there's a single owner - almost always
+//   * shared_ptr (through make_shared) when ownership really is shared and the pointer crosses library boundaries,
+//     or weak_ptr is needed
+//   * an intrusive pointer when shared_ptr copies show up in profiles: half the size, one allocation, and no
+//     atomics at all for single-thread objects
+//   * a plain T* or T& to use an object without owning it - a function that only reads a Widget shouldn't take
+//     a shared_ptr<Widget> by value and pay for two atomic operations
+// smart_pointer_benchmark.cpp measures all of them.
+
+int main() {
+    unique_pointers();
+    shared_pointers();
+    intrusive_pointers();
+}
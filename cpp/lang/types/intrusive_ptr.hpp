@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+// Intrusive reference-counted pointer
+//
+// std::shared_ptr keeps the reference count in a separate control block: `shared_ptr<T>(new T)` makes two
+// allocations, every shared_ptr is two pointers wide, and copying one touches the control block, not the object.
+// `std::make_shared` puts both into one allocation, but the pointer stays two words and the count is atomic
+// as soon as the process has more than one thread.
+//
+// An intrusive pointer keeps the count inside the object itself (the object inherits from RefCounted):
+//   * one allocation, made by the caller's plain `new`
+//   * IntrusivePtr is a single pointer, the size of T*
+//   * the count shares a cache line with the object's own data, which the code is about to use anyway
+//   * the counter is a policy: AtomicCount for objects shared between threads, LocalCount (a plain integer, no
+//     atomic instructions at all) for objects that never leave one thread
+// What it gives up: weak pointers, custom deleters, aliasing, and pointing at types that don't inherit RefCounted.
+//
+//     struct Request : smart::RefCounted<Request> { ... };
+//     smart::IntrusivePtr<Request> request = smart::make_intrusive<Request>(...);
+
+namespace smart {
+
+// Thread-safe counter. Incrementing can be relaxed - whoever copies the pointer already holds a reference, so
+// the object can't go away meanwhile. The decrement that reaches zero must see every write other owners made to
+// the object before it's deleted, hence acq_rel (the same orders libstdc++ uses for shared_ptr)
+class AtomicCount {
+public:
+    void increment() noexcept { count_.fetch_add(1, std::memory_order_relaxed); }
+    bool decrement() noexcept { return count_.fetch_sub(1, std::memory_order_acq_rel) == 1; } // true when it hits 0
+    std::uint32_t load() const noexcept { return count_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::uint32_t> count_{0};
+};
+
+// Single-thread counter: a plain increment and decrement, which the compiler can even optimize away.
+// An object using it must never be shared between threads, not even read-only - copying the pointer writes the count
+class LocalCount {
+public:
+    void increment() noexcept { ++count_; }
+    bool decrement() noexcept { return --count_ == 0; }
+    std::uint32_t load() const noexcept { return count_; }
+
+private:
+    std::uint32_t count_ = 0;
+};
+
+// Base class for objects owned through IntrusivePtr. Derived is the class inheriting from it (CRTP): the last
+// release deletes the object as a Derived, no virtual destructor needed. If other classes inherit from Derived in
+// turn, Derived needs a virtual destructor, like any base class deleted through a base pointer
+template <typename Derived, typename Count = AtomicCount>
+class RefCounted {
+public:
+    std::uint32_t use_count() const noexcept { return count_.load(); }
+
+protected:
+    RefCounted() noexcept = default;
+    // Copying an object doesn't copy its owners - the copy starts with no references of its own
+    RefCounted(const RefCounted&) noexcept {}
+    RefCounted& operator=(const RefCounted&) noexcept { return *this; }
+    ~RefCounted() = default;
+
+private:
+    template <typename T>
+    friend class IntrusivePtr;
+
+    void add_ref() const noexcept { count_.increment(); }
+    void release() const noexcept {
+        if (count_.decrement()) {
+            delete static_cast<const Derived*>(this);
+        }
+    }
+
+    mutable Count count_;
+};
+
+template <typename T>
+class IntrusivePtr {
+public:
+    using element_type = T;
+
+    constexpr IntrusivePtr() noexcept = default;
+    constexpr IntrusivePtr(std::nullptr_t) noexcept {}
+
+    // Takes shared ownership of ptr - fine to call on a pointer other IntrusivePtrs already own, since the
+    // count lives in the object
+    explicit IntrusivePtr(T* ptr) noexcept : ptr_(ptr) {
+        if (ptr_ != nullptr) {
+            ptr_->add_ref();
+        }
+    }
+
+    IntrusivePtr(const IntrusivePtr& other) noexcept : IntrusivePtr(other.ptr_) {}
+    IntrusivePtr(IntrusivePtr&& other) noexcept : ptr_(std::exchange(other.ptr_, nullptr)) {}
+
+    template <typename U>
+        requires std::is_convertible_v<U*, T*>
+    IntrusivePtr(const IntrusivePtr<U>& other) noexcept : IntrusivePtr(static_cast<T*>(other.ptr_)) {}
+
+    template <typename U>
+        requires std::is_convertible_v<U*, T*>
+    IntrusivePtr(IntrusivePtr<U>&& other) noexcept : ptr_(std::exchange(other.ptr_, nullptr)) {}
+
+    ~IntrusivePtr() {
+        if (ptr_ != nullptr) {
+            ptr_->release();
+        }
+    }
+
+    // By value: copy- and move-assignment in one, and safe against self-assignment
+    IntrusivePtr& operator=(IntrusivePtr other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void reset() noexcept { IntrusivePtr().swap(*this); }
+    void reset(T* ptr) noexcept { IntrusivePtr(ptr).swap(*this); }
+    void swap(IntrusivePtr& other) noexcept { std::swap(ptr_, other.ptr_); }
+
+    T* get() const noexcept { return ptr_; }
+    T& operator*() const noexcept { return *ptr_; }
+    T* operator->() const noexcept { return ptr_; }
+    explicit operator bool() const noexcept { return ptr_ != nullptr; }
+    std::uint32_t use_count() const noexcept { return ptr_ != nullptr ? ptr_->use_count() : 0; }
+
+    template <typename U>
+    bool operator==(const IntrusivePtr<U>& other) const noexcept { return ptr_ == other.get(); }
+    bool operator==(std::nullptr_t) const noexcept { return ptr_ == nullptr; }
+    template <typename U>
+    auto operator<=>(const IntrusivePtr<U>& other) const noexcept { return std::compare_three_way()(ptr_, other.get()); }
+
+private:
+    template <typename U>
+    friend class IntrusivePtr;
+
+    T* ptr_ = nullptr;
+};
+
+template <typename T, typename... Args>
+IntrusivePtr<T> make_intrusive(Args&&... args) {
+    return IntrusivePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+} // namespace smart
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+// Compile-time type layout reports
+//
+// Everything about a type's layout - size, alignment, bit width, signedness, range, the padding the compiler
+// put into a struct - is known to the compiler, so the report can be computed entirely at compile time:
+//
+//     constexpr auto report = [] {
+//         layout::Text<2048> text;
+//         layout::type_table(text, "Fixed-width Types", {layout::type<int8_t>("int8_t"), ...});
+//         return text;
+//     }();
+//     std::cout << report.view();
+//
+// `report` is a plain char array baked into the binary; at runtime there's a single write and nothing else.
+// The same numbers work in static_assert, which turns them into layout audits that fail the build:
+//
+//     constexpr auto hot = layout::structure<Particle, &Particle::x, &Particle::y>("Particle");
+//     static_assert(hot.padding == 0, "Particle is on the hot path, keep it dense");
+
+namespace layout {
+
+// Fixed-capacity string that can be built in a constexpr function. Running out of space is an error at compile time
+template <std::size_t Capacity>
+class Text {
+public:
+    constexpr Text& operator<<(char c) {
+        if (size_ == Capacity) {
+            throw "layout::Text is too small for the report";
+        }
+        data_[size_++] = c;
+        return *this;
+    }
+
+    constexpr Text& operator<<(std::string_view text) {
+        for (char c : text) {
+            *this << c;
+        }
+        return *this;
+    }
+
+    constexpr Text& operator<<(std::uint64_t value) {
+        char digits[20] = {};
+        std::size_t count = 0;
+        do {
+            digits[count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        while (count > 0) {
+            *this << digits[--count];
+        }
+        return *this;
+    }
+
+    // Appends `text` padded with spaces to `width` - the equivalent of std::setw with std::left
+    constexpr Text& left(std::string_view text, std::size_t width) {
+        *this << text;
+        for (std::size_t i = text.size(); i < width; i++) {
+            *this << ' ';
+        }
+        return *this;
+    }
+
+    template <std::size_t Other>
+    constexpr Text& left(const Text<Other>& text, std::size_t width) { return left(text.view(), width); }
+
+    constexpr std::string_view view() const { return {data_, size_}; }
+    constexpr std::size_t size() const { return size_; }
+
+private:
+    char data_[Capacity] = {};
+    std::size_t size_ = 0;
+};
+
+// One table cell
+using Cell = Text<48>;
+
+struct TypeInfo {
+    std::string_view name;
+    std::size_t size;
+    std::size_t align;
+    std::size_t bits;       // Storage: every bit of every byte
+    std::size_t value_bits; // The ones that hold the value - 1 for bool
+    bool is_signed;
+    std::uint64_t min_magnitude; // |min|, kept apart from the sign so int64_t and uint64_t ranges both fit
+    std::uint64_t max;
+};
+
+template <typename T>
+constexpr TypeInfo type(std::string_view name) {
+    static_assert(std::numeric_limits<T>::is_integer, "ranges are only reported for integer types");
+    using Limits = std::numeric_limits<T>;
+    TypeInfo info{name, sizeof(T), alignof(T), sizeof(T) * 8, static_cast<std::size_t>(Limits::digits) + Limits::is_signed,
+                  Limits::is_signed, 0, static_cast<std::uint64_t>(Limits::max())};
+    if constexpr (Limits::is_signed) {
+        // -(min + 1) + 1 avoids negating the smallest value, which overflows
+        info.min_magnitude = static_cast<std::uint64_t>(-(Limits::min() + 1)) + 1;
+    }
+    return info;
+}
+
+// "-128 to 127" for small types, "-2^31 to 2^31-1" once the numbers stop being readable
+constexpr Cell range(const TypeInfo& info) {
+    Cell cell;
+    if (info.value_bits <= 8) {
+        if (info.is_signed) {
+            cell << '-' << info.min_magnitude;
+        } else {
+            cell << std::uint64_t{0};
+        }
+        cell << " to " << info.max;
+    } else if (info.is_signed) {
+        std::uint64_t power = info.value_bits - 1;
+        cell << "-2^" << power << " to 2^" << power << "-1";
+    } else {
+        cell << "0 to 2^" << std::uint64_t{info.value_bits} << "-1";
+    }
+    return cell;
+}
+
+// Markdown table of the given types, in the style of the tables in primitive_types.cpp
+template <std::size_t Capacity>
+constexpr void type_table(Text<Capacity>& out, std::string_view title, std::initializer_list<TypeInfo> types) {
+    out << "### " << title << '\n';
+    out << "| Type                  | Size     | Align    | Bits     | Value bits | Signed | Range                     |\n";
+    out << "|-----------------------|----------|----------|----------|------------|--------|---------------------------|\n";
+    for (const TypeInfo& info : types) {
+        Cell name;
+        name << '`' << info.name << '`';
+        Cell size;
+        size << std::uint64_t{info.size} << (info.size == 1 ? " byte" : " bytes");
+        Cell align;
+        align << std::uint64_t{info.align};
+        Cell bits;
+        bits << std::uint64_t{info.bits};
+        Cell value_bits;
+        value_bits << std::uint64_t{info.value_bits};
+        out << "| ";
+        out.left(name, 21) << " | ";
+        out.left(size, 8) << " | ";
+        out.left(align, 8) << " | ";
+        out.left(bits, 8) << " | ";
+        out.left(value_bits, 10) << " | ";
+        out.left(info.is_signed ? "yes" : "no", 6) << " | ";
+        out.left(range(info), 25) << " |\n";
+    }
+    out << '\n';
+}
+
+// The type of the member a pointer-to-member points at
+template <typename M>
+struct member_type;
+
+template <typename S, typename M>
+struct member_type<M S::*> {
+    using type = M;
+};
+
+struct StructInfo {
+    std::string_view name;
+    std::size_t size;
+    std::size_t align;
+    std::size_t members;
+    std::size_t member_bytes; // What the members need
+    std::size_t padding;      // What the compiler added for alignment: size - member bytes
+    std::size_t reordered;    // Size with the members sorted from the largest alignment down
+};
+
+// Layout of struct S. C++ can't list the members of a struct by itself (yet), so they're passed as
+// pointers-to-members: structure<Point, &Point::x, &Point::y>("Point"). Leaving one out shows up as padding.
+template <typename S, auto... Members>
+constexpr StructInfo structure(std::string_view name) {
+    static_assert((std::is_member_object_pointer_v<decltype(Members)> && ...), "pass pointers to data members");
+    static_assert((std::is_same_v<decltype(Members), typename member_type<decltype(Members)>::type S::*> && ...),
+                  "every member must belong to S");
+    std::size_t member_bytes = (std::size_t{0} + ... + sizeof(typename member_type<decltype(Members)>::type));
+    if (member_bytes > sizeof(S)) {
+        throw "layout::structure: members listed twice?";
+    }
+    StructInfo info{name, sizeof(S), alignof(S), sizeof...(Members), member_bytes, sizeof(S) - member_bytes, 0};
+    // Members whose size is a multiple of their alignment (all the built-in types) leave no gaps when sorted by
+    // alignment, so only the tail padding up to the struct's alignment remains
+    info.reordered = (member_bytes + alignof(S) - 1) / alignof(S) * alignof(S);
+    return info;
+}
+
+template <std::size_t Capacity>
+constexpr void struct_table(Text<Capacity>& out, std::string_view title, std::initializer_list<StructInfo> structs) {
+    out << "### " << title << '\n';
+    out << "| Struct                | Size     | Align    | Members  | Padding  | Waste    | Reordered |\n";
+    out << "|-----------------------|----------|----------|----------|----------|----------|-----------|\n";
+    for (const StructInfo& info : structs) {
+        Cell name;
+        name << '`' << info.name << '`';
+        Cell size;
+        size << std::uint64_t{info.size};
+        Cell align;
+        align << std::uint64_t{info.align};
+        Cell members;
+        members << std::uint64_t{info.members};
+        Cell padding;
+        padding << std::uint64_t{info.padding};
+        Cell waste;
+        waste << std::uint64_t{info.padding * 100 / info.size} << '%';
+        Cell reordered;
+        reordered << std::uint64_t{info.reordered};
+        out << "| ";
+        out.left(name, 21) << " | ";
+        out.left(size, 8) << " | ";
+        out.left(align, 8) << " | ";
+        out.left(members, 8) << " | ";
+        out.left(padding, 8) << " | ";
+        out.left(waste, 8) << " | ";
+        out.left(reordered, 9) << " |\n";
+    }
+    out << '\n';
+}
+
+} // namespace layout
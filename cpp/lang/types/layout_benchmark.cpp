@@ -0,0 +1,378 @@
+// A particle simulation step (gravity, then move) and a filter (the particles below the floor), on the same
+// particles stored four ways: array of structs, AoS with the hot and cold members split into two arrays, struct
+// of arrays (soa::vector from soa.hpp) and blocks of 16 particles stored as arrays (AoSoA). Both loops are
+// memory-bandwidth bound once the particles outgrow the cache, so the layout decides how many bytes they move.
+//
+// Build: g++ -std=c++20 -O2 layout_benchmark.cpp -o layout_benchmark
+// Usage: ./layout_benchmark [max particles = 100000000]   (1M, 10M, 100M... up to max; 100M needs about 4.5 GB)
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../../testing/report.hpp"
+#include "soa.hpp"
+
+// GCC only vectorizes the simplest loops at -O2. This asks for the full vectorizer on the kernels, compiled for
+// AVX2 and for plain x86-64 with the best one picked at startup (same as OpenCV/cpp/filters.hpp)
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__) && !defined(__SANITIZE_THREAD__)
+#define VECTORIZE __attribute__((target_clones("avx2", "default"), optimize("tree-vectorize", "vect-cost-model=dynamic")))
+#elif defined(__GNUC__) && !defined(__clang__)
+#define VECTORIZE __attribute__((optimize("tree-vectorize", "vect-cost-model=dynamic")))
+#else
+#define VECTORIZE
+#endif
+
+constexpr float dt = 0.01f;
+constexpr float gravity = -9.81f;
+constexpr float floor_height = -50.0f;
+
+// ## The particles
+// 24 hot bytes that every step reads and writes, 16 cold ones that only reports and rendering need
+struct ParticleInfo {
+    std::uint32_t id;
+    std::uint32_t color;
+    float mass;
+    float charge;
+};
+
+struct Particle {
+    float x, y, z;
+    float vx, vy, vz;
+    ParticleInfo info;
+};
+
+struct ParticleHot {
+    float x, y, z;
+    float vx, vy, vz;
+};
+
+// AoSoA: 16 particles' hot members as arrays, the cold members in an array of their own as for the hot/cold split
+constexpr std::size_t lanes = 16; // 16 floats: one cache line, two AVX2 registers
+struct ParticleBlock {
+    float x[lanes], y[lanes], z[lanes];
+    float vx[lanes], vy[lanes], vz[lanes];
+};
+
+// Particle i, the same for every layout: a hash of i, so no layout has to be built from another
+Particle make_particle(std::size_t i) {
+    std::uint64_t h = (i + 1) * 0x9e3779b97f4a7c15ull;
+    auto next = [&] {
+        h ^= h >> 29;
+        h *= 0xbf58476d1ce4e5b9ull;
+        h ^= h >> 32;
+        return static_cast<float>(h % 20001) / 100.0f - 100.0f; // -100..100
+    };
+    Particle p;
+    p.x = next();
+    p.y = next();
+    p.z = next();
+    p.vx = next() / 10;
+    p.vy = next() / 10;
+    p.vz = next() / 10;
+    p.info = ParticleInfo{static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(h), 1.0f, 0.0f};
+    return p;
+}
+
+// ## The kernels
+// Every layout runs the same arithmetic in the same order, so they all end with bit-identical positions.
+// The filter writes the index of every particle below the floor: written always, kept only when it matches
+// (count += condition), so there's no branch to mispredict on random data
+VECTORIZE void update(Particle* p, std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+        p[i].vy += gravity * dt;
+        p[i].x += p[i].vx * dt;
+        p[i].y += p[i].vy * dt;
+        p[i].z += p[i].vz * dt;
+    }
+}
+
+VECTORIZE void update(ParticleHot* p, std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+        p[i].vy += gravity * dt;
+        p[i].x += p[i].vx * dt;
+        p[i].y += p[i].vy * dt;
+        p[i].z += p[i].vz * dt;
+    }
+}
+
+VECTORIZE void update(float* __restrict x, float* __restrict y, float* __restrict z, const float* __restrict vx,
+                      float* __restrict vy, const float* __restrict vz, std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+        vy[i] += gravity * dt;
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        z[i] += vz[i] * dt;
+    }
+}
+
+VECTORIZE void update(ParticleBlock* blocks, std::size_t count) {
+    for (std::size_t b = 0; b < count; b++) {
+        ParticleBlock& block = blocks[b];
+        for (std::size_t j = 0; j < lanes; j++) {
+            block.vy[j] += gravity * dt;
+            block.x[j] += block.vx[j] * dt;
+            block.y[j] += block.vy[j] * dt;
+            block.z[j] += block.vz[j] * dt;
+        }
+    }
+}
+
+// y of particle i, wherever the layout keeps it
+template <typename GetY>
+std::size_t filter(std::size_t n, std::uint32_t* out, GetY y) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        out[count] = static_cast<std::uint32_t>(i);
+        count += y(i) < floor_height;
+    }
+    return count;
+}
+
+// ## The layouts
+class Aos {
+public:
+    static constexpr const char* name = "AoS";
+    static constexpr int update_reads = sizeof(Particle); // Cache lines are read whole: the cold bytes come along
+    static constexpr int filter_reads = sizeof(Particle);
+    explicit Aos(std::size_t n) : particles_(n) {
+        for (std::size_t i = 0; i < n; i++) {
+            particles_[i] = make_particle(i);
+        }
+    }
+    void update() { ::update(particles_.data(), particles_.size()); }
+    std::size_t filter(std::uint32_t* out) const {
+        const Particle* p = particles_.data();
+        return ::filter(particles_.size(), out, [p](std::size_t i) { return p[i].y; });
+    }
+    Particle get(std::size_t i) const { return particles_[i]; }
+
+private:
+    std::vector<Particle> particles_;
+};
+
+// Hot members in one array, cold ones in another, same index
+class AosHotCold {
+public:
+    static constexpr const char* name = "AoS, hot/cold split";
+    static constexpr int update_reads = sizeof(ParticleHot);
+    static constexpr int filter_reads = sizeof(ParticleHot);
+    explicit AosHotCold(std::size_t n) : hot_(n), cold_(n) {
+        for (std::size_t i = 0; i < n; i++) {
+            Particle p = make_particle(i);
+            hot_[i] = ParticleHot{p.x, p.y, p.z, p.vx, p.vy, p.vz};
+            cold_[i] = p.info;
+        }
+    }
+    void update() { ::update(hot_.data(), hot_.size()); }
+    std::size_t filter(std::uint32_t* out) const {
+        const ParticleHot* p = hot_.data();
+        return ::filter(hot_.size(), out, [p](std::size_t i) { return p[i].y; });
+    }
+    Particle get(std::size_t i) const {
+        const ParticleHot& h = hot_[i];
+        return Particle{h.x, h.y, h.z, h.vx, h.vy, h.vz, cold_[i]};
+    }
+
+private:
+    std::vector<ParticleHot> hot_;
+    std::vector<ParticleInfo> cold_;
+};
+
+// One column per hot member; the cold members stay together in one column of ParticleInfo
+class Soa {
+public:
+    static constexpr const char* name = "SoA (soa::vector)";
+    static constexpr int update_reads = sizeof(ParticleHot);
+    static constexpr int filter_reads = sizeof(float);
+    explicit Soa(std::size_t n) {
+        particles_.resize(n);
+        for (std::size_t i = 0; i < n; i++) {
+            particles_[i] = make_particle(i);
+        }
+    }
+    void update() {
+        ::update(particles_.data<&Particle::x>(), particles_.data<&Particle::y>(), particles_.data<&Particle::z>(),
+                 particles_.data<&Particle::vx>(), particles_.data<&Particle::vy>(), particles_.data<&Particle::vz>(),
+                 particles_.size());
+    }
+    std::size_t filter(std::uint32_t* out) const {
+        const float* y = particles_.data<&Particle::y>();
+        return ::filter(particles_.size(), out, [y](std::size_t i) { return y[i]; });
+    }
+    Particle get(std::size_t i) const { return particles_[i]; }
+
+private:
+    soa::vector<Particle, &Particle::x, &Particle::y, &Particle::z, &Particle::vx, &Particle::vy, &Particle::vz,
+                &Particle::info> particles_;
+};
+
+// Blocks of `lanes` particles, plus the cold members. The last block is padded with zeros, which the update moves
+// around harmlessly
+class Aosoa {
+public:
+    static constexpr const char* name = "AoSoA, 16 per block";
+    static constexpr int update_reads = sizeof(ParticleHot);
+    static constexpr int filter_reads = sizeof(float);
+    explicit Aosoa(std::size_t n) : size_(n), blocks_((n + lanes - 1) / lanes), cold_(n) {
+        for (std::size_t i = 0; i < n; i++) {
+            Particle p = make_particle(i);
+            ParticleBlock& block = blocks_[i / lanes];
+            std::size_t j = i % lanes;
+            block.x[j] = p.x;
+            block.y[j] = p.y;
+            block.z[j] = p.z;
+            block.vx[j] = p.vx;
+            block.vy[j] = p.vy;
+            block.vz[j] = p.vz;
+            cold_[i] = p.info;
+        }
+    }
+    void update() { ::update(blocks_.data(), blocks_.size()); }
+    std::size_t filter(std::uint32_t* out) const {
+        std::size_t count = 0;
+        std::size_t full = size_ / lanes;
+        for (std::size_t b = 0; b < full; b++) {
+            const float* y = blocks_[b].y;
+            for (std::size_t j = 0; j < lanes; j++) {
+                out[count] = static_cast<std::uint32_t>(b * lanes + j);
+                count += y[j] < floor_height;
+            }
+        }
+        for (std::size_t i = full * lanes; i < size_; i++) { // The last block may be partial
+            out[count] = static_cast<std::uint32_t>(i);
+            count += blocks_[full].y[i - full * lanes] < floor_height;
+        }
+        return count;
+    }
+    Particle get(std::size_t i) const {
+        const ParticleBlock& b = blocks_[i / lanes];
+        std::size_t j = i % lanes;
+        return Particle{b.x[j], b.y[j], b.z[j], b.vx[j], b.vy[j], b.vz[j], cold_[i]};
+    }
+
+private:
+    std::size_t size_;
+    std::vector<ParticleBlock> blocks_;
+    std::vector<ParticleInfo> cold_;
+};
+
+// ## Measuring
+struct Check {
+    double positions = 0;       // Sum of all coordinates after one step
+    std::uint64_t matches = 0;  // Particles below the floor
+    std::uint64_t index_sum = 0; // Sum of their indices
+    std::uint64_t id_sum = 0;    // Sum of their ids, from the cold members
+};
+
+template <typename Layout>
+Check check(Layout& layout, std::size_t n, std::vector<std::uint32_t>& out) {
+    Check result;
+    layout.update();
+    result.matches = layout.filter(out.data());
+    for (std::size_t i = 0; i < n; i++) {
+        Particle p = layout.get(i);
+        result.positions += static_cast<double>(p.x) + p.y + p.z;
+    }
+    for (std::size_t k = 0; k < result.matches; k++) {
+        result.index_sum += out[k];
+        result.id_sum += layout.get(out[k]).info.id;
+    }
+    return result;
+}
+
+template <typename F>
+double seconds(F&& work) {
+    auto begin = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// ns per particle: one run to warm up, then runs until half a second has passed (at least 3)
+template <typename F>
+double ns_per_particle(std::size_t n, F&& work) {
+    work();
+    int runs = 0;
+    double total = 0;
+    while (runs < 3 || total < 0.5) {
+        total += seconds(work);
+        runs++;
+    }
+    return total * 1e9 / static_cast<double>(runs) / static_cast<double>(n);
+}
+
+void compare(const Check& result, const Check& reference, const char* name, std::size_t n) {
+    if (result.positions != reference.positions || result.matches != reference.matches ||
+        result.index_sum != reference.index_sum || result.id_sum != reference.id_sum) {
+        std::cerr << "ERROR: " << name << " disagrees with AoS at " << n << " particles" << std::endl;
+        std::exit(1);
+    }
+}
+
+// Every layout against AoS at an odd size: a partial AoSoA block, padding at the end of the SoA columns
+void verify() {
+    constexpr std::size_t n = 1003;
+    std::vector<std::uint32_t> out(n);
+    Aos aos(n);
+    Check reference = check(aos, n, out);
+    AosHotCold hot_cold(n);
+    compare(check(hot_cold, n, out), reference, AosHotCold::name, n);
+    Soa soa(n);
+    compare(check(soa, n, out), reference, Soa::name, n);
+    Aosoa aosoa(n);
+    compare(check(aosoa, n, out), reference, Aosoa::name, n);
+}
+
+// One step moves 40 bytes per particle: x, y, z, vx, vy and vz in, x, y, z and vy out
+constexpr int step_bytes = 40;
+
+template <typename Layout>
+void measure(std::size_t n, std::vector<std::uint32_t>& out, Check& reference) {
+    Layout layout(n); // Only one layout in memory at a time
+    Check result = check(layout, n, out);
+    if (std::is_same_v<Layout, Aos>) {
+        reference = result;
+    }
+    compare(result, reference, Layout::name, n);
+    double update_ns = ns_per_particle(n, [&] { layout.update(); });
+    double filter_ns = ns_per_particle(n, [&] { layout.filter(out.data()); });
+    std::cout << "| " << std::setw(22) << std::left << Layout::name << std::right << " | " << std::setw(12)
+              << Layout::update_reads << " | " << std::setw(13) << update_ns << " | " << std::setw(11)
+              << step_bytes / update_ns << " | " << std::setw(12) << Layout::filter_reads << " | " << std::setw(13)
+              << filter_ns << " |\n";
+    std::string row = std::string(Layout::name) + ", " + std::to_string(n) + " particles";
+    bench::report(row + ": update", update_ns, "ns");
+    bench::report(row + ": filter", filter_ns, "ns");
+}
+
+void run(std::size_t n) {
+    std::vector<std::uint32_t> out(n);
+    Check reference;
+    std::cout << "## " << n << " particles, " << n * sizeof(Particle) / 1000000 << " MB as AoS\n\n";
+    std::cout << "| Layout                 | Update reads | Update ns/ptc | Update GB/s | Filter reads | Filter ns/ptc |\n";
+    std::cout << "|------------------------|--------------|---------------|-------------|--------------|---------------|\n";
+    std::cout << std::fixed << std::setprecision(2);
+    measure<Aos>(n, out, reference);
+    measure<AosHotCold>(n, out, reference);
+    measure<Soa>(n, out, reference);
+    measure<Aosoa>(n, out, reference);
+    std::cout << '\n';
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t max = argc > 1 ? std::stoull(argv[1]) : 100000000;
+
+    verify();
+    for (std::size_t n = std::min<std::size_t>(1000000, max); n <= max; n *= 10) {
+        run(n);
+    }
+    std::cout << "Reads: bytes per particle the loop pulls from memory. Update GB/s: the " << step_bytes
+              << " bytes per particle a step reads and writes, over the time it took" << std::endl;
+}
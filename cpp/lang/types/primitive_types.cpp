@@ -2,8 +2,8 @@
 #include <uchar.h>
 
 #include <iostream>
-#include <iomanip>
-#include <string>
+
+#include "layout.hpp"
 
 // TODO: typedef instead of alias in comments?
 // TODO: void type
@@ -83,6 +83,9 @@
 // the table, albeit at the cost of higher memory consumption. This type allows programmer to
 // specify the minimum size he requires, and for the compiler to determine the most optimal type
 // for performance. In most circumstances, that would be an alias of `int`.
+// On x86-64 Linux int_fast16_t and int_fast32_t are 64 bits wide. That's free for a single variable, but an array
+// of them takes 2-4x the memory and fits 2-4x fewer elements in a SIMD register - simd/simd_benchmark.cpp
+// measures both cases.
 //
 // | Type                          | Min Size     | Range                     |
 // |-------------------------------|--------------|---------------------------|
@@ -121,105 +124,76 @@
 // ** long: 32 bits on Windows (LLP64), 64 bits on Linux/macOS (LP64)
 // *** wchar_t: 16 bits on Windows, 32 bits on Linux/macOS
 
+// The tables below are built at compile time by layout.hpp: `sizes` is a constant char array in the binary,
+// and printing it is a single write instead of a stream of << and std::endl (every std::endl flushes)
+constexpr auto sizes = [] {
+    layout::Text<8192> text;
+    text << "## Sizes\n";
+    layout::type_table(text, "Boolean Type", {layout::type<bool>("bool")});
+    layout::type_table(text, "Signed Integer Types", {
+        layout::type<signed char>("signed char"),
+        layout::type<short>("short"),
+        layout::type<int>("int"),
+        layout::type<long>("long"),
+        layout::type<long long>("long long"),
+    });
+    layout::type_table(text, "Unsigned Integer Types", {
+        layout::type<unsigned char>("unsigned char"),
+        layout::type<unsigned short>("unsigned short"),
+        layout::type<unsigned int>("unsigned int"),
+        layout::type<unsigned long>("unsigned long"),
+        layout::type<unsigned long long>("unsigned long long"),
+    });
+    layout::type_table(text, "Fixed-width Integer Types", {
+        layout::type<int8_t>("int8_t"),
+        layout::type<int16_t>("int16_t"),
+        layout::type<int32_t>("int32_t"),
+        layout::type<int64_t>("int64_t"),
+        layout::type<uint8_t>("uint8_t"),
+        layout::type<uint16_t>("uint16_t"),
+        layout::type<uint32_t>("uint32_t"),
+        layout::type<uint64_t>("uint64_t"),
+    });
+    layout::type_table(text, "Minimum-width Integer Types", {
+        layout::type<int_least8_t>("int_least8_t"),
+        layout::type<int_least16_t>("int_least16_t"),
+        layout::type<int_least32_t>("int_least32_t"),
+        layout::type<int_least64_t>("int_least64_t"),
+        layout::type<uint_least8_t>("uint_least8_t"),
+        layout::type<uint_least16_t>("uint_least16_t"),
+        layout::type<uint_least32_t>("uint_least32_t"),
+        layout::type<uint_least64_t>("uint_least64_t"),
+    });
+    layout::type_table(text, "Fastest Integer Types", {
+        layout::type<int_fast8_t>("int_fast8_t"),
+        layout::type<int_fast16_t>("int_fast16_t"),
+        layout::type<int_fast32_t>("int_fast32_t"),
+        layout::type<int_fast64_t>("int_fast64_t"),
+        layout::type<uint_fast8_t>("uint_fast8_t"),
+        layout::type<uint_fast16_t>("uint_fast16_t"),
+        layout::type<uint_fast32_t>("uint_fast32_t"),
+        layout::type<uint_fast64_t>("uint_fast64_t"),
+    });
+    layout::type_table(text, "Pointer and Maximum Integer Types", {
+        layout::type<intptr_t>("intptr_t"),
+        layout::type<uintptr_t>("uintptr_t"),
+        layout::type<intmax_t>("intmax_t"),
+        layout::type<uintmax_t>("uintmax_t"),
+    });
+    layout::type_table(text, "Character Types", {
+        layout::type<char>("char"),
+        layout::type<signed char>("signed char"),
+        layout::type<unsigned char>("unsigned char"),
+        layout::type<wchar_t>("wchar_t"),
+        layout::type<char8_t>("char8_t"),
+        layout::type<char16_t>("char16_t"),
+        layout::type<char32_t>("char32_t"),
+    });
+    return text;
+}();
+
 void print_sizes() {
-    std::cout << "## Sizes" << std::endl;
-
-    // Boolean Type
-    std::cout << "### Boolean Type" << std::endl;
-    std::cout << "| Type                  | Size     | Bits     |" << std::endl;
-    std::cout << "|-----------------------|----------|----------|" << std::endl;
-    std::cout << "| `bool`                | " << std::setw(8) << std::left << (std::to_string(sizeof(bool)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(bool) * 8) + " bits") << " |" << std::endl;
-    std::cout << std::endl;
-
-    // Signed Integer Types
-    std::cout << "### Signed Integer Types" << std::endl;
-    std::cout << "| Type                  | Size     | Bits     |" << std::endl;
-    std::cout << "|-----------------------|----------|----------|" << std::endl;
-    std::cout << "| `signed char`         | " << std::setw(8) << std::left << (std::to_string(sizeof(signed char)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(signed char) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `short`               | " << std::setw(8) << std::left << (std::to_string(sizeof(short)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(short) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `int`                 | " << std::setw(8) << std::left << (std::to_string(sizeof(int)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(int) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `long`                | " << std::setw(8) << std::left << (std::to_string(sizeof(long)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(long) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `long long`           | " << std::setw(8) << std::left << (std::to_string(sizeof(long long)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(long long) * 8) + " bits") << " |" << std::endl;
-    std::cout << std::endl;
-
-    // Unsigned Integer Types
-    std::cout << "### Unsigned Integer Types" << std::endl;
-    std::cout << "| Type                  | Size     | Bits     |" << std::endl;
-    std::cout << "|-----------------------|----------|----------|" << std::endl;
-    std::cout << "| `unsigned char`       | " << std::setw(8) << std::left << (std::to_string(sizeof(unsigned char)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(unsigned char) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `unsigned short`      | " << std::setw(8) << std::left << (std::to_string(sizeof(unsigned short)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(unsigned short) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `unsigned int`        | " << std::setw(8) << std::left << (std::to_string(sizeof(unsigned int)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(unsigned int) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `unsigned long`       | " << std::setw(8) << std::left << (std::to_string(sizeof(unsigned long)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(unsigned long) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `unsigned long long`  | " << std::setw(8) << std::left << (std::to_string(sizeof(unsigned long long)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(unsigned long long) * 8) + " bits") << " |" << std::endl;
-    std::cout << std::endl;
-
-    // Fixed-width Integer Types
-    std::cout << "### Fixed-width Signed Integer Types" << std::endl;
-    std::cout << "| Type                  | Size     | Bits     |" << std::endl;
-    std::cout << "|-----------------------|----------|----------|" << std::endl;
-    std::cout << "| `int8_t`              | " << std::setw(8) << std::left << (std::to_string(sizeof(int8_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(int8_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `int16_t`             | " << std::setw(8) << std::left << (std::to_string(sizeof(int16_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(int16_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `int32_t`             | " << std::setw(8) << std::left << (std::to_string(sizeof(int32_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(int32_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `int64_t`             | " << std::setw(8) << std::left << (std::to_string(sizeof(int64_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(int64_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "|                       |          |          |" << std::endl;
-    std::cout << "| `uint8_t`             | " << std::setw(8) << std::left << (std::to_string(sizeof(uint8_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(uint8_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `uint16_t`            | " << std::setw(8) << std::left << (std::to_string(sizeof(uint16_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(uint16_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `uint32_t`            | " << std::setw(8) << std::left << (std::to_string(sizeof(uint32_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(uint32_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `uint64_t`            | " << std::setw(8) << std::left << (std::to_string(sizeof(uint64_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(uint64_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << std::endl;
-
-    // Minimum-width Integer Types
-    std::cout << "### Minimum-width Integer Types" << std::endl;
-    std::cout << "| Type                  | Size     | Bits     |" << std::endl;
-    std::cout << "|-----------------------|----------|----------|" << std::endl;
-    std::cout << "| `int_least8_t`        | " << std::setw(8) << std::left << (std::to_string(sizeof(int_least8_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(int_least8_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `int_least16_t`       | " << std::setw(8) << std::left << (std::to_string(sizeof(int_least16_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(int_least16_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `int_least32_t`       | " << std::setw(8) << std::left << (std::to_string(sizeof(int_least32_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(int_least32_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `int_least64_t`       | " << std::setw(8) << std::left << (std::to_string(sizeof(int_least64_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(int_least64_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "|                       |          |          |" << std::endl;
-    std::cout << "| `uint_least8_t`       | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_least8_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_least8_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `uint_least16_t`      | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_least16_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_least16_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `uint_least32_t`      | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_least32_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_least32_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `uint_least64_t`      | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_least64_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_least64_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << std::endl;
-
-    // Fastest Integer Types
-    std::cout << "### Fastest Integer Types" << std::endl;
-    std::cout << "| Type                  | Size     | Bits     |" << std::endl;
-    std::cout << "|-----------------------|----------|----------|" << std::endl;
-    std::cout << "| `int_fast8_t`         | " << std::setw(8) << std::left << (std::to_string(sizeof(int_fast8_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(int_fast8_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `int_fast16_t`        | " << std::setw(8) << std::left << (std::to_string(sizeof(int_fast16_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(int_fast16_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `int_fast32_t`        | " << std::setw(8) << std::left << (std::to_string(sizeof(int_fast32_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(int_fast32_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `int_fast64_t`        | " << std::setw(8) << std::left << (std::to_string(sizeof(int_fast64_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(int_fast64_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "|                       |          |          |" << std::endl;
-    std::cout << "| `uint_fast8_t`        | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_fast8_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_fast8_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `uint_fast16_t`       | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_fast16_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_fast16_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `uint_fast32_t`       | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_fast32_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_fast32_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `uint_fast64_t`       | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_fast64_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(uint_fast64_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << std::endl;
-
-    // Pointer and Maximum Integer Types
-    std::cout << "### Pointer and Maximum Integer Types" << std::endl;
-    std::cout << "| Type                  | Size     | Bits     |" << std::endl;
-    std::cout << "|-----------------------|----------|----------|" << std::endl;
-    std::cout << "| `intptr_t`            | " << std::setw(8) << std::left << (std::to_string(sizeof(intptr_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(intptr_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `uintptr_t`           | " << std::setw(8) << std::left << (std::to_string(sizeof(uintptr_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(uintptr_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `intmax_t`            | " << std::setw(8) << std::left << (std::to_string(sizeof(intmax_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(intmax_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `uintmax_t`           | " << std::setw(8) << std::left << (std::to_string(sizeof(uintmax_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(uintmax_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << std::endl;
-
-    // Character Types
-    std::cout << "### Character Types" << std::endl;
-    std::cout << "| Type                  | Size     | Bits     |" << std::endl;
-    std::cout << "|-----------------------|----------|----------|" << std::endl;
-    std::cout << "| `char`                | " << std::setw(8) << std::left << (std::to_string(sizeof(char)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(char) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `signed char`         | " << std::setw(8) << std::left << (std::to_string(sizeof(signed char)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(signed char) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `unsigned char`       | " << std::setw(8) << std::left << (std::to_string(sizeof(unsigned char)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(unsigned char) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `wchar_t`             | " << std::setw(8) << std::left << (std::to_string(sizeof(wchar_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(wchar_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `char8_t`             | " << std::setw(8) << std::left << (std::to_string(sizeof(char8_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(char8_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `char16_t`            | " << std::setw(8) << std::left << (std::to_string(sizeof(char16_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(char16_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << "| `char32_t`            | " << std::setw(8) << std::left << (std::to_string(sizeof(char32_t)) + " bytes") << " | " << std::setw(8) << std::left << (std::to_string(sizeof(char32_t) * 8) + " bits") << " |" << std::endl;
-    std::cout << std::endl;
+    std::cout << sizes.view() << std::flush;
 }
 
 int main() {
@@ -0,0 +1,105 @@
+// Runtime dispatch: one table of kernels per implementation and element type, and a CPU check that decides
+// which implementations may be used
+
+#include <cstdint>
+
+#include "kernels.hpp"
+#include "kernels_generic.hpp"
+
+namespace simd {
+
+#if defined(__x86_64__)
+namespace sse2 {
+template <typename T>
+Kernels<T> table(); // kernels_sse2.cpp
+}
+namespace avx2 {
+template <typename T>
+Kernels<T> table(); // kernels_avx2.cpp
+}
+#endif
+
+const char* name(Impl impl) {
+    switch (impl) {
+    case Impl::scalar:
+        return "scalar";
+    case Impl::autovec:
+        return "autovec";
+    case Impl::sse2:
+        return "SSE2";
+    case Impl::avx2:
+        return "AVX2";
+    }
+    return "?";
+}
+
+bool supported(Impl impl) {
+    switch (impl) {
+    case Impl::scalar:
+    case Impl::autovec:
+        return true;
+#if defined(__x86_64__)
+    case Impl::sse2:
+        return true; // Part of x86-64 itself
+    case Impl::avx2: {
+        // Reads CPUID (and checks the OS saves the 256-bit registers) once, the first time it's called
+        static const bool avx2 = __builtin_cpu_supports("avx2");
+        return avx2;
+    }
+#else
+    case Impl::sse2:
+    case Impl::avx2:
+        return false;
+#endif
+    }
+    return false;
+}
+
+Impl best() {
+    static const Impl impl = supported(Impl::avx2) ? Impl::avx2 : supported(Impl::sse2) ? Impl::sse2 : Impl::autovec;
+    return impl;
+}
+
+template <typename T>
+const Kernels<T>* kernels(Impl impl) {
+    if (!supported(impl)) {
+        return nullptr;
+    }
+    // Each table is built the first time its branch is taken, so nothing from kernels_avx2.cpp runs before
+    // supported() has said yes
+    switch (impl) {
+    case Impl::scalar: {
+        static const Kernels<T> scalar = scalar_table<T>();
+        return &scalar;
+    }
+    case Impl::autovec: {
+        static const Kernels<T> autovec = autovec_table<T>();
+        return &autovec;
+    }
+#if defined(__x86_64__)
+    case Impl::sse2: {
+        static const Kernels<T> sse2 = sse2::table<T>();
+        return &sse2;
+    }
+    case Impl::avx2: {
+        static const Kernels<T> avx2 = avx2::table<T>();
+        return &avx2;
+    }
+#else
+    default:
+        break;
+#endif
+    }
+    return nullptr;
+}
+
+template const Kernels<std::int8_t>* kernels(Impl);
+template const Kernels<std::uint8_t>* kernels(Impl);
+template const Kernels<std::int16_t>* kernels(Impl);
+template const Kernels<std::uint16_t>* kernels(Impl);
+template const Kernels<std::int32_t>* kernels(Impl);
+template const Kernels<std::uint32_t>* kernels(Impl);
+template const Kernels<std::int64_t>* kernels(Impl);
+template const Kernels<std::uint64_t>* kernels(Impl);
+
+} // namespace simd
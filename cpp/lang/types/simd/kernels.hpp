@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Vectorized kernels over the fixed-width integer types from primitive_types.cpp
+//
+// Every kernel exists in four implementations:
+//   * scalar  - one element at a time, with compiler auto-vectorization switched off (the reference)
+//   * autovec - plain loops written so the compiler can vectorize them (kernels_generic.hpp)
+//   * sse2    - hand-written SSE2 intrinsics, available on every x86-64 CPU (kernels_sse2.cpp)
+//   * avx2    - hand-written AVX2 intrinsics, 2x wider, picked at runtime only if the CPU has it (kernels_avx2.cpp)
+//
+// Build: g++ -std=c++20 -O2 simd_benchmark.cpp kernels.cpp kernels_sse2.cpp kernels_avx2.cpp -o simd_benchmark
+// No -mavx2 needed: only kernels_avx2.cpp is compiled for AVX2, and it's only called after a CPU check.
+
+namespace simd {
+
+// 64-bit type with the signedness of T. Sums and dot products are returned in it, so the sum of int8_t values
+// doesn't overflow after a few hundred elements. For 64-bit inputs the result wraps around (modulo 2^64).
+template <typename T>
+using wide_t = std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>;
+
+template <typename T>
+struct MinMax {
+    T min;
+    T max;
+};
+
+// One implementation of every kernel for element type T
+template <typename T>
+struct Kernels {
+    wide_t<T> (*sum)(const T* data, std::size_t n);
+    MinMax<T> (*minmax)(const T* data, std::size_t n); // n must be > 0
+    wide_t<T> (*dot)(const T* a, const T* b, std::size_t n);
+    void (*prefix_sum)(const T* in, T* out, std::size_t n); // Inclusive, wraps around in T like unsigned arithmetic
+    std::size_t (*find)(const T* data, std::size_t n, T value); // Index of the first match, n if none
+};
+
+enum class Impl { scalar, autovec, sse2, avx2 };
+
+const char* name(Impl impl);
+
+// Whether the implementation was compiled in and the CPU we're running on supports it
+bool supported(Impl impl);
+
+// The fastest supported implementation, detected once at startup
+Impl best();
+
+// Explicitly instantiated for int8_t ... uint64_t. Returns nullptr if the implementation isn't supported
+template <typename T>
+const Kernels<T>* kernels(Impl impl);
+
+template <typename T>
+const Kernels<T>& kernels() { return *kernels<T>(best()); }
+
+} // namespace simd
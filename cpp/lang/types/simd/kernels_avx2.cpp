@@ -0,0 +1,233 @@
+// AVX2 kernels: 256-bit registers. The rest of the program is built for baseline x86-64, so only this file
+// is compiled for AVX2, and kernels.cpp only hands these functions out after checking the CPU supports it.
+
+// Standard headers go before the target pragma: anything inline from them compiled here as AVX2 could be the
+// copy the linker keeps for the whole program, and then crash on a CPU without AVX2
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "kernels.hpp"
+#include "kernels_generic.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+namespace simd::avx2 {
+
+// Same operations as the SSE2 Isa, for 256-bit registers. AVX2 has 64-bit compares, all the 8/16/32-bit
+// min/max and a signed 32-bit multiply, so there's less to emulate. Most instructions work on two separate
+// 128-bit lanes though - shifts and unpacks don't cross the middle of the register
+struct Isa {
+    using reg = __m256i;
+    static constexpr std::size_t bytes = 32;
+
+    static reg load(const void* ptr) { return _mm256_loadu_si256(static_cast<const __m256i*>(ptr)); }
+    static void store(void* ptr, reg x) { _mm256_storeu_si256(static_cast<__m256i*>(ptr), x); }
+    static reg zero() { return _mm256_setzero_si256(); }
+
+    static reg bit_and(reg a, reg b) { return _mm256_and_si256(a, b); }
+    static reg bit_and_not(reg a, reg b) { return _mm256_andnot_si256(a, b); } // ~a & b
+    static reg bit_or(reg a, reg b) { return _mm256_or_si256(a, b); }
+    static reg bit_xor(reg a, reg b) { return _mm256_xor_si256(a, b); }
+
+    template <typename T>
+    static reg set1(T value) {
+        if constexpr (sizeof(T) == 1) {
+            return _mm256_set1_epi8(static_cast<char>(value));
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm256_set1_epi16(static_cast<short>(value));
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm256_set1_epi32(static_cast<int>(value));
+        } else {
+            return _mm256_set1_epi64x(static_cast<long long>(value));
+        }
+    }
+
+    template <typename T>
+    static reg add(reg a, reg b) {
+        if constexpr (sizeof(T) == 1) {
+            return _mm256_add_epi8(a, b);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm256_add_epi16(a, b);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm256_add_epi32(a, b);
+        } else {
+            return _mm256_add_epi64(a, b);
+        }
+    }
+
+    template <typename T>
+    static reg cmpeq(reg a, reg b) {
+        if constexpr (sizeof(T) == 1) {
+            return _mm256_cmpeq_epi8(a, b);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm256_cmpeq_epi16(a, b);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm256_cmpeq_epi32(a, b);
+        } else {
+            return _mm256_cmpeq_epi64(a, b);
+        }
+    }
+
+    template <typename T>
+    static reg cmpgt(reg a, reg b) {
+        if constexpr (!std::is_signed_v<T>) {
+            reg flip = set1<T>(T{1} << (8 * sizeof(T) - 1));
+            return cmpgt<std::make_signed_t<T>>(_mm256_xor_si256(a, flip), _mm256_xor_si256(b, flip));
+        } else if constexpr (sizeof(T) == 1) {
+            return _mm256_cmpgt_epi8(a, b);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm256_cmpgt_epi16(a, b);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm256_cmpgt_epi32(a, b);
+        } else {
+            return _mm256_cmpgt_epi64(a, b);
+        }
+    }
+
+    template <typename T>
+    static reg min(reg a, reg b) {
+        if constexpr (std::is_same_v<T, std::int8_t>) {
+            return _mm256_min_epi8(a, b);
+        } else if constexpr (std::is_same_v<T, std::uint8_t>) {
+            return _mm256_min_epu8(a, b);
+        } else if constexpr (std::is_same_v<T, std::int16_t>) {
+            return _mm256_min_epi16(a, b);
+        } else if constexpr (std::is_same_v<T, std::uint16_t>) {
+            return _mm256_min_epu16(a, b);
+        } else if constexpr (std::is_same_v<T, std::int32_t>) {
+            return _mm256_min_epi32(a, b);
+        } else if constexpr (std::is_same_v<T, std::uint32_t>) {
+            return _mm256_min_epu32(a, b);
+        } else {
+            return _mm256_blendv_epi8(a, b, cmpgt<T>(a, b));
+        }
+    }
+
+    template <typename T>
+    static reg max(reg a, reg b) {
+        if constexpr (std::is_same_v<T, std::int8_t>) {
+            return _mm256_max_epi8(a, b);
+        } else if constexpr (std::is_same_v<T, std::uint8_t>) {
+            return _mm256_max_epu8(a, b);
+        } else if constexpr (std::is_same_v<T, std::int16_t>) {
+            return _mm256_max_epi16(a, b);
+        } else if constexpr (std::is_same_v<T, std::uint16_t>) {
+            return _mm256_max_epu16(a, b);
+        } else if constexpr (std::is_same_v<T, std::int32_t>) {
+            return _mm256_max_epi32(a, b);
+        } else if constexpr (std::is_same_v<T, std::uint32_t>) {
+            return _mm256_max_epu32(a, b);
+        } else {
+            return _mm256_blendv_epi8(b, a, cmpgt<T>(a, b));
+        }
+    }
+
+    static unsigned movemask8(reg x) { return static_cast<unsigned>(_mm256_movemask_epi8(x)); }
+
+    static reg sad_u8(reg x) { return _mm256_sad_epu8(x, _mm256_setzero_si256()); }
+    static reg madd16(reg a, reg b) { return _mm256_madd_epi16(a, b); }
+    static reg mullo16(reg a, reg b) { return _mm256_mullo_epi16(a, b); }
+
+    template <bool Signed>
+    static reg mulhi16(reg a, reg b) {
+        if constexpr (Signed) {
+            return _mm256_mulhi_epi16(a, b);
+        } else {
+            return _mm256_mulhi_epu16(a, b);
+        }
+    }
+
+    template <bool Signed>
+    static reg mul32(reg a, reg b) {
+        if constexpr (Signed) {
+            return _mm256_mul_epi32(a, b);
+        } else {
+            return _mm256_mul_epu32(a, b);
+        }
+    }
+
+    static reg srli64(reg x, int bits) { return _mm256_srli_epi64(x, bits); }
+    static reg slli64(reg x, int bits) { return _mm256_slli_epi64(x, bits); }
+    static reg unpacklo16(reg a, reg b) { return _mm256_unpacklo_epi16(a, b); }
+    static reg unpackhi16(reg a, reg b) { return _mm256_unpackhi_epi16(a, b); }
+
+    // Per 128-bit lane, like the unpacks they're made of. Fine for dot products, where a and b get the same order
+    template <bool Signed>
+    static reg widen8_low(reg x) {
+        if constexpr (Signed) {
+            return _mm256_srai_epi16(_mm256_unpacklo_epi8(x, x), 8);
+        } else {
+            return _mm256_unpacklo_epi8(x, _mm256_setzero_si256());
+        }
+    }
+
+    template <bool Signed>
+    static reg widen8_high(reg x) {
+        if constexpr (Signed) {
+            return _mm256_srai_epi16(_mm256_unpackhi_epi8(x, x), 8);
+        } else {
+            return _mm256_unpackhi_epi8(x, _mm256_setzero_si256());
+        }
+    }
+
+    template <bool Signed>
+    static reg widen32(reg x) {
+        reg high_bits = Signed ? _mm256_srai_epi32(x, 31) : _mm256_setzero_si256();
+        return _mm256_add_epi64(_mm256_unpacklo_epi32(x, high_bits), _mm256_unpackhi_epi32(x, high_bits));
+    }
+
+    static std::uint64_t hsum64(reg x) {
+        __m128i pairs = _mm_add_epi64(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+        return static_cast<std::uint64_t>(_mm_cvtsi128_si64(pairs)) + static_cast<std::uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(pairs, pairs)));
+    }
+
+    // Shifts each 128-bit lane separately - carry_lanes() fixes up the scan afterwards
+    template <int Bytes>
+    static reg shift_left_bytes(reg x) { return _mm256_slli_si256(x, Bytes); }
+
+    // After scanning both lanes separately, the upper lane still needs the total of the lower one
+    template <typename T>
+    static reg carry_lanes(reg x) {
+        T low_total = last_of_lane<T>(_mm256_castsi256_si128(x));
+        return add<T>(x, _mm256_inserti128_si256(_mm256_setzero_si256(), _mm256_castsi256_si128(set1<T>(low_total)), 1));
+    }
+
+    template <typename T>
+    static T last(reg x) { return last_of_lane<T>(_mm256_extracti128_si256(x, 1)); }
+
+private:
+    template <typename T>
+    static T last_of_lane(__m128i x) { return static_cast<T>(_mm_cvtsi128_si64(_mm_srli_si128(x, 16 - sizeof(T)))); }
+};
+
+#include "kernels_x86.inl"
+
+} // namespace simd::avx2
+
+#pragma GCC pop_options
+
+namespace simd::avx2 {
+
+// Outside the target region, so building the table is plain x86-64 code and only the kernels themselves use AVX2
+template <typename T>
+Kernels<T> table() {
+    return {sum<T>, minmax<T>, dot<T>, prefix_sum<T>, find<T>};
+}
+
+template Kernels<std::int8_t> table();
+template Kernels<std::uint8_t> table();
+template Kernels<std::int16_t> table();
+template Kernels<std::uint16_t> table();
+template Kernels<std::int32_t> table();
+template Kernels<std::uint32_t> table();
+template Kernels<std::int64_t> table();
+template Kernels<std::uint64_t> table();
+
+} // namespace simd::avx2
+
+#endif
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "kernels.hpp"
+
+// Portable implementations: the scalar reference, and the same kernels written for the auto-vectorizer.
+// Header-only templates, so they work for any integer type (the benchmark also uses them for int_fastN_t).
+
+// GCC only vectorizes cheap-to-prove loops at -O2, and the scalar reference must not be vectorized at all,
+// so both get their vectorizer settings per function instead of relying on the -O level.
+#if defined(__clang__)
+#define SIMD_SCALAR
+#define SIMD_AUTOVEC
+#define SIMD_NO_VECTORIZE _Pragma("clang loop vectorize(disable) interleave(disable)")
+#elif defined(__GNUC__)
+#define SIMD_SCALAR __attribute__((optimize("no-tree-vectorize")))
+#define SIMD_AUTOVEC __attribute__((optimize("tree-vectorize", "vect-cost-model=dynamic")))
+#define SIMD_NO_VECTORIZE
+#else
+#define SIMD_SCALAR
+#define SIMD_AUTOVEC
+#define SIMD_NO_VECTORIZE
+#endif
+
+namespace simd {
+
+// Unsigned type of the same width - signed overflow is undefined behaviour, unsigned overflow wraps
+template <typename T>
+using unsigned_t = std::make_unsigned_t<T>;
+
+namespace scalar {
+
+template <typename T>
+SIMD_SCALAR wide_t<T> sum(const T* data, std::size_t n) {
+    std::uint64_t total = 0;
+    SIMD_NO_VECTORIZE
+    for (std::size_t i = 0; i < n; i++) {
+        total += static_cast<std::uint64_t>(static_cast<wide_t<T>>(data[i]));
+    }
+    return static_cast<wide_t<T>>(total);
+}
+
+template <typename T>
+SIMD_SCALAR MinMax<T> minmax(const T* data, std::size_t n) {
+    MinMax<T> result{data[0], data[0]};
+    SIMD_NO_VECTORIZE
+    for (std::size_t i = 1; i < n; i++) {
+        if (data[i] < result.min) {
+            result.min = data[i];
+        }
+        if (data[i] > result.max) {
+            result.max = data[i];
+        }
+    }
+    return result;
+}
+
+template <typename T>
+SIMD_SCALAR wide_t<T> dot(const T* a, const T* b, std::size_t n) {
+    std::uint64_t total = 0;
+    SIMD_NO_VECTORIZE
+    for (std::size_t i = 0; i < n; i++) {
+        total += static_cast<std::uint64_t>(static_cast<wide_t<T>>(a[i])) * static_cast<std::uint64_t>(static_cast<wide_t<T>>(b[i]));
+    }
+    return static_cast<wide_t<T>>(total);
+}
+
+template <typename T>
+SIMD_SCALAR void prefix_sum(const T* in, T* out, std::size_t n) {
+    unsigned_t<T> running = 0;
+    SIMD_NO_VECTORIZE
+    for (std::size_t i = 0; i < n; i++) {
+        running += static_cast<unsigned_t<T>>(in[i]);
+        out[i] = static_cast<T>(running);
+    }
+}
+
+template <typename T>
+SIMD_SCALAR std::size_t find(const T* data, std::size_t n, T value) {
+    SIMD_NO_VECTORIZE
+    for (std::size_t i = 0; i < n; i++) {
+        if (data[i] == value) {
+            return i;
+        }
+    }
+    return n;
+}
+
+} // namespace scalar
+
+namespace autovec {
+
+// Accumulating in the wide type makes the compiler widen inside the vector registers
+template <typename T>
+SIMD_AUTOVEC wide_t<T> sum(const T* data, std::size_t n) {
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        total += static_cast<std::uint64_t>(static_cast<wide_t<T>>(data[i]));
+    }
+    return static_cast<wide_t<T>>(total);
+}
+
+// No branches on the data - a conditional assignment the compiler can turn into a vector min/max
+template <typename T>
+SIMD_AUTOVEC MinMax<T> minmax(const T* data, std::size_t n) {
+    T low = data[0];
+    T high = data[0];
+    for (std::size_t i = 1; i < n; i++) {
+        low = data[i] < low ? data[i] : low;
+        high = data[i] > high ? data[i] : high;
+    }
+    return {low, high};
+}
+
+template <typename T>
+SIMD_AUTOVEC wide_t<T> dot(const T* a, const T* b, std::size_t n) {
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        total += static_cast<std::uint64_t>(static_cast<wide_t<T>>(a[i])) * static_cast<std::uint64_t>(static_cast<wide_t<T>>(b[i]));
+    }
+    return static_cast<wide_t<T>>(total);
+}
+
+// Every element depends on the previous one - compilers don't vectorize scans, so this is the scalar loop again
+template <typename T>
+SIMD_AUTOVEC void prefix_sum(const T* in, T* out, std::size_t n) {
+    unsigned_t<T> running = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        running += static_cast<unsigned_t<T>>(in[i]);
+        out[i] = static_cast<T>(running);
+    }
+}
+
+// Loops with an early exit aren't vectorized (the trip count isn't known in advance). Checking fixed-size
+// blocks without an exit and only then looking for the exact index gives the vectorizer a loop it can handle.
+template <typename T>
+SIMD_AUTOVEC std::size_t find(const T* data, std::size_t n, T value) {
+    constexpr std::size_t block = 64 / sizeof(T) * 2; // two cache lines
+    std::size_t i = 0;
+    for (; i + block <= n; i += block) {
+        unsigned found = 0;
+        for (std::size_t j = 0; j < block; j++) {
+            found |= data[i + j] == value ? 1u : 0u;
+        }
+        if (found != 0) {
+            break;
+        }
+    }
+    for (; i < n; i++) {
+        if (data[i] == value) {
+            return i;
+        }
+    }
+    return n;
+}
+
+} // namespace autovec
+
+template <typename T>
+Kernels<T> scalar_table() {
+    return {scalar::sum<T>, scalar::minmax<T>, scalar::dot<T>, scalar::prefix_sum<T>, scalar::find<T>};
+}
+
+template <typename T>
+Kernels<T> autovec_table() {
+    return {autovec::sum<T>, autovec::minmax<T>, autovec::dot<T>, autovec::prefix_sum<T>, autovec::find<T>};
+}
+
+} // namespace simd
@@ -0,0 +1,218 @@
+// SSE2 kernels: 128-bit registers, part of the x86-64 baseline so they need no CPU check
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "kernels.hpp"
+#include "kernels_generic.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+
+namespace simd::sse2 {
+
+// The operations the kernels need, for 128-bit registers. SSE2 is missing a few of them (64-bit compares,
+// most min/max, 32-bit signed multiply) - those are built from the 32-bit instructions it does have
+struct Isa {
+    using reg = __m128i;
+    static constexpr std::size_t bytes = 16;
+
+    static reg load(const void* ptr) { return _mm_loadu_si128(static_cast<const __m128i*>(ptr)); }
+    static void store(void* ptr, reg x) { _mm_storeu_si128(static_cast<__m128i*>(ptr), x); }
+    static reg zero() { return _mm_setzero_si128(); }
+
+    static reg bit_and(reg a, reg b) { return _mm_and_si128(a, b); }
+    static reg bit_and_not(reg a, reg b) { return _mm_andnot_si128(a, b); } // ~a & b
+    static reg bit_or(reg a, reg b) { return _mm_or_si128(a, b); }
+    static reg bit_xor(reg a, reg b) { return _mm_xor_si128(a, b); }
+
+    template <typename T>
+    static reg set1(T value) {
+        if constexpr (sizeof(T) == 1) {
+            return _mm_set1_epi8(static_cast<char>(value));
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm_set1_epi16(static_cast<short>(value));
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm_set1_epi32(static_cast<int>(value));
+        } else {
+            return _mm_set1_epi64x(static_cast<long long>(value));
+        }
+    }
+
+    template <typename T>
+    static reg add(reg a, reg b) {
+        if constexpr (sizeof(T) == 1) {
+            return _mm_add_epi8(a, b);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm_add_epi16(a, b);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm_add_epi32(a, b);
+        } else {
+            return _mm_add_epi64(a, b);
+        }
+    }
+
+    template <typename T>
+    static reg cmpeq(reg a, reg b) {
+        if constexpr (sizeof(T) == 1) {
+            return _mm_cmpeq_epi8(a, b);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm_cmpeq_epi16(a, b);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm_cmpeq_epi32(a, b);
+        } else {
+            // Both 32-bit halves equal: AND each half with its neighbour
+            reg equal = _mm_cmpeq_epi32(a, b);
+            return _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+    }
+
+    // a > b, all bits set in the lanes where it's true
+    template <typename T>
+    static reg cmpgt(reg a, reg b) {
+        if constexpr (!std::is_signed_v<T>) {
+            // Flipping the sign bit maps unsigned order onto signed order
+            reg flip = set1<T>(T{1} << (8 * sizeof(T) - 1));
+            return cmpgt<std::make_signed_t<T>>(_mm_xor_si128(a, flip), _mm_xor_si128(b, flip));
+        } else if constexpr (sizeof(T) == 1) {
+            return _mm_cmpgt_epi8(a, b);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm_cmpgt_epi16(a, b);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm_cmpgt_epi32(a, b);
+        } else {
+            // High halves greater, or equal and the low halves greater as unsigned. The answer ends up in the
+            // high half of each lane and is copied to the low half
+            reg flip = _mm_set1_epi32(static_cast<int>(0x80000000u));
+            reg high_greater = _mm_cmpgt_epi32(a, b);
+            reg high_equal = _mm_cmpeq_epi32(a, b);
+            reg low_greater = _mm_slli_epi64(_mm_cmpgt_epi32(_mm_xor_si128(a, flip), _mm_xor_si128(b, flip)), 32);
+            reg greater = _mm_or_si128(high_greater, _mm_and_si128(high_equal, low_greater));
+            return _mm_shuffle_epi32(greater, _MM_SHUFFLE(3, 3, 1, 1));
+        }
+    }
+
+    template <typename T>
+    static reg min(reg a, reg b) {
+        if constexpr (std::is_same_v<T, std::uint8_t>) {
+            return _mm_min_epu8(a, b);
+        } else if constexpr (std::is_same_v<T, std::int16_t>) {
+            return _mm_min_epi16(a, b);
+        } else {
+            reg greater = cmpgt<T>(a, b);
+            return _mm_or_si128(_mm_and_si128(greater, b), _mm_andnot_si128(greater, a));
+        }
+    }
+
+    template <typename T>
+    static reg max(reg a, reg b) {
+        if constexpr (std::is_same_v<T, std::uint8_t>) {
+            return _mm_max_epu8(a, b);
+        } else if constexpr (std::is_same_v<T, std::int16_t>) {
+            return _mm_max_epi16(a, b);
+        } else {
+            reg greater = cmpgt<T>(a, b);
+            return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+        }
+    }
+
+    static unsigned movemask8(reg x) { return static_cast<unsigned>(_mm_movemask_epi8(x)); }
+
+    static reg sad_u8(reg x) { return _mm_sad_epu8(x, _mm_setzero_si128()); }
+    static reg madd16(reg a, reg b) { return _mm_madd_epi16(a, b); }
+    static reg mullo16(reg a, reg b) { return _mm_mullo_epi16(a, b); }
+
+    template <bool Signed>
+    static reg mulhi16(reg a, reg b) {
+        if constexpr (Signed) {
+            return _mm_mulhi_epi16(a, b);
+        } else {
+            return _mm_mulhi_epu16(a, b);
+        }
+    }
+
+    // Products of the even 32-bit lanes as 64-bit lanes
+    template <bool Signed>
+    static reg mul32(reg a, reg b) {
+        reg product = _mm_mul_epu32(a, b);
+        if constexpr (Signed) {
+            // SSE2 only has the unsigned multiply. Reading a negative x as unsigned adds 2^32, so the unsigned
+            // product is too big by b << 32 when a < 0 and by a << 32 when b < 0
+            reg a_fix = _mm_slli_epi64(_mm_and_si128(_mm_srai_epi32(a, 31), b), 32);
+            reg b_fix = _mm_slli_epi64(_mm_and_si128(_mm_srai_epi32(b, 31), a), 32);
+            product = _mm_sub_epi64(_mm_sub_epi64(product, a_fix), b_fix);
+        }
+        return product;
+    }
+
+    static reg srli64(reg x, int bits) { return _mm_srli_epi64(x, bits); }
+    static reg slli64(reg x, int bits) { return _mm_slli_epi64(x, bits); }
+    static reg unpacklo16(reg a, reg b) { return _mm_unpacklo_epi16(a, b); }
+    static reg unpackhi16(reg a, reg b) { return _mm_unpackhi_epi16(a, b); }
+
+    // Bytes to 16-bit lanes, sign- or zero-extended
+    template <bool Signed>
+    static reg widen8_low(reg x) {
+        if constexpr (Signed) {
+            return _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8);
+        } else {
+            return _mm_unpacklo_epi8(x, _mm_setzero_si128());
+        }
+    }
+
+    template <bool Signed>
+    static reg widen8_high(reg x) {
+        if constexpr (Signed) {
+            return _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8);
+        } else {
+            return _mm_unpackhi_epi8(x, _mm_setzero_si128());
+        }
+    }
+
+    // The four 32-bit lanes as two 64-bit lanes, added pairwise (only for sums - the lane order is lost)
+    template <bool Signed>
+    static reg widen32(reg x) {
+        reg high_bits = Signed ? _mm_srai_epi32(x, 31) : _mm_setzero_si128();
+        return _mm_add_epi64(_mm_unpacklo_epi32(x, high_bits), _mm_unpackhi_epi32(x, high_bits));
+    }
+
+    static std::uint64_t hsum64(reg x) {
+        return static_cast<std::uint64_t>(_mm_cvtsi128_si64(x)) + static_cast<std::uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(x, x)));
+    }
+
+    template <int Bytes>
+    static reg shift_left_bytes(reg x) { return _mm_slli_si128(x, Bytes); }
+
+    // A 128-bit register is a single lane, there's nothing to carry across
+    template <typename T>
+    static reg carry_lanes(reg x) { return x; }
+
+    template <typename T>
+    static T last(reg x) { return static_cast<T>(_mm_cvtsi128_si64(_mm_srli_si128(x, 16 - sizeof(T)))); }
+};
+
+#include "kernels_x86.inl"
+
+} // namespace simd::sse2
+
+namespace simd::sse2 {
+
+// Kept out of kernels_x86.inl to match kernels_avx2.cpp, where the table has to be built outside the AVX2 region
+template <typename T>
+Kernels<T> table() {
+    return {sum<T>, minmax<T>, dot<T>, prefix_sum<T>, find<T>};
+}
+
+template Kernels<std::int8_t> table();
+template Kernels<std::uint8_t> table();
+template Kernels<std::int16_t> table();
+template Kernels<std::uint16_t> table();
+template Kernels<std::int32_t> table();
+template Kernels<std::uint32_t> table();
+template Kernels<std::int64_t> table();
+template Kernels<std::uint64_t> table();
+
+} // namespace simd::sse2
+
+#endif
@@ -0,0 +1,170 @@
+// Intrinsics kernels shared by kernels_sse2.cpp and kernels_avx2.cpp
+//
+// Written once against an `Isa` struct that wraps the instructions of one instruction set (128-bit SSE2 or
+// 256-bit AVX2 registers). Each .cpp file defines its Isa inside its own namespace and then includes this file,
+// so the same code is compiled twice, once per instruction set. Not a header - don't include it anywhere else.
+// The table() that hands the kernels out lives in each .cpp file, outside kernels_avx2.cpp's target region
+
+// Sum of all elements of x, as 64-bit lanes. Adds a bias of `bias<T>` per element for the types that have no
+// direct widening instruction, which sum() subtracts again at the end
+template <typename T>
+inline constexpr std::int64_t bias = std::is_same_v<T, std::int8_t>     ? 128    // sad works on unsigned bytes
+                                     : std::is_same_v<T, std::uint16_t> ? -32768 // madd works on signed words
+                                                                        : 0;
+
+template <typename T>
+Isa::reg widen_sum(Isa::reg x) {
+    if constexpr (sizeof(T) == 1) {
+        // Sum of absolute differences against zero: every 8 bytes summed into one 64-bit lane, in one instruction
+        if constexpr (std::is_signed_v<T>) {
+            x = Isa::bit_xor(x, Isa::set1<std::uint8_t>(0x80));
+        }
+        return Isa::sad_u8(x);
+    } else if constexpr (sizeof(T) == 2) {
+        // Multiply by 1 and add neighbours: pairs summed into 32-bit lanes
+        if constexpr (!std::is_signed_v<T>) {
+            x = Isa::bit_xor(x, Isa::set1<std::uint16_t>(0x8000));
+        }
+        return Isa::widen32<true>(Isa::madd16(x, Isa::set1<std::int16_t>(1)));
+    } else if constexpr (sizeof(T) == 4) {
+        return Isa::widen32<std::is_signed_v<T>>(x);
+    } else {
+        return x;
+    }
+}
+
+template <typename T>
+wide_t<T> sum(const T* data, std::size_t n) {
+    constexpr std::size_t lanes = Isa::bytes / sizeof(T);
+    typename Isa::reg acc = Isa::zero();
+    std::size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        acc = Isa::add<std::uint64_t>(acc, widen_sum<T>(Isa::load(data + i)));
+    }
+    std::uint64_t total = Isa::hsum64(acc) - static_cast<std::uint64_t>(bias<T>) * i;
+    for (; i < n; i++) {
+        total += static_cast<std::uint64_t>(static_cast<wide_t<T>>(data[i]));
+    }
+    return static_cast<wide_t<T>>(total);
+}
+
+template <typename T>
+MinMax<T> minmax(const T* data, std::size_t n) {
+    constexpr std::size_t lanes = Isa::bytes / sizeof(T);
+    MinMax<T> result{data[0], data[0]};
+    std::size_t i = 0;
+    if (n >= lanes) {
+        typename Isa::reg low = Isa::load(data);
+        typename Isa::reg high = low;
+        for (i = lanes; i + lanes <= n; i += lanes) {
+            typename Isa::reg x = Isa::load(data + i);
+            low = Isa::min<T>(low, x);
+            high = Isa::max<T>(high, x);
+        }
+        T lows[lanes];
+        T highs[lanes];
+        Isa::store(lows, low);
+        Isa::store(highs, high);
+        for (std::size_t j = 0; j < lanes; j++) {
+            result.min = lows[j] < result.min ? lows[j] : result.min;
+            result.max = highs[j] > result.max ? highs[j] : result.max;
+        }
+    }
+    for (; i < n; i++) {
+        result.min = data[i] < result.min ? data[i] : result.min;
+        result.max = data[i] > result.max ? data[i] : result.max;
+    }
+    return result;
+}
+
+// Sum of a[i] * b[i] over one register, as 64-bit lanes (modulo 2^64)
+template <typename T>
+Isa::reg widen_dot(Isa::reg a, Isa::reg b) {
+    constexpr bool is_signed = std::is_signed_v<T>;
+    if constexpr (sizeof(T) == 1) {
+        // Widen to 16 bits; a product of two bytes fits in 16 bits and madd sums pairs of them into 32 bits
+        typename Isa::reg sums = Isa::add<std::int32_t>(Isa::madd16(Isa::widen8_low<is_signed>(a), Isa::widen8_low<is_signed>(b)),
+                                                        Isa::madd16(Isa::widen8_high<is_signed>(a), Isa::widen8_high<is_signed>(b)));
+        return Isa::widen32<true>(sums);
+    } else if constexpr (sizeof(T) == 2) {
+        // Low and high halves of the 32-bit products, interleaved back into whole products
+        typename Isa::reg low = Isa::mullo16(a, b);
+        typename Isa::reg high = Isa::mulhi16<is_signed>(a, b);
+        return Isa::add<std::uint64_t>(Isa::widen32<is_signed>(Isa::unpacklo16(low, high)),
+                                       Isa::widen32<is_signed>(Isa::unpackhi16(low, high)));
+    } else if constexpr (sizeof(T) == 4) {
+        // 32 x 32 -> 64-bit multiply exists only for the even lanes; shift the odd ones down for a second one
+        return Isa::add<std::uint64_t>(Isa::mul32<is_signed>(a, b),
+                                       Isa::mul32<is_signed>(Isa::srli64(a, 32), Isa::srli64(b, 32)));
+    } else {
+        // No 64-bit multiply before AVX-512: low * low + (low * high + high * low) << 32
+        typename Isa::reg low = Isa::mul32<false>(a, b);
+        typename Isa::reg cross = Isa::add<std::uint64_t>(Isa::mul32<false>(Isa::srli64(a, 32), b),
+                                                          Isa::mul32<false>(a, Isa::srli64(b, 32)));
+        return Isa::add<std::uint64_t>(low, Isa::slli64(cross, 32));
+    }
+}
+
+template <typename T>
+wide_t<T> dot(const T* a, const T* b, std::size_t n) {
+    constexpr std::size_t lanes = Isa::bytes / sizeof(T);
+    typename Isa::reg acc = Isa::zero();
+    std::size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        acc = Isa::add<std::uint64_t>(acc, widen_dot<T>(Isa::load(a + i), Isa::load(b + i)));
+    }
+    std::uint64_t total = Isa::hsum64(acc);
+    for (; i < n; i++) {
+        total += static_cast<std::uint64_t>(static_cast<wide_t<T>>(a[i])) * static_cast<std::uint64_t>(static_cast<wide_t<T>>(b[i]));
+    }
+    return static_cast<wide_t<T>>(total);
+}
+
+// Inclusive scan inside one 128-bit lane in log2(lanes) steps: add the register shifted by 1, 2, 4... elements
+template <typename T, int Shift = sizeof(T)>
+Isa::reg scan_lane(Isa::reg x) {
+    if constexpr (Shift >= 16) {
+        return x;
+    } else {
+        return scan_lane<T, Shift * 2>(Isa::add<T>(x, Isa::shift_left_bytes<Shift>(x)));
+    }
+}
+
+template <typename T>
+void prefix_sum(const T* in, T* out, std::size_t n) {
+    constexpr std::size_t lanes = Isa::bytes / sizeof(T);
+    using U = unsigned_t<T>;
+    typename Isa::reg carry = Isa::zero(); // The last sum of the previous register, in every lane
+    std::size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        typename Isa::reg x = Isa::carry_lanes<U>(scan_lane<U>(Isa::load(in + i)));
+        x = Isa::add<U>(x, carry);
+        Isa::store(out + i, x);
+        carry = Isa::set1<U>(Isa::last<U>(x));
+    }
+    U running = i > 0 ? static_cast<U>(out[i - 1]) : 0;
+    for (; i < n; i++) {
+        running += static_cast<U>(in[i]);
+        out[i] = static_cast<T>(running);
+    }
+}
+
+template <typename T>
+std::size_t find(const T* data, std::size_t n, T value) {
+    constexpr std::size_t lanes = Isa::bytes / sizeof(T);
+    typename Isa::reg needle = Isa::set1<T>(value);
+    std::size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        // One bit per byte of the comparison; the lowest set bit is the first match
+        unsigned mask = Isa::movemask8(Isa::cmpeq<T>(Isa::load(data + i), needle));
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(__builtin_ctz(mask)) / sizeof(T);
+        }
+    }
+    for (; i < n; i++) {
+        if (data[i] == value) {
+            return i;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,243 @@
+// Throughput of the scalar, auto-vectorized, SSE2 and AVX2 kernels for every fixed-width integer type, and
+// int_fastN_t against intN_t
+//
+// Build: g++ -std=c++20 -O2 simd_benchmark.cpp kernels.cpp kernels_sse2.cpp kernels_avx2.cpp -o simd_benchmark
+// Usage: ./simd_benchmark [array bytes = 1048576]
+//        the default fits in L2, so the kernels are limited by the CPU rather than by memory bandwidth
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../../../testing/report.hpp"
+#include "kernels.hpp"
+#include "kernels_generic.hpp"
+
+constexpr simd::Impl impls[] = {simd::Impl::scalar, simd::Impl::autovec, simd::Impl::sse2, simd::Impl::avx2};
+
+// Keeps the compiler from optimizing the measured work away
+volatile std::uint64_t sink;
+
+template <typename F>
+double seconds(F&& work) {
+    auto begin = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// Best of a few runs of `repeats` calls, in GB/s of input (and output) touched per call
+template <typename F>
+double throughput(std::size_t bytes, std::size_t repeats, F&& call) {
+    double best = 1e30;
+    for (int run = 0; run < 3; run++) {
+        best = std::min(best, seconds([&] {
+            for (std::size_t i = 0; i < repeats; i++) {
+                call();
+            }
+        }));
+    }
+    return static_cast<double>(bytes) * repeats / best / 1e9;
+}
+
+template <typename T>
+[[noreturn]] void fail(const char* kernel, simd::Impl impl) {
+    std::cerr << "error: " << kernel << " for " << sizeof(T) * 8 << "-bit " << (std::is_signed_v<T> ? "signed" : "unsigned")
+              << " gives a different result with " << simd::name(impl) << std::endl;
+    std::exit(1);
+}
+
+// Every implementation must agree with the scalar one, including on all the lengths that leave a tail
+template <typename T>
+void verify(const std::vector<T>& a, const std::vector<T>& b, T needle) {
+    const simd::Kernels<T>& reference = *simd::kernels<T>(simd::Impl::scalar);
+    std::vector<T> expected(a.size());
+    std::vector<T> actual(a.size());
+    for (simd::Impl impl : impls) {
+        const simd::Kernels<T>* k = simd::kernels<T>(impl);
+        if (k == nullptr) {
+            continue;
+        }
+        for (std::size_t n : {std::size_t{1}, std::size_t{7}, std::size_t{33}, std::size_t{100}, a.size()}) {
+            if (k->sum(a.data(), n) != reference.sum(a.data(), n)) {
+                fail<T>("sum", impl);
+            }
+            simd::MinMax<T> got = k->minmax(a.data(), n);
+            simd::MinMax<T> want = reference.minmax(a.data(), n);
+            if (got.min != want.min || got.max != want.max) {
+                fail<T>("minmax", impl);
+            }
+            if (k->dot(a.data(), b.data(), n) != reference.dot(a.data(), b.data(), n)) {
+                fail<T>("dot", impl);
+            }
+            reference.prefix_sum(a.data(), expected.data(), n);
+            k->prefix_sum(a.data(), actual.data(), n);
+            for (std::size_t i = 0; i < n; i++) {
+                if (actual[i] != expected[i]) {
+                    fail<T>("prefix_sum", impl);
+                }
+            }
+            if (k->find(a.data(), n, needle) != reference.find(a.data(), n, needle)) {
+                fail<T>("find", impl);
+            }
+        }
+    }
+}
+
+template <typename T>
+std::string type_name() {
+    return std::string(std::is_signed_v<T> ? "int" : "uint") + std::to_string(sizeof(T) * 8) + "_t";
+}
+
+void print_row(const std::string& type, const char* kernel, const double (&results)[4]) {
+    std::cout << "| " << std::setw(9) << std::left << type << " | " << std::setw(10) << kernel << std::right;
+    const char* columns[] = {"scalar", "autovec", "SSE2", "AVX2"};
+    for (std::size_t c = 0; c < 4; c++) {
+        double result = results[c];
+        if (result > 0) {
+            std::cout << " | " << std::setw(8) << std::fixed << std::setprecision(1) << result;
+            bench::report(type + " " + kernel + ": " + columns[c], result, "GB/s");
+        } else {
+            std::cout << " | " << std::setw(8) << "-";
+        }
+    }
+    std::cout << " |\n";
+}
+
+template <typename T>
+void measure(std::size_t bytes, std::mt19937_64& rng) {
+    std::size_t n = bytes / sizeof(T);
+    std::vector<T> a(n);
+    std::vector<T> b(n);
+    std::vector<T> out(n);
+    for (std::size_t i = 0; i < n; i++) {
+        a[i] = static_cast<T>(rng());
+        b[i] = static_cast<T>(rng());
+    }
+    // The value searched for only appears near the end, so find() reads (almost) the whole array
+    T needle = static_cast<T>(42);
+    for (T& x : a) {
+        x = x == needle ? static_cast<T>(needle + 1) : x;
+    }
+    a[n - n / 64 - 1] = needle;
+
+    verify(a, b, needle);
+
+    std::size_t repeats = std::max<std::size_t>(1, (std::size_t{64} << 20) / bytes);
+    double sum[4] = {};
+    double minmax[4] = {};
+    double dot[4] = {};
+    double prefix[4] = {};
+    double find[4] = {};
+    for (std::size_t i = 0; i < 4; i++) {
+        const simd::Kernels<T>* k = simd::kernels<T>(impls[i]);
+        if (k == nullptr) {
+            continue;
+        }
+        sum[i] = throughput(bytes, repeats, [&] { sink = static_cast<std::uint64_t>(k->sum(a.data(), n)); });
+        minmax[i] = throughput(bytes, repeats, [&] { sink = static_cast<std::uint64_t>(k->minmax(a.data(), n).max); });
+        dot[i] = throughput(2 * bytes, repeats, [&] { sink = static_cast<std::uint64_t>(k->dot(a.data(), b.data(), n)); });
+        prefix[i] = throughput(2 * bytes, repeats, [&] { k->prefix_sum(a.data(), out.data(), n); sink = static_cast<std::uint64_t>(out[n - 1]); });
+        find[i] = throughput(bytes, repeats, [&] { sink = k->find(a.data(), n, needle); });
+    }
+    print_row(type_name<T>(), "sum", sum);
+    print_row(type_name<T>(), "minmax", minmax);
+    print_row(type_name<T>(), "dot", dot);
+    print_row(type_name<T>(), "prefix_sum", prefix);
+    print_row(type_name<T>(), sizeof(T) == 1 ? "find byte" : "find", find);
+}
+
+// ## int_fastN_t vs intN_t
+// The "fast" types promise the fastest type with at least N bits. On x86-64 Linux int_fast16_t and int_fast32_t
+// are 64-bit, because 64-bit registers are never slower than 32-bit ones - for a single value in a register.
+// For an array the wider type means 2-8x more memory to move, and 2-8x fewer elements per SIMD register.
+// Two workloads per pair: summing an array (the autovec kernel), and a dependent chain of arithmetic on one
+// value that never touches memory
+template <typename T>
+double array_sum_ns(const std::vector<T>& data) {
+    constexpr int repeats = 64;
+    double time = seconds([&] {
+        for (int i = 0; i < repeats; i++) {
+            sink = static_cast<std::uint64_t>(simd::autovec::sum(data.data(), data.size()));
+        }
+    });
+    return time * 1e9 / (static_cast<double>(repeats) * data.size());
+}
+
+template <typename T>
+double register_chain_ns(std::size_t iterations) {
+    T x = static_cast<T>(sink);
+    double time = seconds([&] {
+        for (std::size_t i = 0; i < iterations; i++) {
+            // Done in unsigned arithmetic (no overflow UB) and truncated back to T after every step
+            x = static_cast<T>(static_cast<simd::unsigned_t<T>>(x) * 5u + static_cast<simd::unsigned_t<T>>(i));
+        }
+    });
+    sink = static_cast<std::uint64_t>(x);
+    return time * 1e9 / iterations;
+}
+
+template <typename Exact, typename Fast>
+void compare_fast(const char* exact_name, const char* fast_name, std::size_t elements, std::mt19937_64& rng) {
+    std::vector<Exact> exact(elements);
+    std::vector<Fast> fast(elements);
+    for (std::size_t i = 0; i < elements; i++) {
+        exact[i] = static_cast<Exact>(rng());
+        fast[i] = exact[i];
+    }
+    constexpr std::size_t iterations = 100'000'000;
+    const char* same = std::is_same_v<Exact, Fast> ? "yes" : "no";
+    double exact_sum = array_sum_ns(exact);
+    double exact_chain = register_chain_ns<Exact>(iterations);
+    double fast_sum = array_sum_ns(fast);
+    double fast_chain = register_chain_ns<Fast>(iterations);
+    std::cout << std::fixed << std::setprecision(3)
+              << "| " << std::setw(13) << std::left << exact_name << " | " << std::setw(4) << std::right << sizeof(Exact)
+              << " | " << std::setw(4) << "" << " | " << std::setw(13) << exact_sum
+              << " | " << std::setw(13) << exact_chain << " |\n"
+              << "| " << std::setw(13) << std::left << fast_name << " | " << std::setw(4) << std::right << sizeof(Fast)
+              << " | " << std::setw(4) << same << " | " << std::setw(13) << fast_sum
+              << " | " << std::setw(13) << fast_chain << " |\n";
+    bench::report(std::string(exact_name) + ": array sum", exact_sum, "ns");
+    bench::report(std::string(exact_name) + ": register loop", exact_chain, "ns");
+    bench::report(std::string(fast_name) + ": array sum", fast_sum, "ns");
+    bench::report(std::string(fast_name) + ": register loop", fast_chain, "ns");
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t bytes = argc > 1 ? std::stoull(argv[1]) : 1 << 20;
+    bytes = std::max<std::size_t>(bytes, 1024);
+    std::mt19937_64 rng(42);
+
+    std::cout << "## Kernel throughput, GB/s\n\n";
+    std::cout << bytes << "-byte arrays. Runtime dispatch picks " << simd::name(simd::best()) << " on this CPU\n\n";
+    std::cout << "| Type      | Kernel     | scalar   | autovec  | SSE2     | AVX2     |\n";
+    std::cout << "|-----------|------------|----------|----------|----------|----------|\n";
+    measure<std::int8_t>(bytes, rng);
+    measure<std::uint8_t>(bytes, rng);
+    measure<std::int16_t>(bytes, rng);
+    measure<std::uint16_t>(bytes, rng);
+    measure<std::int32_t>(bytes, rng);
+    measure<std::uint32_t>(bytes, rng);
+    measure<std::int64_t>(bytes, rng);
+    measure<std::uint64_t>(bytes, rng);
+    std::cout << "\ndot and prefix_sum count both arrays they touch\n";
+
+    std::size_t elements = bytes / sizeof(std::int8_t);
+    std::cout << "\n## int_fastN_t vs intN_t, ns per element\n\n";
+    std::cout << elements << " elements per array\n\n";
+    std::cout << "| Type          | Size | Same | array sum     | register loop |\n";
+    std::cout << "|---------------|------|------|---------------|---------------|\n";
+    compare_fast<std::int8_t, std::int_fast8_t>("int8_t", "int_fast8_t", elements, rng);
+    compare_fast<std::int16_t, std::int_fast16_t>("int16_t", "int_fast16_t", elements, rng);
+    compare_fast<std::int32_t, std::int_fast32_t>("int32_t", "int_fast32_t", elements, rng);
+    compare_fast<std::uint8_t, std::uint_fast8_t>("uint8_t", "uint_fast8_t", elements, rng);
+    std::cout << "\n\"Same\" is whether the fast type is just another name for the exact one on this platform" << std::endl;
+}
@@ -0,0 +1,391 @@
+// Cost of creating and copying std::unique_ptr, std::shared_ptr (with new and with make_shared) and the
+// intrusive pointers from intrusive_ptr.hpp: allocations per object, refcount traffic on a hot object, cache
+// misses on cold objects (from the hardware counters, perf_counters.hpp), and contention when many threads copy
+// the same pointer. Checks the allocation and destructor counts, and the intrusive pointers' use_count.
+//
+// Build: g++ -std=c++20 -O2 -pthread smart_pointer_benchmark.cpp -o smart_pointer_benchmark
+// Usage: ./smart_pointer_benchmark [objects = 1000000] [max threads = hardware threads]
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "../../testing/perf_counters.hpp"
+#include "../../testing/report.hpp"
+#include "intrusive_ptr.hpp"
+
+// ## Counting allocations
+// Replacing the global operator new counts every allocation, including shared_ptr's control blocks
+std::atomic<std::size_t> allocations{0};
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+using bench::PerfCounters;
+
+void fail(const std::string& what) {
+    std::cerr << "ERROR: " << what << std::endl;
+    std::exit(1);
+}
+
+// ## The pointed-to objects
+// 48 bytes of data, a typical small object. The intrusive ones add their 4-byte count.
+// Every destructor counts itself, to check each pointer destroys its object exactly once. A plain integer: objects
+// are only ever destroyed on the main thread, the contention threads just copy pointers to them
+std::size_t destroyed = 0;
+
+struct Object {
+    std::uint64_t data[6] = {1, 2, 3, 4, 5, 6};
+    ~Object() { destroyed++; }
+};
+
+struct SharedObject : smart::RefCounted<SharedObject> {
+    std::uint64_t data[6] = {1, 2, 3, 4, 5, 6};
+    ~SharedObject() { destroyed++; }
+};
+
+struct LocalObject : smart::RefCounted<LocalObject, smart::LocalCount> {
+    std::uint64_t data[6] = {1, 2, 3, 4, 5, 6};
+    ~LocalObject() { destroyed++; }
+};
+
+// ## The pointers
+// Each kind: how to make one, how many allocations that takes, and whether it can be copied and shared between threads
+struct Raw {
+    using Ptr = Object*;
+    static constexpr const char* name = "T* (new/delete)";
+    static constexpr std::size_t allocations = 1;
+    static constexpr bool copyable = true; // Copying doesn't share ownership, the baseline for the copy tests
+    static constexpr bool thread_safe = true;
+    static Ptr make() { return new Object(); }
+    static void destroy(Ptr& ptr) { delete ptr; }
+};
+
+struct Unique {
+    using Ptr = std::unique_ptr<Object>;
+    static constexpr const char* name = "unique_ptr";
+    static constexpr std::size_t allocations = 1;
+    static constexpr bool copyable = false;
+    static constexpr bool thread_safe = true;
+    static Ptr make() { return std::make_unique<Object>(); }
+    static void destroy(Ptr& ptr) { ptr.reset(); }
+};
+
+struct SharedNew {
+    using Ptr = std::shared_ptr<Object>;
+    static constexpr const char* name = "shared_ptr(new T)";
+    static constexpr std::size_t allocations = 2; // The object, then the control block
+    static constexpr bool copyable = true;
+    static constexpr bool thread_safe = true;
+    static Ptr make() { return Ptr(new Object()); }
+    static void destroy(Ptr& ptr) { ptr.reset(); }
+};
+
+struct MakeShared {
+    using Ptr = std::shared_ptr<Object>;
+    static constexpr const char* name = "make_shared";
+    static constexpr std::size_t allocations = 1; // Object and control block together
+    static constexpr bool copyable = true;
+    static constexpr bool thread_safe = true;
+    static Ptr make() { return std::make_shared<Object>(); }
+    static void destroy(Ptr& ptr) { ptr.reset(); }
+};
+
+struct Intrusive {
+    using Ptr = smart::IntrusivePtr<SharedObject>;
+    static constexpr const char* name = "IntrusivePtr atomic";
+    static constexpr std::size_t allocations = 1;
+    static constexpr bool copyable = true;
+    static constexpr bool thread_safe = true;
+    static Ptr make() { return smart::make_intrusive<SharedObject>(); }
+    static void destroy(Ptr& ptr) { ptr.reset(); }
+};
+
+struct IntrusiveLocal {
+    using Ptr = smart::IntrusivePtr<LocalObject>;
+    static constexpr const char* name = "IntrusivePtr local";
+    static constexpr std::size_t allocations = 1;
+    static constexpr bool copyable = true;
+    static constexpr bool thread_safe = false; // The count is a plain integer
+    static Ptr make() { return smart::make_intrusive<LocalObject>(); }
+    static void destroy(Ptr& ptr) { ptr.reset(); }
+};
+
+// Keeps the compiler from optimizing the measured work away
+volatile std::uint64_t sink;
+
+template <typename F>
+double seconds(F&& work) {
+    auto begin = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// Passing the pointer by value to a function that reads the object: the copy adds a reference, destroying the
+// parameter drops it - the shared_ptr-by-value pattern from request handlers. noipa keeps the call (and the
+// copy) as written, so the compiler can't pair up and remove the increment and decrement
+template <typename Ptr>
+[[gnu::noipa]] std::uint64_t use(Ptr ptr) {
+    return ptr->data[0];
+}
+
+struct Row {
+    double create = 0;       // ns per make + destroy
+    double allocations = 0;  // per object
+    double copy_hot = -1;    // ns per call passing the same pointer by value, -1 when not copyable
+    double copy_cold = -1;   // ns per call passing pointers to all the objects, in random order
+    double cold_misses = -1; // Cache misses per cold call, -1 when not copyable or without counters
+};
+
+template <typename Kind>
+Row measure(PerfCounters& counters, std::size_t objects) {
+    using Ptr = typename Kind::Ptr;
+    Row row;
+    std::vector<Ptr> pointers(objects);
+
+    // Create everything, then destroy everything - the allocator sees a realistic mix, not one slot reused
+    std::size_t allocations_before = allocations.load();
+    double create = seconds([&] {
+        for (Ptr& ptr : pointers) {
+            ptr = Kind::make();
+        }
+    });
+    row.allocations = static_cast<double>(allocations.load() - allocations_before) / objects;
+    if (allocations.load() - allocations_before != Kind::allocations * objects) {
+        fail(std::string(Kind::name) + ": " + std::to_string(row.allocations) + " allocations per object, expected " +
+             std::to_string(Kind::allocations));
+    }
+    std::size_t destroyed_before = destroyed;
+    create += seconds([&] {
+        for (Ptr& ptr : pointers) {
+            Kind::destroy(ptr);
+        }
+    });
+    row.create = create * 1e9 / objects;
+    if (destroyed - destroyed_before != objects) {
+        fail(std::string(Kind::name) + ": " + std::to_string(destroyed - destroyed_before) + " of " +
+             std::to_string(objects) + " objects destroyed");
+    }
+
+    if constexpr (Kind::copyable) {
+        for (Ptr& ptr : pointers) {
+            ptr = Kind::make();
+        }
+        // Shuffled, so the objects are visited in no particular order in memory, like pointers fetched from a
+        // hash map on a request path
+        std::vector<Ptr> shuffled = pointers;
+        std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+
+        std::size_t copies = 10 * objects;
+        std::uint64_t total = 0;
+        const Ptr& hot = shuffled[0];
+        row.copy_hot = seconds([&] {
+            for (std::size_t i = 0; i < copies; i++) {
+                total += use<Ptr>(hot);
+            }
+        }) * 1e9 / copies;
+
+        // Every copy has to bring the count (or the control block) into the cache first
+        counters.start();
+        row.copy_cold = seconds([&] {
+            for (const Ptr& ptr : shuffled) {
+                total += use<Ptr>(ptr);
+            }
+        }) * 1e9 / objects;
+        counters.stop();
+        if (counters.available(PerfCounters::cache_misses)) {
+            row.cold_misses = static_cast<double>(counters.read()[PerfCounters::cache_misses]) / objects;
+        }
+        sink = total;
+
+        shuffled.clear();
+        if constexpr (std::is_pointer_v<Ptr>) {
+            for (Ptr& ptr : pointers) {
+                Kind::destroy(ptr);
+            }
+        }
+    }
+    return row;
+}
+
+void print(const char* name, const Row& row) {
+    auto cell = [](double value) {
+        if (value < 0) {
+            std::cout << std::setw(10) << "-";
+        } else {
+            std::cout << std::setw(10) << value;
+        }
+    };
+    std::cout << "| " << std::setw(20) << std::left << name << std::right << std::fixed << std::setprecision(1) << " | ";
+    cell(row.create);
+    std::cout << " | " << std::setw(6) << std::setprecision(2) << row.allocations << std::setprecision(1) << " | ";
+    cell(row.copy_hot);
+    std::cout << " | ";
+    cell(row.copy_cold);
+    std::cout << " | " << std::setw(6) << std::setprecision(2);
+    if (row.cold_misses < 0) {
+        std::cout << "-";
+    } else {
+        std::cout << row.cold_misses;
+    }
+    std::cout << std::setprecision(1) << " |\n";
+    bench::report(std::string(name) + ": create", row.create, "ns");
+    bench::report(std::string(name) + ": allocs", row.allocations, "allocs");
+    if (row.copy_hot >= 0) {
+        bench::report(std::string(name) + ": copy hot", row.copy_hot, "ns");
+        bench::report(std::string(name) + ": copy cold", row.copy_cold, "ns");
+    }
+    if (row.cold_misses >= 0) {
+        bench::report(std::string(name) + ": copy cold misses", row.cold_misses, "misses");
+    }
+}
+
+// ## Ownership
+// IntrusivePtr's count through copy, move and reset, with either counter: the object has to go away exactly when
+// the last pointer does, not before and not never
+template <typename T>
+void check_ownership(const char* name) {
+    auto expect = [name](bool ok, const char* what) {
+        if (!ok) {
+            fail(std::string(name) + ": " + what);
+        }
+    };
+    std::size_t destroyed_before = destroyed;
+    smart::IntrusivePtr<T> a = smart::make_intrusive<T>();
+    expect(a.use_count() == 1, "use_count after make_intrusive isn't 1");
+    smart::IntrusivePtr<T> b = a;
+    expect(a.use_count() == 2 && b.get() == a.get(), "use_count after a copy isn't 2");
+    smart::IntrusivePtr<T> c = std::move(b);
+    expect(b == nullptr && b.use_count() == 0 && c.use_count() == 2, "a move changed use_count");
+    smart::IntrusivePtr<T> d(a.get()); // Adopting the raw pointer again shares the same count
+    expect(a.use_count() == 3, "use_count after adopting a raw pointer isn't 3");
+    d = c;
+    expect(a.use_count() == 3, "assigning a pointer to the same object changed use_count");
+    c.reset();
+    expect(c == nullptr && a.use_count() == 2, "use_count after a reset isn't 2");
+    d.reset();
+    expect(a.use_count() == 1 && destroyed == destroyed_before, "the object was destroyed while still owned");
+    a.reset();
+    expect(destroyed == destroyed_before + 1, "the last reset didn't destroy the object");
+}
+
+// ## Contention
+// Every thread passes a pointer by value again and again. "shared": all threads use the same object, so every
+// copy is an atomic read-modify-write on one cache line that has to travel between the cores. "own": each
+// thread has its own object - the same instructions, without the line ping-ponging
+template <typename Kind>
+double contended_ns(std::size_t threads, std::size_t copies, bool same_object) {
+    using Ptr = typename Kind::Ptr;
+    Ptr shared = Kind::make();
+    std::vector<Ptr> own(threads);
+    for (Ptr& ptr : own) {
+        ptr = Kind::make();
+    }
+    std::vector<std::uint64_t> totals(threads); // One per thread - they can't all write to sink
+    std::barrier start(static_cast<std::ptrdiff_t>(threads + 1));
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            const Ptr& source = same_object ? shared : own[t];
+            std::uint64_t total = 0;
+            start.arrive_and_wait();
+            for (std::size_t i = 0; i < copies; i++) {
+                total += use<Ptr>(source);
+            }
+            totals[t] = total;
+        });
+    }
+    double time = seconds([&] {
+        start.arrive_and_wait();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    });
+    for (std::uint64_t total : totals) {
+        sink = total;
+    }
+    return time * 1e9 / copies; // Wall time per copy, per thread
+}
+
+template <typename Kind>
+void print_contention(std::size_t max_threads) {
+    static_assert(Kind::thread_safe, "copying this pointer from several threads is a data race");
+    constexpr std::size_t copies = 2'000'000;
+    // Powers of two, and the maximum itself when it isn't one
+    std::vector<std::size_t> steps;
+    for (std::size_t threads = 1; threads < max_threads; threads *= 2) {
+        steps.push_back(threads);
+    }
+    steps.push_back(max_threads);
+    for (std::size_t threads : steps) {
+        double shared = contended_ns<Kind>(threads, copies, true);
+        double own = contended_ns<Kind>(threads, copies, false);
+        std::cout << "| " << std::setw(20) << std::left << Kind::name << " | " << std::setw(7) << std::right << threads
+                  << std::fixed << std::setprecision(1)
+                  << " | " << std::setw(10) << shared
+                  << " | " << std::setw(10) << own << " |\n";
+        std::string row = std::string(Kind::name) + ", " + std::to_string(threads) + (threads == 1 ? " thread" : " threads");
+        bench::report(row + ": shared", shared, "ns");
+        bench::report(row + ": own", own, "ns");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t objects = argc > 1 ? std::stoull(argv[1]) : 1'000'000;
+    std::size_t max_threads = argc > 2 ? std::stoull(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+
+    // libstdc++ counts shared_ptr references with plain increments while the process has only one thread
+    // (__libc_single_threaded), and switches to atomics for good once a thread starts. A server has threads,
+    // so start one before measuring anything
+    std::thread([] {}).join();
+
+    check_ownership<SharedObject>(Intrusive::name);
+    check_ownership<LocalObject>(IntrusiveLocal::name);
+
+    PerfCounters counters;
+    if (!counters.available(PerfCounters::cache_misses)) {
+        std::cout << "Cache misses: n/a, hardware counters unavailable (" << counters.error() << ")\n\n";
+    }
+
+    std::cout << "## Single thread, ns\n\n";
+    std::cout << "sizeof: T* " << sizeof(Object*) << ", unique_ptr " << sizeof(std::unique_ptr<Object>) << ", shared_ptr "
+              << sizeof(std::shared_ptr<Object>) << ", IntrusivePtr " << sizeof(smart::IntrusivePtr<SharedObject>) << " bytes\n\n";
+    std::cout << "| Pointer              | create     | allocs | copy hot   | copy cold  | misses |\n";
+    std::cout << "|----------------------|------------|--------|------------|------------|--------|\n";
+    print(Raw::name, measure<Raw>(counters, objects));
+    print(Unique::name, measure<Unique>(counters, objects));
+    print(SharedNew::name, measure<SharedNew>(counters, objects));
+    print(MakeShared::name, measure<MakeShared>(counters, objects));
+    print(Intrusive::name, measure<Intrusive>(counters, objects));
+    print(IntrusiveLocal::name, measure<IntrusiveLocal>(counters, objects));
+    std::cout << "\ncreate: make + destroy, per object, " << objects << " objects. copy hot: pass the same pointer by value\n"
+              << "to a function. copy cold: pass pointers to all the objects, in random order. misses: cache misses per cold copy\n\n";
+
+    std::cout << "## Copies from many threads, ns per copy\n\n";
+    std::cout << "| Pointer              | Threads | shared     | own        |\n";
+    std::cout << "|----------------------|---------|------------|------------|\n";
+    print_contention<SharedNew>(max_threads);
+    print_contention<Intrusive>(max_threads);
+    std::cout << "\nshared: all threads pass the same pointer. own: every thread passes a pointer to its own object.\n"
+              << "IntrusivePtr local isn't thread-safe and is left out" << std::endl;
+}
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "layout.hpp"
+
+// Struct of arrays (SoA) with an array-of-structs interface
+//
+// std::vector<Particle> stores particle after particle (array of structs, AoS). A loop that only needs the
+// positions still drags every other member through the cache with them. soa::vector stores one array per member
+// instead - all the x, then all the y... - so a loop over some members reads only those, and reads them as dense
+// arrays that SIMD instructions can load 8 or 16 at a time.
+//
+//     using Particles = soa::vector<Particle, &Particle::x, &Particle::y, &Particle::vx, &Particle::vy>;
+//     Particles particles;
+//     particles.push_back(Particle{...});          // Scattered into the columns
+//     particles[i].get<&Particle::x>() += 1;      // A proxy: reads and writes go to the columns
+//     Particle p = particles[i];                   // Gathered back into a struct
+//     std::span<float> x = particles.column<&Particle::x>();
+//
+// C++ can't list the members of a struct by itself (yet), so they're passed as pointers-to-members, like
+// layout::structure. Only the listed members are stored: a member can be left out, or can be a struct of its own
+// to keep rarely used members together in one column (hot/cold splitting, see arrays.cpp).
+//
+// All columns live in one allocation. Every column starts on a 64-byte boundary (a cache line, and the widest SIMD
+// register), and the capacity is a multiple of 64 elements: SIMD loops can run up to padded_size() without a
+// scalar tail. Elements past size() are initialized, but hold whatever was last written there.
+
+namespace soa {
+
+inline constexpr std::size_t column_alignment = 64;
+inline constexpr std::size_t column_granularity = 64; // Capacity is a multiple of this many elements
+
+template <auto Member>
+using member_type = typename layout::member_type<decltype(Member)>::type;
+
+template <auto A, auto B>
+constexpr bool same_member() {
+    if constexpr (std::is_same_v<decltype(A), decltype(B)>) {
+        return A == B;
+    } else {
+        return false;
+    }
+}
+
+template <typename T, auto... Members>
+class vector {
+    static_assert(sizeof...(Members) > 0, "list the members to store");
+    static_assert((std::is_same_v<decltype(Members), member_type<Members> T::*> && ...), "every member must belong to T");
+    static_assert((std::is_trivially_copyable_v<member_type<Members>> && ...), "columns are moved around with memcpy");
+    static_assert(std::is_default_constructible_v<T>, "operator[] gathers the members into a default-constructed T");
+
+public:
+    using value_type = T;
+
+    // What operator[] returns: an index into the vector, standing in for the element
+    class reference {
+    public:
+        template <auto Member>
+        member_type<Member>& get() const {
+            return owner_->template data<Member>()[index_];
+        }
+
+        // A struct of references, in the order of the vector's members, gives named access:
+        //     struct ParticleRef { float& x; float& y; float& vx; float& vy; };
+        //     auto p = particles[i].as<ParticleRef>(); p.x += p.vx;
+        template <typename View>
+        View as() const {
+            return View{get<Members>()...};
+        }
+
+        operator T() const { return owner_->load(index_); }
+        const reference& operator=(const T& value) const {
+            owner_->store(index_, value);
+            return *this;
+        }
+        const reference& operator=(const reference& other) const { return *this = static_cast<T>(other); }
+
+    private:
+        friend class vector;
+        reference(vector* owner, std::size_t index) : owner_(owner), index_(index) {}
+        vector* owner_;
+        std::size_t index_;
+    };
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = vector::reference;
+
+        iterator() = default;
+        reference operator*() const { return (*owner_)[index_]; }
+        iterator& operator++() {
+            index_++;
+            return *this;
+        }
+        void operator++(int) { index_++; }
+        bool operator==(const iterator& other) const { return index_ == other.index_; }
+
+    private:
+        friend class vector;
+        iterator(vector* owner, std::size_t index) : owner_(owner), index_(index) {}
+        vector* owner_ = nullptr;
+        std::size_t index_ = 0;
+    };
+
+    vector() = default;
+    explicit vector(std::size_t size) { resize(size); }
+    // AoS -> SoA
+    explicit vector(std::span<const T> aos) { assign(aos); }
+
+    vector(const vector& other) {
+        if (other.size_ == 0) {
+            return;
+        }
+        reserve(other.size_);
+        size_ = other.size_;
+        for_each_column([&]<auto Member>() { std::memcpy(data<Member>(), other.data<Member>(), bytes<Member>(size_)); });
+    }
+    vector(vector&& other) noexcept
+        : block_(std::exchange(other.block_, nullptr)), columns_(std::exchange(other.columns_, {})),
+          size_(std::exchange(other.size_, 0)), capacity_(std::exchange(other.capacity_, 0)) {}
+    vector& operator=(vector other) noexcept {
+        std::swap(block_, other.block_);
+        std::swap(columns_, other.columns_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+        return *this;
+    }
+    ~vector() { release(block_); }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    std::size_t capacity() const { return capacity_; }
+    std::size_t padded_size() const { return round_up(size_, column_granularity); }
+
+    reference operator[](std::size_t index) { return reference(this, index); }
+    T operator[](std::size_t index) const { return load(index); }
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size_); }
+
+    // One member of every element, as a contiguous array aligned to column_alignment
+    template <auto Member>
+    std::span<member_type<Member>> column() {
+        return {data<Member>(), size_};
+    }
+    template <auto Member>
+    std::span<const member_type<Member>> column() const {
+        return {data<Member>(), size_};
+    }
+    // The same, up to padded_size(): for SIMD loops that work on whole registers
+    template <auto Member>
+    std::span<member_type<Member>> padded_column() {
+        return {data<Member>(), padded_size()};
+    }
+
+    template <auto Member>
+    member_type<Member>* data() {
+        static_assert(index_of<Member>() < sizeof...(Members), "the vector doesn't store this member");
+        return std::assume_aligned<column_alignment>(std::get<index_of<Member>()>(columns_));
+    }
+    template <auto Member>
+    const member_type<Member>* data() const {
+        static_assert(index_of<Member>() < sizeof...(Members), "the vector doesn't store this member");
+        return std::assume_aligned<column_alignment>(std::get<index_of<Member>()>(columns_));
+    }
+
+    void reserve(std::size_t capacity) {
+        if (capacity > capacity_) {
+            reallocate(round_up(capacity, column_granularity));
+        }
+    }
+
+    // New elements are value-initialized (zeros)
+    void resize(std::size_t size) {
+        if (size > capacity_) {
+            reallocate(round_up(size, column_granularity)); // Zeroes everything past size_
+        } else if (size > size_) {
+            for_each_column([&]<auto Member>() {
+                std::fill(data<Member>() + size_, data<Member>() + size, member_type<Member>{});
+            });
+        }
+        size_ = size;
+    }
+
+    void clear() { size_ = 0; }
+
+    void push_back(const T& value) {
+        if (size_ == capacity_) {
+            reallocate(std::max(2 * capacity_, column_granularity));
+        }
+        store(size_++, value);
+    }
+
+    void pop_back() { size_--; }
+
+    // AoS -> SoA: one pass per column, so each column is written sequentially
+    void assign(std::span<const T> aos) {
+        size_ = 0;
+        reserve(aos.size());
+        size_ = aos.size();
+        for_each_column([&]<auto Member>() {
+            member_type<Member>* column = data<Member>();
+            for (std::size_t i = 0; i < aos.size(); i++) {
+                column[i] = aos[i].*Member;
+            }
+        });
+    }
+
+    // SoA -> AoS. Members of T that the vector doesn't store are left as they are in `aos`
+    void to_aos(std::span<T> aos) const {
+        for_each_column([&]<auto Member>() {
+            const member_type<Member>* column = data<Member>();
+            for (std::size_t i = 0; i < size_; i++) {
+                aos[i].*Member = column[i];
+            }
+        });
+    }
+    std::vector<T> to_aos() const {
+        std::vector<T> aos(size_);
+        to_aos(aos);
+        return aos;
+    }
+
+private:
+    template <auto Member>
+    static constexpr std::size_t index_of() {
+        constexpr bool matches[] = {same_member<Member, Members>()...};
+        std::size_t index = 0;
+        while (index < sizeof...(Members) && !matches[index]) {
+            index++;
+        }
+        return index;
+    }
+
+    template <auto Member>
+    static constexpr std::size_t bytes(std::size_t elements) {
+        return elements * sizeof(member_type<Member>);
+    }
+
+    static constexpr std::size_t round_up(std::size_t value, std::size_t multiple) {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+    template <typename F>
+    void for_each_column(F&& f) const {
+        (f.template operator()<Members>(), ...);
+    }
+
+    T load(std::size_t index) const {
+        T value{};
+        ((value.*Members = data<Members>()[index]), ...);
+        return value;
+    }
+
+    void store(std::size_t index, const T& value) {
+        ((data<Members>()[index] = value.*Members), ...);
+    }
+
+    // Moves every column into a new block, and zeroes the rest of each column
+    void reallocate(std::size_t capacity) {
+        std::size_t total = (std::size_t{0} + ... + round_up(bytes<Members>(capacity), column_alignment));
+        auto* block = static_cast<std::byte*>(::operator new(total, std::align_val_t(column_alignment)));
+        std::tuple<member_type<Members>*...> columns;
+        std::size_t offset = 0;
+        ((std::get<index_of<Members>()>(columns) = reinterpret_cast<member_type<Members>*>(block + offset),
+          offset += round_up(bytes<Members>(capacity), column_alignment)), ...);
+        if (size_ > 0) {
+            ((std::memcpy(std::get<index_of<Members>()>(columns), std::get<index_of<Members>()>(columns_), bytes<Members>(size_))), ...);
+        }
+        ((std::memset(std::get<index_of<Members>()>(columns) + size_, 0, bytes<Members>(capacity - size_))), ...);
+        release(block_);
+        block_ = block;
+        columns_ = columns;
+        capacity_ = capacity;
+    }
+
+    static void release(std::byte* block) {
+        if (block != nullptr) {
+            ::operator delete(block, std::align_val_t(column_alignment));
+        }
+    }
+
+    std::byte* block_ = nullptr;
+    std::tuple<member_type<Members>*...> columns_{};
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+};
+
+} // namespace soa
@@ -0,0 +1,115 @@
+#include <cstdint>
+
+#include <iostream>
+
+#include "layout.hpp"
+
+// # Structs
+// A struct groups several variables (members) into one type. The members are stored in memory in the order
+// they are declared, but not necessarily right next to each other.
+
+// ## Alignment and padding
+// Every type has an alignment: an `int32_t` must start at an address divisible by 4, a `double` at one divisible
+// by 8 (alignof(T) returns it). To keep every member aligned, the compiler inserts unused bytes - padding -
+// between members, and at the end of the struct so that the next element of an array is aligned too.
+// The struct itself is aligned to its most-aligned member.
+
+struct Padded {
+    char tag;       // offset 0, then 7 bytes of padding so value starts at 8
+    double value;   // offset 8
+    char flag;      // offset 16, then 7 bytes of tail padding: sizeof(Padded) is 24, for 10 bytes of data
+};
+
+// Same members, sorted from the largest alignment down. Only the tail padding is left
+struct Reordered {
+    double value;   // offset 0
+    char tag;       // offset 8
+    char flag;      // offset 9, then 6 bytes of tail padding: sizeof(Reordered) is 16
+};
+
+// A more realistic example: a record that grew one field at a time, in whatever order they were needed
+struct Order {
+    bool active;
+    std::int64_t id;
+    bool urgent;
+    std::int32_t quantity;
+    bool paid;
+    double price;
+};
+
+// The same record sorted by size: 40 bytes become 24, so 8 orders take 3 cache lines instead of 5
+struct CompactOrder {
+    std::int64_t id;
+    double price;
+    std::int32_t quantity;
+    bool active;
+    bool urgent;
+    bool paid;
+};
+
+// ## Packed structs
+// Padding can be turned off with a compiler extension. Useful to match a file format or network header byte for
+// byte, but the members can end up misaligned - slower to access, and on some CPUs not allowed at all. Taking
+// the address of a misaligned member (`int32_t* p = &header.length;`) is a bug waiting to happen.
+#pragma pack(push, 1)
+struct PackedHeader {
+    std::uint8_t version;
+    std::uint32_t length;   // offset 1 - misaligned
+    std::uint16_t checksum; // offset 5
+};
+#pragma pack(pop)
+
+// ## Hot-path structs
+// Code that loops over millions of structs is limited by how many of them fit in the cache. This one is laid
+// out with no padding at all, and a static_assert below keeps it that way
+struct Particle {
+    float x, y, z;
+    float vx, vy, vz;
+    std::uint32_t id;
+};
+
+// ## Hot and cold members
+// A loop reads whole cache lines, so members it doesn't use still cost bandwidth if they sit next to the ones it
+// does. Members every iteration needs (hot) and members only a few places need (cold: names, colors, statistics) are
+// better off apart: the cold ones in a struct of their own, in a second array with the same index. Particle above
+// is the hot part of a particle (its id finds the rest); this is the cold part
+struct ParticleInfo {
+    std::uint32_t color;
+    float mass;
+    float charge;
+    char name[20];
+};
+// Going further, every hot member gets its own array (struct of arrays): see soa.hpp and arrays.cpp
+
+// ## Layout audits
+// layout::structure computes size, alignment and padding at compile time. The members are passed as pointers
+// to members, because C++ can't list the members of a struct by itself
+constexpr auto padded = layout::structure<Padded, &Padded::tag, &Padded::value, &Padded::flag>("Padded");
+constexpr auto reordered = layout::structure<Reordered, &Reordered::value, &Reordered::tag, &Reordered::flag>("Reordered");
+constexpr auto order = layout::structure<Order, &Order::active, &Order::id, &Order::urgent, &Order::quantity,
+                                         &Order::paid, &Order::price>("Order");
+constexpr auto compact_order = layout::structure<CompactOrder, &CompactOrder::id, &CompactOrder::price, &CompactOrder::quantity,
+                                                 &CompactOrder::active, &CompactOrder::urgent, &CompactOrder::paid>("CompactOrder");
+constexpr auto packed_header = layout::structure<PackedHeader, &PackedHeader::version, &PackedHeader::length,
+                                                 &PackedHeader::checksum>("PackedHeader");
+constexpr auto particle = layout::structure<Particle, &Particle::x, &Particle::y, &Particle::z, &Particle::vx,
+                                            &Particle::vy, &Particle::vz, &Particle::id>("Particle");
+constexpr auto particle_info = layout::structure<ParticleInfo, &ParticleInfo::color, &ParticleInfo::mass,
+                                                 &ParticleInfo::charge, &ParticleInfo::name>("ParticleInfo");
+
+// These fail the build - not a test, not a profiler run - as soon as someone adds a member in the wrong place
+static_assert(particle.padding == 0, "Particle is on the hot path, keep it free of padding");
+static_assert(compact_order.size == compact_order.reordered, "CompactOrder should stay sorted by alignment");
+static_assert(packed_header.size == 7, "PackedHeader must match the wire format");
+
+constexpr auto layouts = [] {
+    layout::Text<2048> text;
+    text << "## Struct layouts\n";
+    layout::struct_table(text, "Padding", {padded, reordered, order, compact_order, packed_header, particle, particle_info});
+    text << "Padding is in bytes, Waste is padding / size, Reordered is the size with the members sorted by alignment\n";
+    return text;
+}();
+
+int main() {
+    std::cout << layouts.view() << std::flush;
+}
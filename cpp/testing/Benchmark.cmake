@@ -0,0 +1,78 @@
+# Benchmark helpers
+#
+# include(Benchmark.cmake), then for every benchmark program:
+#
+#   add_benchmark(<name>
+#       SOURCES <files>...              # * ; the program
+#       [FRAMEWORK]                     # Uses bench.hpp: takes --json=, reports median/MAD/p99 per benchmark
+#       [ARGS <args>...]                # Arguments for the full run
+#       [TEST_ARGS <args>...]           # Arguments for the quick ctest run, defaults to ARGS
+#       [COMPILE_OPTIONS <options>...]
+#       [LIBRARIES <libraries>...])     # Linked in addition to Threads::Threads
+#
+# That gives:
+#   * the executable <name>
+#   * a ctest test <name>, labelled "benchmark": a quick run that fails if the program exits with an error, which
+#     is how every benchmark here reports a wrong result
+#   * a target run_<name>: the full run, writing ${BENCHMARK_OUTPUT_DIR}/<name>.json and <name>.md. Programs that
+#     aren't FRAMEWORK ones are run ${BENCHMARK_REPETITIONS} times, for a noise estimate of every number
+#   * a target run_benchmarks running all of them one after the other - never in parallel, they'd skew each other
+#
+# The JSON of a FRAMEWORK program is its own, plus "commit" and "wall_seconds" in "context". Other programs print
+# Markdown tables and pass the numbers in their rows to bench::report() (report.hpp); their JSON has one entry per
+# number, with what every repetition measured in "values", and the tables as "output". compare.py compares two such
+# files or directories, entry by entry.
+
+set(BENCHMARK_OUTPUT_DIR "${CMAKE_BINARY_DIR}/benchmark_results" CACHE PATH "Where run_benchmarks writes its results")
+set(BENCHMARK_REPETITIONS 5 CACHE STRING "How many times run_<name> runs a benchmark that doesn't use bench.hpp")
+
+set(_BENCHMARK_RUNNER "${CMAKE_CURRENT_LIST_DIR}/run_benchmark.cmake")
+set(_BENCHMARK_INCLUDE_DIR "${CMAKE_CURRENT_LIST_DIR}")
+
+find_package(Threads REQUIRED)
+
+function(add_benchmark name)
+    cmake_parse_arguments(PARSE_ARGV 1 BENCHMARK "FRAMEWORK" "" "SOURCES;ARGS;TEST_ARGS;COMPILE_OPTIONS;LIBRARIES")
+    if(NOT BENCHMARK_SOURCES)
+        message(FATAL_ERROR "add_benchmark(${name}): SOURCES is required")
+    endif()
+    if(NOT DEFINED BENCHMARK_TEST_ARGS)
+        set(BENCHMARK_TEST_ARGS ${BENCHMARK_ARGS})
+    endif()
+
+    add_executable(${name} ${BENCHMARK_SOURCES})
+    target_compile_features(${name} PRIVATE cxx_std_20)
+    target_compile_options(${name} PRIVATE ${BENCHMARK_COMPILE_OPTIONS})
+    target_include_directories(${name} PRIVATE "${_BENCHMARK_INCLUDE_DIR}")
+    target_link_libraries(${name} PRIVATE Threads::Threads ${BENCHMARK_LIBRARIES})
+
+    add_test(NAME ${name} COMMAND ${name} ${BENCHMARK_TEST_ARGS})
+    set_tests_properties(${name} PROPERTIES LABELS benchmark)
+
+    # A list can't pass through a custom command's arguments in one piece: | separates the arguments instead
+    string(REPLACE ";" "|" args "${BENCHMARK_ARGS}")
+    set(command "${CMAKE_COMMAND}"
+        "-DNAME=${name}"
+        "-DEXECUTABLE=$<TARGET_FILE:${name}>"
+        "-DARGS=${args}"
+        "-DFRAMEWORK=${BENCHMARK_FRAMEWORK}"
+        "-DREPETITIONS=${BENCHMARK_REPETITIONS}"
+        "-DOUTPUT_DIR=${BENCHMARK_OUTPUT_DIR}"
+        "-DSOURCE_DIR=${CMAKE_CURRENT_SOURCE_DIR}"
+        -P "${_BENCHMARK_RUNNER}")
+    add_custom_target(run_${name} COMMAND ${command} DEPENDS ${name} USES_TERMINAL VERBATIM)
+
+    # run_benchmarks is created once all benchmarks are known, at the end of the top-level CMakeLists.txt
+    get_property(commands GLOBAL PROPERTY _BENCHMARK_COMMANDS)
+    if(NOT commands)
+        cmake_language(DEFER DIRECTORY "${CMAKE_SOURCE_DIR}" CALL _add_run_benchmarks)
+    endif()
+    set_property(GLOBAL APPEND PROPERTY _BENCHMARK_COMMANDS COMMAND ${command})
+    set_property(GLOBAL APPEND PROPERTY _BENCHMARK_TARGETS ${name})
+endfunction()
+
+function(_add_run_benchmarks)
+    get_property(commands GLOBAL PROPERTY _BENCHMARK_COMMANDS)
+    get_property(targets GLOBAL PROPERTY _BENCHMARK_TARGETS)
+    add_custom_target(run_benchmarks ${commands} DEPENDS ${targets} USES_TERMINAL VERBATIM)
+endfunction()
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "json.hpp"
+#include "perf_counters.hpp"
+
+// Micro-benchmark framework
+//
+// Timing a piece of code once says little: the first run pays for cold caches, page faults and a CPU that hasn't
+// raised its clock yet, and any single run can be hit by an interrupt. A benchmark here:
+//   1. calibrates how many iterations fill one sample (--sample-time, 5 ms by default), so the clock's resolution
+//      and overhead don't matter
+//   2. runs --warmup samples and throws them away
+//   3. runs --repetitions samples and reports their median, MAD and 99th percentile, in ns per iteration
+//   4. optionally reads the hardware counters (perf_counters.hpp) around every sample: --counters
+//
+// The median and the MAD (median absolute deviation - the median distance of a sample from the median) are
+// used instead of the mean and the standard deviation because a few samples hit by an interrupt would drag
+// those around. p99 shows exactly those samples: a p99 far above the median means the code has a slow tail.
+//
+//     int main(int argc, char* argv[]) {
+//         bench::Runner runner(argc, argv);
+//         std::vector<int> data = make_data();
+//         runner.run("sum", [&] {
+//             bench::do_not_optimize(std::accumulate(data.begin(), data.end(), 0));
+//         }, data.size()); // Items per iteration, for the items/s column
+//         return runner.finish(); // Writes --json=file, if given
+//     }
+//
+// A body that takes a std::uint64_t runs the iterations itself, for setup that shouldn't be repeated per call:
+//     runner.run("push", [&](std::uint64_t iterations) { ... });
+
+namespace bench {
+
+// ## Optimization barriers
+// The optimizer removes work whose result isn't used, and moves loop-invariant work out of the loop - both turn a
+// benchmark into a measurement of nothing. do_not_optimize(value) makes the compiler believe the value is read
+// (and, for a non-const value, possibly changed) by code it can't see, so it has to compute it, every iteration.
+// clobber_memory() makes it believe any memory may have been read or written, so stores can't be dropped.
+// Both compile to zero instructions - they only constrain the optimizer.
+#if defined(__GNUC__) || defined(__clang__)
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename T>
+inline void do_not_optimize(T& value) {
+    if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(void*)) {
+        asm volatile("" : "+r,m"(value) : : "memory");
+    } else {
+        asm volatile("" : "+m"(value) : : "memory");
+    }
+}
+
+inline void clobber_memory() {
+    asm volatile("" : : : "memory");
+}
+#else
+// Without inline assembly: reading the value's address through a volatile pointer is the nearest equivalent
+inline const volatile void* volatile escaped;
+
+template <typename T>
+inline void do_not_optimize(T&& value) {
+    escaped = &value;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+inline void clobber_memory() {
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+#endif
+
+// ## Statistics
+struct Summary {
+    double median = 0;
+    double mad = 0; // Median absolute deviation
+    double p99 = 0;
+    double min = 0;
+    double max = 0;
+    double mean = 0;
+};
+
+// Nearest-rank quantile of sorted, non-empty samples
+inline double quantile(const std::vector<double>& sorted, double q) {
+    std::size_t rank = static_cast<std::size_t>(std::ceil(q * sorted.size()));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+inline double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    std::size_t middle = values.size() / 2;
+    return values.size() % 2 == 1 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+inline Summary summarize(std::vector<double> samples) {
+    Summary summary;
+    if (samples.empty()) {
+        return summary;
+    }
+    std::sort(samples.begin(), samples.end());
+    summary.median = median(samples);
+    summary.p99 = quantile(samples, 0.99); // Needs 100+ samples to be more than the maximum
+    summary.min = samples.front();
+    summary.max = samples.back();
+    double total = 0;
+    std::vector<double> deviations;
+    deviations.reserve(samples.size());
+    for (double sample : samples) {
+        total += sample;
+        deviations.push_back(std::abs(sample - summary.median));
+    }
+    summary.mean = total / samples.size();
+    summary.mad = median(std::move(deviations));
+    return summary;
+}
+
+// ## Running benchmarks
+struct Options {
+    std::size_t warmup = 3;        // Samples run first and thrown away
+    std::size_t repetitions = 100; // Samples measured
+    double sample_time = 0.005;    // Seconds per sample - the number of iterations is calibrated to fill it
+    bool counters = false;         // Read hardware counters around every sample
+    std::string filter;            // Only run benchmarks whose name contains this
+    std::string json;              // Write the results to this file
+};
+
+struct Result {
+    std::string name;
+    std::uint64_t iterations = 0; // Per sample
+    double items_per_iteration = 1;
+    std::vector<double> samples; // ns per iteration
+    Summary ns;
+    bool has_counters = false;
+    std::array<double, PerfCounters::event_count> counters{}; // Per iteration, over all samples
+};
+
+class Runner {
+public:
+    Runner(int argc, char* argv[]) {
+        for (int i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            if (arg == "--counters") {
+                options_.counters = true;
+            } else if (auto value = flag(arg, "--warmup=")) {
+                options_.warmup = std::stoull(std::string(*value));
+            } else if (auto value = flag(arg, "--repetitions=")) {
+                options_.repetitions = std::max<std::size_t>(1, std::stoull(std::string(*value)));
+            } else if (auto value = flag(arg, "--sample-time=")) {
+                options_.sample_time = std::stod(std::string(*value));
+            } else if (auto value = flag(arg, "--filter=")) {
+                options_.filter = *value;
+            } else if (auto value = flag(arg, "--json=")) {
+                options_.json = *value;
+            } else {
+                std::cerr << "Usage: " << argv[0] << " [--warmup=" << options_.warmup << "] [--repetitions="
+                          << options_.repetitions << "] [--sample-time=" << options_.sample_time
+                          << " (seconds)] [--filter=name] [--json=file] [--counters]" << std::endl;
+                std::exit(arg == "--help" ? 0 : 2);
+            }
+        }
+        if (options_.counters) {
+            counters_.emplace();
+            if (!counters_->any_available()) {
+                std::cerr << "Hardware counters unavailable (" << counters_->error() << "), timing only" << std::endl;
+                counters_.reset();
+            }
+        }
+    }
+
+    const Options& options() const { return options_; }
+    const std::vector<Result>& results() const { return results_; }
+
+    template <typename F>
+    void run(const std::string& name, F&& body, double items_per_iteration = 1) {
+        if (name.find(options_.filter) == std::string::npos) {
+            return;
+        }
+        Result result;
+        result.name = name;
+        result.items_per_iteration = items_per_iteration;
+        result.iterations = calibrate(body);
+
+        for (std::size_t i = 0; i < options_.warmup; i++) {
+            sample(body, result.iterations);
+        }
+        PerfCounters::Values totals{};
+        for (std::size_t i = 0; i < options_.repetitions; i++) {
+            if (counters_) {
+                counters_->start();
+            }
+            double time = sample(body, result.iterations);
+            if (counters_) {
+                counters_->stop();
+                PerfCounters::Values values = counters_->read();
+                for (std::size_t e = 0; e < totals.size(); e++) {
+                    totals[e] += values[e];
+                }
+            }
+            result.samples.push_back(time * 1e9 / result.iterations);
+        }
+        result.ns = summarize(result.samples);
+        if (counters_) {
+            result.has_counters = true;
+            double iterations = static_cast<double>(result.iterations) * options_.repetitions;
+            for (std::size_t e = 0; e < totals.size(); e++) {
+                result.counters[e] = counters_->available(static_cast<PerfCounters::Event>(e)) ? totals[e] / iterations : -1;
+            }
+        }
+        print(result);
+        results_.push_back(std::move(result));
+    }
+
+    // Ends the table and writes the JSON file. Returns main's exit code
+    int finish() {
+        std::cout << std::endl;
+        if (!options_.json.empty()) {
+            std::ofstream file(options_.json);
+            write_json(file);
+            if (!file) {
+                std::cerr << "Can't write " << options_.json << std::endl;
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    void write_json(std::ostream& out) const {
+        char date[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        out << std::setprecision(6) << "{\n  \"context\": {\n";
+        out << "    \"date\": \"" << date << "\",\n";
+#if defined(__VERSION__)
+        out << "    \"compiler\": \"" << json_escape(__VERSION__) << "\",\n";
+#endif
+        out << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+        out << "    \"warmup\": " << options_.warmup << ",\n";
+        out << "    \"repetitions\": " << options_.repetitions << ",\n";
+        out << "    \"sample_time\": " << options_.sample_time << "\n  },\n";
+        out << "  \"benchmarks\": [";
+        for (std::size_t r = 0; r < results_.size(); r++) {
+            const Result& result = results_[r];
+            out << (r == 0 ? "\n" : ",\n") << "    {\n";
+            out << "      \"name\": \"" << json_escape(result.name) << "\",\n";
+            out << "      \"iterations\": " << result.iterations << ",\n";
+            out << "      \"median_ns\": " << result.ns.median << ",\n";
+            out << "      \"mad_ns\": " << result.ns.mad << ",\n";
+            out << "      \"p99_ns\": " << result.ns.p99 << ",\n";
+            out << "      \"min_ns\": " << result.ns.min << ",\n";
+            out << "      \"max_ns\": " << result.ns.max << ",\n";
+            out << "      \"mean_ns\": " << result.ns.mean << ",\n";
+            if (result.has_counters) {
+                for (std::size_t e = 0; e < result.counters.size(); e++) {
+                    if (result.counters[e] >= 0) {
+                        out << "      \"" << PerfCounters::names[e] << "\": " << result.counters[e] << ",\n";
+                    }
+                }
+            }
+            out << "      \"items_per_second\": " << items_per_second(result) << "\n    }";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+private:
+    static std::optional<std::string_view> flag(std::string_view arg, std::string_view prefix) {
+        if (arg.substr(0, prefix.size()) != prefix) {
+            return std::nullopt;
+        }
+        return arg.substr(prefix.size());
+    }
+
+    static double items_per_second(const Result& result) {
+        return result.ns.median > 0 ? result.items_per_iteration * 1e9 / result.ns.median : 0;
+    }
+
+    template <typename F>
+    static double sample(F& body, std::uint64_t iterations) {
+        auto begin = std::chrono::steady_clock::now();
+        if constexpr (std::is_invocable_v<F&, std::uint64_t>) {
+            body(iterations);
+        } else {
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                body();
+            }
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    // Grows the iteration count until one sample takes sample_time. A body slower than that runs once per sample
+    template <typename F>
+    std::uint64_t calibrate(F& body) const {
+        std::uint64_t iterations = 1;
+        while (true) {
+            double time = sample(body, iterations);
+            if (time >= options_.sample_time) {
+                return iterations;
+            }
+            // Aim a bit past the target, so the last round usually lands on it; at most 10x per round in case the
+            // first runs were cold and short
+            double growth = time > 0 ? std::min(10.0, 1.2 * options_.sample_time / time) : 10.0;
+            iterations = std::max(iterations + 1, static_cast<std::uint64_t>(iterations * growth));
+        }
+    }
+
+    void print(const Result& result) {
+        if (!header_printed_) {
+            std::cout << "| Benchmark                      | iterations | median ns  | MAD    | p99 ns     | items/s    |";
+            if (counters_) {
+                std::cout << " cycles     | instr      | cache miss | br miss    |";
+            }
+            std::cout << "\n|--------------------------------|------------|------------|--------|------------|------------|";
+            if (counters_) {
+                std::cout << "------------|------------|------------|------------|";
+            }
+            std::cout << '\n';
+            header_printed_ = true;
+        }
+        double mad_percent = result.ns.median > 0 ? 100 * result.ns.mad / result.ns.median : 0;
+        std::cout << "| " << std::setw(30) << std::left << result.name << std::right << " | " << std::setw(10)
+                  << result.iterations << std::fixed << std::setprecision(2) << " | " << std::setw(10) << result.ns.median
+                  << " | " << std::setw(5) << std::setprecision(1) << mad_percent << "% | " << std::setw(10)
+                  << std::setprecision(2) << result.ns.p99 << " | " << std::setw(10) << std::scientific
+                  << std::setprecision(3) << items_per_second(result) << std::fixed << " |";
+        if (result.has_counters) {
+            for (double counter : result.counters) {
+                if (counter < 0) {
+                    std::cout << std::setw(11) << "-" << " |";
+                } else {
+                    std::cout << ' ' << std::setw(10) << std::setprecision(2) << counter << " |";
+                }
+            }
+        }
+        std::cout << std::endl; // Flushed per row - long runs show progress
+    }
+
+    Options options_;
+    std::optional<PerfCounters> counters_; // Set when --counters is given and works
+    std::vector<Result> results_;
+    bool header_printed_ = false;
+};
+
+} // namespace bench
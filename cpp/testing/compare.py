@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""Compares two benchmark result files, or two directories of them, written by bench.hpp or run_benchmarks.
+
+Usage: ./compare.py <before.json | before dir> <after.json | after dir> [--threshold=5]
+
+Prints a Markdown table with the change of every benchmark found in both: by name when comparing two files, by file
+and name when comparing directories. A change counts as a regression (or an improvement) when it's more than
+--threshold percent, and the ranges of the two sides don't overlap. For bench.hpp results the range is the median
++- 3x the MAD. The numbers the other programs report through report.hpp (a time, a rate or a count per table row)
+have one value per repetition of run_benchmarks: their medians are compared, and the range is the lowest to the
+highest value - with 5 repetitions on each side, two runs of the same code only miss each other's range about 1% of
+the time. A number measured only once has no range: its change is shown as "worse?" or "better?", but doesn't count.
+For rates (GB/s, FPS, ...) lower is worse, and a count that was 0 and no longer is always counts as a change.
+Exits with 1 if anything got worse, so it can fail a CI job, and with 2 if the two sides have nothing in common.
+"""
+
+import json
+import math
+import sys
+from pathlib import Path
+
+
+def median(values):
+    ordered = sorted(values)
+    middle = len(ordered) // 2
+    return ordered[middle] if len(ordered) % 2 else (ordered[middle - 1] + ordered[middle]) / 2
+
+
+def load(path, by_file):
+    """{(file, benchmark name) or benchmark name: (value, (low, high), unit, higher_is_better)} - bench.hpp results
+    are times in ns. The range is None for a single measurement."""
+    files = sorted(path.glob("*.json")) if path.is_dir() else [path]
+    results = {}
+    for file in files:
+        with open(file) as stream:
+            data = json.load(stream)
+        for benchmark in data.get("benchmarks", []):
+            key = (file.stem, benchmark["name"]) if by_file else benchmark["name"]
+            if "median_ns" in benchmark:
+                middle, mad = benchmark["median_ns"], benchmark.get("mad_ns", 0)
+                results[key] = (middle, (middle - 3 * mad, middle + 3 * mad), "ns", False)
+            elif "values" in benchmark or "value" in benchmark:
+                values = benchmark.get("values", [benchmark.get("value")])
+                if not values:
+                    continue
+                spread = (min(values), max(values)) if len(values) > 1 else None
+                results[key] = (median(values), spread, benchmark["unit"], benchmark.get("higher_is_better", False))
+    return results
+
+
+def main():
+    paths = [arg for arg in sys.argv[1:] if not arg.startswith("--")]
+    threshold = 5.0
+    for arg in sys.argv[1:]:
+        if arg.startswith("--threshold="):
+            threshold = float(arg.split("=", 1)[1])
+        elif arg.startswith("--"):
+            paths = []
+    if len(paths) != 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    # Two files are usually two runs of the same program, saved under different names
+    by_file = Path(paths[0]).is_dir() or Path(paths[1]).is_dir()
+    before, after = load(Path(paths[0]), by_file), load(Path(paths[1]), by_file)
+    if not before.keys() & after.keys():
+        print(f"No benchmarks in common between {paths[0]} and {paths[1]}", file=sys.stderr)
+        return 2
+    regressions = 0
+    print("| Benchmark                                          | before             | after              | change   |        |")
+    print("|----------------------------------------------------|--------------------|--------------------|----------|--------|")
+    for key in sorted(before.keys() & after.keys()):
+        (old, old_range, unit, higher_is_better), (new, new_range, _, _) = before[key], after[key]
+        if old != 0:
+            change = 100 * (new - old) / abs(old)
+        else:
+            change = 0 if new == 0 else math.copysign(math.inf, new)
+        measured = old_range is not None and new_range is not None
+        apart = not measured or old_range[1] < new_range[0] or new_range[1] < old_range[0]
+        verdict = ""
+        if abs(change) > threshold and apart:
+            worse = change < 0 if higher_is_better else change > 0
+            verdict = ("worse" if worse else "better") + ("" if measured else "?")
+            regressions += worse and measured
+        if not by_file:
+            name = key
+        else:
+            name = key[1] if key[0] == key[1] else f"{key[0]}: {key[1]}"
+        print(f"| {name:<50} | {old:>9.2f} {unit:<8} | {new:>9.2f} {unit:<8} | {change:>+7.1f}% | {verdict:<6} |")
+
+    for key in sorted(before.keys() - after.keys()):
+        print(f"Only in {paths[0]}: {key[1] if by_file else key}")
+    for key in sorted(after.keys() - before.keys()):
+        print(f"Only in {paths[1]}: {key[1] if by_file else key}")
+    if regressions:
+        print(f"\n{regressions} benchmark(s) worse by more than {threshold}% and the noise")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
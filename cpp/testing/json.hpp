@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// JSON string escaping shared by bench.hpp's --json and report.hpp
+//
+// Only what the benchmark names and compiler versions can contain: quotes and backslashes are escaped, control
+// characters (a stray newline or tab) become spaces. Everything else, UTF-8 included, goes through as it is.
+//
+//     out << "\"name\": \"" << bench::json_escape(name) << "\"";
+
+namespace bench {
+
+inline std::string json_escape(std::string_view text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += ' ';
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // namespace bench
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "perf_counters.hpp"
+
+// Timing for the benchmark programs that print their own comparison tables
+//
+// bench.hpp's Runner prints one row per benchmark; programs that put two versions side by side in one row (branchy
+// vs branchless, a loop per execution policy) time each version with measure() instead, and share the rest here:
+//
+//     bench::PerfCounters counters;
+//     bench::Measurement result = bench::measure(counters, items, [&] { work(); });
+//     std::cout << bench::format(result.ns, 2) << " ns, " << bench::format(result.branch_misses, 3) << " misses\n";
+
+namespace bench {
+
+template <typename F>
+double seconds(F&& work) {
+    auto begin = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+struct Measurement {
+    double ns;            // Per item
+    double ipc;           // Instructions per cycle, -1 without counters
+    double branch_misses; // Mispredicted branches per item, -1 without counters
+};
+
+// One warm-up run, then runs until 0.2 s have passed (at least 3), with the counters running around all of them.
+// Each run handles `items` items. The counters follow the calling thread and the threads it starts and joins -
+// not the workers of a thread pool that outlives the run
+template <typename F>
+Measurement measure(PerfCounters& counters, double items, F&& work) {
+    work();
+    int runs = 0;
+    double total = 0;
+    counters.start();
+    while (runs < 3 || total < 0.2) {
+        total += seconds(work);
+        runs++;
+    }
+    counters.stop();
+    PerfCounters::Values values = counters.read();
+    bool ipc = counters.available(PerfCounters::cycles) && counters.available(PerfCounters::instructions) &&
+               values[PerfCounters::cycles] > 0;
+    return {total * 1e9 / (items * runs),
+            ipc ? static_cast<double>(values[PerfCounters::instructions]) / values[PerfCounters::cycles] : -1,
+            counters.available(PerfCounters::branch_misses) ? values[PerfCounters::branch_misses] / (items * runs) : -1};
+}
+
+// A table cell: "n/a" for the -1 of a missing counter
+inline std::string format(double value, int precision) {
+    if (value < 0) {
+        return "n/a";
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(precision) << value;
+    return out.str();
+}
+
+// Every benchmark checks its results; a wrong one ends the program with an error, which fails its ctest test
+[[noreturn]] inline void fail(const std::string& what) {
+    std::cerr << "ERROR: " << what << std::endl;
+    std::exit(1);
+}
+
+} // namespace bench
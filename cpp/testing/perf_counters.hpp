@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(__linux__) && __has_include(<linux/perf_event.h>)
+#define BENCH_HAS_PERF_EVENTS 1
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#define BENCH_HAS_PERF_EVENTS 0
+#endif
+
+// Hardware performance counters through Linux's perf_event_open
+//
+// The CPU counts cycles, retired instructions, cache misses and mispredicted branches by itself; perf_event_open
+// asks the kernel for a file descriptor per counter, restricted to this process and to user-space code. Reading
+// the counters around a piece of code says *why* it's slow, not just how slow it is.
+//
+// Counters are often unavailable: other operating systems, containers without the syscall, virtual machines that
+// don't expose the PMU, or /proc/sys/kernel/perf_event_paranoid set to 3 or more. Every counter is opened on its
+// own, so a machine without, say, a cache-miss event still gets the other three. available(e) says which worked.
+//
+//     bench::PerfCounters counters;
+//     counters.start();
+//     work();
+//     counters.stop();
+//     std::uint64_t misses = counters.read()[bench::PerfCounters::branch_misses];
+
+namespace bench {
+
+class PerfCounters {
+public:
+    enum Event { cycles, instructions, cache_misses, branch_misses, event_count };
+    static constexpr std::array<const char*, event_count> names = {"cycles", "instructions", "cache_misses", "branch_misses"};
+    using Values = std::array<std::uint64_t, event_count>;
+
+    PerfCounters() {
+#if BENCH_HAS_PERF_EVENTS
+        constexpr std::array<std::uint64_t, event_count> configs = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (std::size_t e = 0; e < event_count; e++) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[e];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1; // Allowed with perf_event_paranoid <= 2, and the kernel's work isn't ours anyway
+            attr.exclude_hv = 1;
+            attr.inherit = 1; // Count the threads the benchmark starts, too
+            // With more events than hardware counters the kernel time-slices them; these two times let read()
+            // scale the count back up to the whole interval
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds_[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fds_[e] < 0 && error_.empty()) {
+                error_ = std::string(names[e]) + ": " + std::strerror(errno);
+            }
+        }
+#else
+        error_ = "perf_event_open is only available on Linux";
+#endif
+    }
+
+    ~PerfCounters() {
+#if BENCH_HAS_PERF_EVENTS
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available(Event event) const { return fds_[event] >= 0; }
+    bool any_available() const {
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+    // Why the first counter that failed couldn't be opened, empty if all of them worked
+    const std::string& error() const { return error_; }
+
+    void start() {
+#if BENCH_HAS_PERF_EVENTS
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    void stop() {
+#if BENCH_HAS_PERF_EVENTS
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+#endif
+    }
+
+    // Counts between the last start() and stop(). Unavailable counters read 0
+    Values read() const {
+        Values values{};
+#if BENCH_HAS_PERF_EVENTS
+        for (std::size_t e = 0; e < event_count; e++) {
+            std::uint64_t data[3] = {}; // value, time enabled, time running
+            if (fds_[e] < 0 || ::read(fds_[e], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) {
+                continue;
+            }
+            values[e] = data[2] == 0 || data[2] == data[1]
+                            ? data[0]
+                            : static_cast<std::uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]);
+        }
+#endif
+        return values;
+    }
+
+private:
+    std::array<int, event_count> fds_ = {-1, -1, -1, -1};
+    std::string error_;
+};
+
+} // namespace bench
@@ -0,0 +1,326 @@
+// Regression suite: one or two representative operations from every module with a benchmark, timed with bench.hpp.
+// The per-module benchmarks print tables meant for reading; this one writes JSON meant for comparing commits:
+//     ./regression_benchmark --json=before.json   (on the old commit)
+//     ./regression_benchmark --json=after.json    (on the new one)
+//     ./compare.py before.json after.json
+//
+// Build: g++ -std=c++20 -O2 -pthread regression_benchmark.cpp ../lang/types/simd/kernels.cpp
+//        ../lang/types/simd/kernels_sse2.cpp ../lang/types/simd/kernels_avx2.cpp -o regression_benchmark
+// Usage: ./regression_benchmark [--filter=name] [--json=file] [--counters] [--help for the rest]
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bench.hpp"
+
+#include "../lang/conditionals/branchless.hpp"
+#include "../lang/conditionals/interpreter.hpp"
+#include "../lang/io/records.hpp"
+#include "../lang/loops/reductions.hpp"
+#include "../lang/memory/arena.hpp"
+#include "../lang/types/intrusive_ptr.hpp"
+#include "../lang/types/simd/kernels.hpp"
+#include "../../Data Structures/Lists/cpp/lists.hpp"
+#include "../../Data Structures/Queues/cpp/queues.hpp"
+#include "../../Data Structures/Stacks/cpp/stacks.hpp"
+#include "../../Data Structures/Trees/cpp/bplus_tree.hpp"
+#include "../../Data Structures/Trees/cpp/static_tree.hpp"
+#include "../../OpenCV/cpp/pipeline.hpp"
+
+struct Object {
+    std::uint64_t data[8];
+};
+
+// ## cpp/lang/memory
+void memory_benchmarks(bench::Runner& runner) {
+    constexpr std::size_t batch = 1000; // Objects per iteration, all freed at the end of it
+    std::vector<Object*> objects(batch);
+
+    runner.run("memory/new+delete", [&] {
+        for (Object*& object : objects) {
+            object = new Object();
+        }
+        bench::do_not_optimize(objects.data());
+        for (Object* object : objects) {
+            delete object;
+        }
+    }, batch);
+
+    memory::Arena arena;
+    runner.run("memory/arena", [&] {
+        for (Object*& object : objects) {
+            object = arena.create<Object>();
+        }
+        bench::do_not_optimize(objects.data());
+        arena.reset();
+    }, batch);
+
+    memory::Pool pool(sizeof(Object), 1024, alignof(Object));
+    runner.run("memory/pool", [&] {
+        for (Object*& object : objects) {
+            object = pool.create<Object>();
+        }
+        bench::do_not_optimize(objects.data());
+        for (Object* object : objects) {
+            pool.destroy(object);
+        }
+    }, batch);
+}
+
+// ## Data Structures/Lists
+template <typename List>
+void list_traversal(bench::Runner& runner, const char* name) {
+    constexpr std::size_t size = 100'000;
+    List list;
+    for (std::size_t i = 0; i < size; i++) {
+        list.push_back(i);
+    }
+    runner.run(name, [&] {
+        std::uint64_t total = 0;
+        for (std::uint64_t value : list) {
+            total += value;
+        }
+        bench::do_not_optimize(total);
+    }, size);
+}
+
+void list_benchmarks(bench::Runner& runner) {
+    list_traversal<std::list<std::uint64_t>>(runner, "lists/std::list traverse");
+    list_traversal<lists::PooledList<std::uint64_t>>(runner, "lists/PooledList traverse");
+    list_traversal<lists::UnrolledList<std::uint64_t>>(runner, "lists/UnrolledList traverse");
+}
+
+// ## Data Structures/Queues and Stacks
+// Single thread: the cost of the operations themselves, without any contention
+template <typename Queue>
+void queue_round_trip(bench::Runner& runner, const char* name) {
+    Queue queue(1024);
+    runner.run(name, [&] {
+        std::uint64_t value = 0;
+        queue.try_push(1);
+        queue.try_pop(value);
+        bench::do_not_optimize(value);
+    });
+}
+
+void queue_benchmarks(bench::Runner& runner) {
+    queue_round_trip<queues::SpscQueue<std::uint64_t>>(runner, "queues/SpscQueue push+pop");
+    queue_round_trip<queues::MpmcQueue<std::uint64_t>>(runner, "queues/MpmcQueue push+pop");
+    queue_round_trip<queues::LockedQueue<std::uint64_t>>(runner, "queues/LockedQueue push+pop");
+
+    stacks::ChaseLevDeque<std::uint64_t> deque;
+    runner.run("stacks/ChaseLevDeque push+pop", [&] {
+        deque.push(1);
+        bench::do_not_optimize(deque.pop());
+    });
+}
+
+// ## Data Structures/Trees
+// Random lookups of keys that exist, in a tree too big for the L2 cache
+void tree_benchmarks(bench::Runner& runner) {
+    constexpr std::size_t size = 1'000'000;
+    constexpr std::size_t lookups = 1000;
+    std::vector<std::pair<std::int32_t, std::int32_t>> sorted(size);
+    for (std::size_t i = 0; i < size; i++) {
+        sorted[i] = {static_cast<std::int32_t>(2 * i), static_cast<std::int32_t>(i)};
+    }
+    std::vector<std::int32_t> keys(lookups);
+    std::mt19937 random(42);
+    for (std::int32_t& key : keys) {
+        key = sorted[random() % size].first;
+    }
+
+    auto lookup_all = [&](const auto& find) {
+        return [&, find] {
+            std::int64_t total = 0;
+            for (std::int32_t key : keys) {
+                total += find(key);
+            }
+            bench::do_not_optimize(total);
+        };
+    };
+
+    std::map<std::int32_t, std::int32_t> map(sorted.begin(), sorted.end());
+    runner.run("trees/std::map find", lookup_all([&](std::int32_t key) { return map.find(key)->second; }), lookups);
+
+    trees::BPlusTree<std::int32_t, std::int32_t> bplus;
+    bplus.bulk_load(sorted);
+    runner.run("trees/BPlusTree find", lookup_all([&](std::int32_t key) { return *bplus.find(key); }), lookups);
+
+    trees::StaticTree<std::int32_t, std::int32_t> stree;
+    stree.bulk_load(sorted);
+    runner.run("trees/StaticTree find", lookup_all([&](std::int32_t key) { return *stree.find(key); }), lookups);
+}
+
+// ## cpp/lang/types
+void simd_benchmarks(bench::Runner& runner) {
+    std::vector<std::int32_t> data(256 * 1024); // 1 MiB
+    std::iota(data.begin(), data.end(), 0);
+    for (simd::Impl impl : {simd::Impl::scalar, simd::best()}) {
+        const simd::Kernels<std::int32_t>* kernels = simd::kernels<std::int32_t>(impl);
+        runner.run(std::string("simd/int32 sum ") + simd::name(impl), [&] {
+            bench::do_not_optimize(kernels->sum(data.data(), data.size()));
+        }, data.size());
+    }
+}
+
+struct Counted : smart::RefCounted<Counted> {
+    std::uint64_t data[8] = {};
+};
+
+template <typename Ptr>
+[[gnu::noipa]] std::uint64_t use(Ptr ptr) {
+    return ptr->data[0];
+}
+
+void smart_pointer_benchmarks(bench::Runner& runner) {
+    // libstdc++ counts shared_ptr references with plain increments until the process starts its first thread
+    // (__libc_single_threaded). Real servers have threads, so start one to time the atomic version
+    std::thread([] {}).join();
+    std::shared_ptr<Object> shared = std::make_shared<Object>();
+    runner.run("smart/shared_ptr copy", [&] {
+        bench::do_not_optimize(use<std::shared_ptr<Object>>(shared));
+    });
+    smart::IntrusivePtr<Counted> intrusive = smart::make_intrusive<Counted>();
+    runner.run("smart/IntrusivePtr copy", [&] {
+        bench::do_not_optimize(use<smart::IntrusivePtr<Counted>>(intrusive));
+    });
+}
+
+// ## cpp/lang/io
+// Line splitting and CSV parsing from memory: the disk and page cache are too noisy to compare commits with,
+// io_benchmark has those numbers
+struct MemoryReader {
+    std::string_view data;
+    std::string_view next() { return std::exchange(data, {}); }
+};
+
+void io_benchmarks(bench::Runner& runner) {
+    std::string csv;
+    std::mt19937 random(42);
+    constexpr std::size_t lines = 16384;
+    for (std::size_t line = 0; line < lines; line++) {
+        for (int column = 0; column < 8; column++) {
+            csv += std::to_string(static_cast<std::int32_t>(random()) >> column * 3);
+            csv += column < 7 ? ',' : '\n';
+        }
+    }
+    runner.run("io/Lines", [&] {
+        MemoryReader reader{csv};
+        std::size_t count = 0;
+        for (std::string_view line : io::Lines(reader)) {
+            count += !line.empty();
+        }
+        bench::do_not_optimize(count);
+    }, lines);
+    runner.run("io/CSV sum", [&] {
+        MemoryReader reader{csv};
+        std::int64_t sum = 0;
+        for (std::string_view line : io::Lines(reader)) {
+            io::Fields fields(line);
+            std::int64_t value = 0;
+            for (std::string_view field; fields.next(field);) {
+                io::parse(field, value);
+                sum += value;
+            }
+        }
+        bench::do_not_optimize(sum);
+    }, lines);
+}
+
+// ## cpp/lang/conditionals
+// Random data, where the branchy filter mispredicts; branch_benchmark has the other cases
+void conditional_benchmarks(bench::Runner& runner) {
+    constexpr std::size_t n = 16384;
+    std::vector<int> values(n);
+    std::mt19937 random(42);
+    for (int& v : values) {
+        v = static_cast<int>(random() % 1000);
+    }
+    std::vector<int> out(n);
+    runner.run("conditionals/filter branchy", [&] {
+        std::size_t count = 0;
+        for (int v : values) {
+            if (v < 500) {
+                out[count++] = v;
+            }
+        }
+        bench::do_not_optimize(count);
+        bench::clobber_memory();
+    }, n);
+    runner.run("conditionals/filter branchless", [&] {
+        bench::do_not_optimize(branchless::compact(values.data(), n, out.data(), [](int v) { return v < 500; }));
+        bench::clobber_memory();
+    }, n);
+
+    interpreter::Program program = interpreter::collatz(100);
+    interpreter::Machine probe;
+    interpreter::run_switch(program, probe);
+    runner.run("conditionals/switch dispatch", [&] {
+        interpreter::Machine m;
+        interpreter::run_switch(program, m);
+        bench::do_not_optimize(m.r[3]);
+    }, probe.executed);
+    runner.run("conditionals/goto dispatch", [&] {
+        interpreter::Machine m;
+        interpreter::run_goto(program, m);
+        bench::do_not_optimize(m.r[3]);
+    }, probe.executed);
+}
+
+// ## cpp/lang/loops
+void loop_benchmarks(bench::Runner& runner) {
+    std::vector<double> doubles(4096);
+    std::iota(doubles.begin(), doubles.end(), 0.0);
+    runner.run("loops/sum 1 accumulator", [&] {
+        bench::do_not_optimize(doubles.data());
+        bench::do_not_optimize(loops::sum_simple(doubles.data(), doubles.size()));
+    }, doubles.size());
+    runner.run("loops/sum 8 accumulators", [&] {
+        bench::do_not_optimize(doubles.data());
+        bench::do_not_optimize(loops::sum_accumulators<8>(doubles.data(), doubles.size()));
+    }, doubles.size());
+}
+
+// ## OpenCV/cpp
+// A VGA frame keeps the suite quick; pipeline_benchmark has the 4K numbers
+void vision_benchmarks(bench::Runner& runner) {
+    constexpr int width = 640;
+    constexpr int height = 480;
+    vision::Image<std::uint8_t> rgb(width, height, 3);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < 3 * width; x++) {
+            rgb.row(y)[x] = static_cast<std::uint8_t>((x * 7) ^ (y * 13));
+        }
+    }
+    vision::Image<std::uint8_t> out(width, height);
+    vision::Scratch scratch(width, height);
+    runner.run("vision/edges blocked", [&] { vision::blocked::edges(rgb, out, scratch); }, width * height);
+    runner.run("vision/edges fused", [&] { vision::fused::edges(rgb, out); }, width * height);
+}
+
+int main(int argc, char* argv[]) {
+    bench::Runner runner(argc, argv);
+    memory_benchmarks(runner);
+    list_benchmarks(runner);
+    queue_benchmarks(runner);
+    tree_benchmarks(runner);
+    simd_benchmarks(runner);
+    io_benchmarks(runner);
+    conditional_benchmarks(runner);
+    loop_benchmarks(runner);
+    vision_benchmarks(runner);
+    smart_pointer_benchmarks(runner);
+    return runner.finish();
+}
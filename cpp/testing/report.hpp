@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "json.hpp"
+
+// Results of the benchmark programs that time themselves, as JSON for compare.py
+//
+// Most benchmarks here don't use bench.hpp: they time their cases their own way and print Markdown tables. Next to
+// printing a row, they pass its numbers to bench::report(). When the environment variable BENCHMARK_JSON names a
+// file (run_benchmark.cmake sets it), the reports are written there when the program exits, in the same
+// "benchmarks" list as bench.hpp's --json, one entry per number:
+//     {"name": "Filter, random 50%: branchless", "value": 1.57, "unit": "ns", "higher_is_better": false}
+// A unit ending in "/s", and "FPS", is a rate, where higher is better; anything else (ns, ms, x) is a cost.
+// Without BENCHMARK_JSON, report() does nothing. Each number is one measurement: run_benchmark.cmake runs the
+// program several times and merges the files, which gives compare.py the spread between runs.
+//
+//     print_row(name, threads, ns);
+//     bench::report(name + ", " + std::to_string(threads) + " threads", ns, "ns");
+
+namespace bench {
+
+namespace detail {
+
+class Report {
+public:
+    struct Entry {
+        std::string name;
+        double value;
+        std::string unit;
+    };
+
+    Report() {
+        if (const char* file = std::getenv("BENCHMARK_JSON")) {
+            file_ = file;
+        }
+    }
+    ~Report() { write(); }
+
+    bool enabled() const { return !file_.empty(); }
+    void add(Entry entry) { entries_.push_back(std::move(entry)); }
+
+private:
+    static bool higher_is_better(std::string_view unit) {
+        return unit == "FPS" || (unit.size() >= 2 && unit.substr(unit.size() - 2) == "/s");
+    }
+
+    void write() const {
+        if (!enabled()) {
+            return;
+        }
+        std::ofstream out(file_);
+        out << "{\n  \"context\": {},\n  \"benchmarks\": [";
+        for (std::size_t e = 0; e < entries_.size(); e++) {
+            const Entry& entry = entries_[e];
+            out << (e == 0 ? "\n" : ",\n") << "    {\"name\": \"" << json_escape(entry.name) << "\", \"value\": " << entry.value
+                << ", \"unit\": \"" << json_escape(entry.unit) << "\", \"higher_is_better\": "
+                << (higher_is_better(entry.unit) ? "true" : "false") << "}";
+        }
+        out << "\n  ]\n}\n";
+        if (!out) {
+            std::cerr << "Can't write " << file_ << std::endl;
+        }
+    }
+
+    std::string file_;
+    std::vector<Entry> entries_;
+};
+
+// Created on the first report, written when the program exits (returns from main or calls std::exit, not _exit)
+inline Report& report() {
+    static Report report;
+    return report;
+}
+
+} // namespace detail
+
+// Records one number of a table row. Names must be unique within the program: compare.py matches them between runs.
+// Numbers that aren't finite (a rate over no time at all) are left out, JSON has no way to write them
+inline void report(std::string name, double value, std::string unit) {
+    detail::Report& report = detail::report();
+    if (report.enabled() && std::isfinite(value)) {
+        report.add({std::move(name), value, std::move(unit)});
+    }
+}
+
+} // namespace bench
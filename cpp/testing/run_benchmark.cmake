@@ -0,0 +1,131 @@
+# Runs one benchmark and writes its results as JSON - the command behind the run_<name> targets of Benchmark.cmake
+#
+#   cmake -DNAME=<name> -DEXECUTABLE=<path> [-DARGS=<arg>|<arg>...] [-DFRAMEWORK=ON] [-DREPETITIONS=<n>]
+#         -DOUTPUT_DIR=<dir> [-DSOURCE_DIR=<dir in the git repository>] -P run_benchmark.cmake
+#
+# Writes <OUTPUT_DIR>/<NAME>.md (what the program printed) and <OUTPUT_DIR>/<NAME>.json, and prints the output.
+# A FRAMEWORK program writes the JSON itself, with --json=, and repeats its measurements on its own. Any other
+# program is run REPETITIONS times (default 5), each time with a file name in the environment variable
+# BENCHMARK_JSON, where report.hpp writes one entry per reported number. The entries of all runs are merged into
+# one per name, with every run's number in "values", so compare.py can tell a change from run-to-run noise.
+
+cmake_minimum_required(VERSION 3.23) # string(TIMESTAMP) with %f
+
+foreach(variable NAME EXECUTABLE OUTPUT_DIR)
+    if(NOT DEFINED ${variable})
+        message(FATAL_ERROR "run_benchmark.cmake: -D${variable}= is required")
+    endif()
+endforeach()
+
+string(REPLACE "|" ";" args "${ARGS}")
+set(text_file "${OUTPUT_DIR}/${NAME}.md")
+set(json_file "${OUTPUT_DIR}/${NAME}.json")
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+file(REMOVE "${json_file}")
+if(FRAMEWORK)
+    list(APPEND args "--json=${json_file}")
+    set(REPETITIONS 1)
+elseif(NOT DEFINED REPETITIONS OR REPETITIONS STREQUAL "")
+    set(REPETITIONS 5)
+endif()
+if(NOT REPETITIONS MATCHES "^[1-9][0-9]*$")
+    message(FATAL_ERROR "run_benchmark.cmake: REPETITIONS must be a positive number, not '${REPETITIONS}'")
+endif()
+
+# The commit the benchmark was built from, so result files can be told apart later
+set(commit "unknown")
+if(DEFINED SOURCE_DIR)
+    execute_process(COMMAND git rev-parse --short HEAD WORKING_DIRECTORY "${SOURCE_DIR}"
+                    OUTPUT_VARIABLE head OUTPUT_STRIP_TRAILING_WHITESPACE ERROR_QUIET RESULT_VARIABLE git_result)
+    if(git_result EQUAL 0)
+        set(commit "${head}")
+        execute_process(COMMAND git status --porcelain --untracked-files=no WORKING_DIRECTORY "${SOURCE_DIR}"
+                        OUTPUT_VARIABLE changes ERROR_QUIET)
+        if(changes)
+            string(APPEND commit "-dirty")
+        endif()
+    endif()
+endif()
+
+# Wall time of all runs together; the .md keeps the tables of the last one
+string(TIMESTAMP begin "%s%f" UTC) # Microseconds since the epoch
+foreach(run RANGE 1 ${REPETITIONS})
+    if(FRAMEWORK)
+        message(STATUS "Running ${NAME}")
+    else()
+        message(STATUS "Running ${NAME} (${run}/${REPETITIONS})")
+        set(ENV{BENCHMARK_JSON} "${OUTPUT_DIR}/${NAME}.run${run}.json") # Where report.hpp writes the row numbers
+        file(REMOVE "$ENV{BENCHMARK_JSON}")
+    endif()
+    execute_process(COMMAND "${EXECUTABLE}" ${args} OUTPUT_FILE "${text_file}" RESULT_VARIABLE result)
+    execute_process(COMMAND "${CMAKE_COMMAND}" -E cat "${text_file}")
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${NAME} failed: ${result}")
+    endif()
+endforeach()
+string(TIMESTAMP end "%s%f" UTC)
+math(EXPR microseconds "${end} - ${begin}")
+math(EXPR whole "${microseconds} / 1000000")
+math(EXPR fraction "${microseconds} % 1000000")
+string(LENGTH "${fraction}" digits)
+while(digits LESS 6)
+    string(PREPEND fraction "0")
+    math(EXPR digits "${digits} + 1")
+endwhile()
+set(wall_seconds "${whole}.${fraction}")
+
+if(FRAMEWORK)
+    if(NOT EXISTS "${json_file}")
+        message(FATAL_ERROR "${NAME} wrote no results to ${json_file}")
+    endif()
+    file(READ "${json_file}" json)
+else()
+    # One entry per name, in the order of the first run that has it, with the numbers of every run. Entries are
+    # matched by name - a number that isn't finite is left out of a run, so the lists can differ in length.
+    # Variables are keyed by a hash of the name, which can contain anything
+    set(names "")
+    foreach(run RANGE 1 ${REPETITIONS})
+        set(run_file "${OUTPUT_DIR}/${NAME}.run${run}.json")
+        if(NOT EXISTS "${run_file}")
+            message(FATAL_ERROR "${NAME} wrote no results to ${run_file}")
+        endif()
+        file(READ "${run_file}" run_json)
+        file(REMOVE "${run_file}")
+        string(JSON count LENGTH "${run_json}" benchmarks)
+        if(count EQUAL 0)
+            continue()
+        endif()
+        math(EXPR last "${count} - 1")
+        foreach(e RANGE ${last})
+            string(JSON entry GET "${run_json}" benchmarks ${e})
+            string(JSON name GET "${entry}" name)
+            string(MD5 key "${name}")
+            if(NOT DEFINED entry_${key})
+                set(entry_${key} "${entry}")
+                list(APPEND names ${key})
+            endif()
+            string(JSON value GET "${entry}" value)
+            list(APPEND values_${key} "${value}")
+        endforeach()
+    endforeach()
+    set(json "{\"context\": {}, \"benchmarks\": []}")
+    set(e 0)
+    foreach(key IN LISTS names)
+        string(JSON entry REMOVE "${entry_${key}}" value)
+        list(JOIN values_${key} ", " values)
+        string(JSON entry SET "${entry}" values "[${values}]")
+        string(JSON json SET "${json}" benchmarks ${e} "${entry}")
+        math(EXPR e "${e} + 1")
+    endforeach()
+    # The entries are the numbers behind the table rows; the tables themselves go along as a JSON string
+    file(READ "${text_file}" output)
+    string(REPLACE "\\" "\\\\" output "${output}")
+    string(REPLACE "\"" "\\\"" output "${output}")
+    string(REPLACE "\n" "\\n" output "${output}")
+    string(REPLACE "\t" "\\t" output "${output}")
+    string(JSON json SET "${json}" output "\"${output}\"")
+endif()
+string(JSON json SET "${json}" context commit "\"${commit}\"")
+string(JSON json SET "${json}" context wall_seconds "${wall_seconds}")
+string(JSON json SET "${json}" context repetitions "${REPETITIONS}")
+file(WRITE "${json_file}" "${json}\n")